@@ -1,12 +1,21 @@
+#include "addon_data.h"
+#include "appender.h"
 #include "connection.h"
+#include "connection_pool.h"
 #include "duckdb.h"
+#include "prepared_statement.h"
 #include "result_iterator.h"
 #include <napi.h>
 
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+  // deleted when the environment is torn down
+  env.SetInstanceData(new NodeDuckDB::AddonData());
   NodeDuckDB::DuckDB::Init(env, exports);
   NodeDuckDB::Connection::Init(env, exports);
+  NodeDuckDB::ConnectionPool::Init(env, exports);
+  NodeDuckDB::Appender::Init(env, exports);
   NodeDuckDB::ResultIterator::Init(env, exports);
+  NodeDuckDB::PreparedStatement::Init(env, exports);
   return exports;
 }
 
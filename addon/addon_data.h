@@ -0,0 +1,28 @@
+#ifndef ADDON_DATA_H
+#define ADDON_DATA_H
+
+#include <napi.h>
+#include <string>
+#include <unordered_set>
+
+namespace NodeDuckDB {
+// State of the addon per environment. The main thread and each worker thread
+// load the addon into an environment of their own, and JS values such as the
+// class constructors can't be used across environments.
+struct AddonData {
+  static AddonData *Get(Napi::Env env) {
+    return env.GetInstanceData<AddonData>();
+  }
+  Napi::FunctionReference duckdb_constructor;
+  Napi::FunctionReference connection_constructor;
+  Napi::FunctionReference connection_pool_constructor;
+  Napi::FunctionReference appender_constructor;
+  Napi::FunctionReference result_iterator_constructor;
+  Napi::FunctionReference prepared_statement_constructor;
+  // names of the JS functions registered in this environment, see
+  // ResultCache::FunctionKey
+  std::unordered_set<std::string> js_functions;
+};
+} // namespace NodeDuckDB
+
+#endif
@@ -0,0 +1,368 @@
+#include "appender.h"
+#include "addon_data.h"
+#include "connection.h"
+#include "duckdb.hpp"
+#include "vector_writer.h"
+#include <algorithm>
+#include <napi.h>
+#include <stdexcept>
+
+namespace NodeDuckDB {
+typedef uint64_t idx_t;
+
+Napi::Object Appender::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "Appender",
+      {StaticMethod("open", &Appender::Open),
+       InstanceMethod("appendRows", &Appender::AppendRows),
+       InstanceMethod("appendColumns", &Appender::AppendColumns),
+       InstanceMethod("flush", &Appender::Flush),
+       InstanceMethod("close", &Appender::Close),
+       InstanceAccessor<&Appender::IsClosed>("isClosed"),
+       InstanceAccessor<&Appender::GetPendingRowCount>("pendingRowCount")});
+
+  AddonData::Get(env)->appender_constructor = Napi::Persistent(func);
+
+  exports.Set("Appender", func);
+  return exports;
+}
+
+static std::unique_ptr<duckdb::DataChunk>
+createChunk(const std::vector<duckdb::LogicalType> &types) {
+  auto chunk = duckdb::make_unique<duckdb::DataChunk>();
+  chunk->Initialize(types);
+  return chunk;
+}
+
+void AppenderSetup::Open() {
+  auto description = connection->TableInfo(schema, table);
+  if (!description) {
+    throw std::runtime_error("Table " + schema + "." + table +
+                             " does not exist");
+  }
+  for (auto &column : description->columns) {
+    types.push_back(column.type);
+    column_labels.push_back("column \"" + column.name + "\"");
+  }
+  appender = std::make_shared<duckdb::Appender>(*connection, schema, table);
+}
+
+Appender::Appender(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<Appender>(info) {
+  Napi::Env env = info.Env();
+  if (!info[0].IsExternal()) {
+    throw Napi::TypeError::New(env, "Use Appender.open to create an appender");
+  }
+  auto &setup = *info[0].As<Napi::External<AppenderSetup>>().Data();
+  connection = std::move(setup.connection);
+  pool = std::move(setup.pool);
+  result_cache = std::move(setup.result_cache);
+  strand = std::move(setup.strand);
+  appender = std::move(setup.appender);
+  types = std::move(setup.types);
+  column_labels = std::move(setup.column_labels);
+  current_chunk = createChunk(types);
+}
+
+Napi::Value Appender::Open(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  try {
+    if (!info[0].IsObject() ||
+        !info[0].ToObject().InstanceOf(
+            AddonData::Get(env)->connection_constructor.Value())) {
+      throw Napi::TypeError::New(env,
+                                 "Must provide a valid Connection object");
+    }
+    if (!info[1].IsString()) {
+      throw Napi::TypeError::New(env, "Second argument must be a string");
+    }
+    if (!info[2].IsUndefined() && !info[2].IsString()) {
+      throw Napi::TypeError::New(env, "Third argument is an optional string");
+    }
+    auto unwrappedConnection = Connection::Unwrap(info[0].ToObject());
+    if (unwrappedConnection->connection == nullptr) {
+      throw Napi::TypeError::New(env, "Connection is closed");
+    }
+
+    auto setup = duckdb::make_unique<AppenderSetup>();
+    setup->connection = unwrappedConnection->connection;
+    setup->pool = unwrappedConnection->pool;
+    setup->result_cache = unwrappedConnection->result_cache;
+    setup->strand = unwrappedConnection->strand;
+    setup->table = info[1].ToString().Utf8Value();
+    setup->schema = info[2].IsUndefined() ? std::string("main")
+                                          : info[2].ToString().Utf8Value();
+    auto strand = setup->strand;
+    auto wk = new AppenderOpener(env, unwrappedConnection->pool,
+                                 std::move(setup), deferred);
+    wk->SetStrand(std::move(strand));
+    wk->Queue();
+  } catch (Napi::Error &e) {
+    deferred.Reject(e.Value());
+  }
+  return deferred.Promise();
+}
+
+void Appender::checkOpen(Napi::Env env) {
+  if (closed) {
+    throw Napi::Error::New(env, "Appender is closed");
+  }
+}
+
+void Appender::completeRows(idx_t count) {
+  current_chunk->SetCardinality(current_chunk->size() + count);
+  if (current_chunk->size() == STANDARD_VECTOR_SIZE) {
+    full_chunks.push_back(std::move(current_chunk));
+    current_chunk = createChunk(types);
+  }
+}
+
+void Appender::appendColumn(Napi::Env env, const Napi::Value &column,
+                            idx_t column_idx, size_t source_offset,
+                            idx_t count) {
+  auto &vector = current_chunk->data[column_idx];
+  auto target_offset = current_chunk->size();
+  if (!column.IsTypedArray()) {
+    auto array = column.As<Napi::Array>();
+    for (idx_t i = 0; i < count; i++) {
+      writer.WriteValue(env,
+                        array.Get(static_cast<uint32_t>(source_offset + i)),
+                        vector, target_offset + i, column_labels[column_idx],
+                        source_offset + i);
+    }
+    return;
+  }
+  if (writer.WriteTypedArray(env, column.As<Napi::TypedArray>(), source_offset,
+                             vector, target_offset, count,
+                             column_labels[column_idx])) {
+    return;
+  }
+  throw Napi::TypeError::New(env, "Column at index " +
+                                      std::to_string(column_idx) +
+                                      ": typed arrays are not supported for " +
+                                      types[column_idx].ToString() +
+                                      " columns");
+}
+
+Napi::Value Appender::AppendRows(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  checkOpen(env);
+  if (!info[0].IsArray()) {
+    throw Napi::TypeError::New(env, "First argument must be an array of rows");
+  }
+
+  auto rows = info[0].As<Napi::Array>();
+  try {
+    for (uint32_t row_idx = 0; row_idx < rows.Length(); row_idx++) {
+      auto row = rows.Get(row_idx);
+      if (!row.IsArray() || row.As<Napi::Array>().Length() != types.size()) {
+        throw Napi::TypeError::New(
+            env, "Row at index " + std::to_string(row_idx) +
+                     " must be an array of " + std::to_string(types.size()) +
+                     " values");
+      }
+      auto values = row.As<Napi::Array>();
+      for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+        writer.WriteValue(env, values.Get(static_cast<uint32_t>(col_idx)),
+                          current_chunk->data[col_idx], current_chunk->size(),
+                          column_labels[col_idx], row_idx);
+      }
+      completeRows(1);
+    }
+  } catch (duckdb::Exception &e) {
+    throw Napi::Error::New(env, e.what());
+  }
+  return env.Undefined();
+}
+
+Napi::Value Appender::AppendColumns(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  checkOpen(env);
+  if (!info[0].IsArray() ||
+      info[0].As<Napi::Array>().Length() != types.size()) {
+    throw Napi::TypeError::New(env, "First argument must be an array of " +
+                                        std::to_string(types.size()) +
+                                        " columns");
+  }
+
+  auto columns_array = info[0].As<Napi::Array>();
+  std::vector<Napi::Value> columns;
+  size_t row_count = 0;
+  for (uint32_t col_idx = 0; col_idx < types.size(); col_idx++) {
+    auto column = columns_array.Get(col_idx);
+    size_t length;
+    if (column.IsTypedArray()) {
+      length = column.As<Napi::TypedArray>().ElementLength();
+    } else if (column.IsArray()) {
+      length = column.As<Napi::Array>().Length();
+    } else {
+      throw Napi::TypeError::New(env, "Column at index " +
+                                          std::to_string(col_idx) +
+                                          " must be an array or a typed array");
+    }
+    if (col_idx > 0 && length != row_count) {
+      throw Napi::TypeError::New(env, "All columns must have the same length");
+    }
+    row_count = length;
+    columns.push_back(column);
+  }
+
+  try {
+    size_t offset = 0;
+    while (offset < row_count) {
+      idx_t count =
+          std::min<size_t>(STANDARD_VECTOR_SIZE - current_chunk->size(),
+                           row_count - offset);
+      for (idx_t col_idx = 0; col_idx < columns.size(); col_idx++) {
+        appendColumn(env, columns[col_idx], col_idx, offset, count);
+      }
+      completeRows(count);
+      offset += count;
+    }
+  } catch (duckdb::Exception &e) {
+    throw Napi::Error::New(env, e.what());
+  }
+  return env.Undefined();
+}
+
+Napi::Value Appender::Flush(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  checkOpen(env);
+  return queueFlush(env, false);
+}
+
+Napi::Value Appender::Close(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (closed) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
+  }
+  closed = true;
+  return queueFlush(env, true);
+}
+
+Napi::Value Appender::IsClosed(const Napi::CallbackInfo &info) {
+  return Napi::Boolean::New(info.Env(), closed);
+}
+
+Napi::Value Appender::GetPendingRowCount(const Napi::CallbackInfo &info) {
+  return Napi::Number::New(info.Env(),
+                           full_chunks.size() * STANDARD_VECTOR_SIZE +
+                               current_chunk->size());
+}
+
+Napi::Value Appender::queueFlush(Napi::Env env, bool close) {
+  auto deferred = Napi::Promise::Deferred::New(env);
+  waiting.push_back(deferred);
+  if (close) {
+    close_requested = true;
+  }
+  if (!flush_in_progress) {
+    startFlush(env);
+  }
+  return deferred.Promise();
+}
+
+void Appender::startFlush(Napi::Env env) {
+  if (current_chunk->size() > 0) {
+    full_chunks.push_back(std::move(current_chunk));
+    current_chunk = createChunk(types);
+  }
+  flush_in_progress = true;
+  auto chunks = std::move(full_chunks);
+  full_chunks.clear();
+  auto deferreds = std::move(waiting);
+  waiting.clear();
+  AppenderFlusher *wk =
+      new AppenderFlusher(env, pool, this, appender, std::move(chunks),
+                          close_requested, std::move(deferreds));
+  wk->result_cache = result_cache;
+  wk->SetStrand(strand);
+  wk->Queue();
+}
+
+void Appender::onFlushed(Napi::Env env,
+                         std::vector<Napi::Promise::Deferred> &deferreds,
+                         const Napi::Error *error) {
+  flush_in_progress = false;
+  for (auto &deferred : deferreds) {
+    if (error) {
+      deferred.Reject(error->Value());
+    } else {
+      deferred.Resolve(env.Undefined());
+    }
+  }
+  if (!waiting.empty()) {
+    startFlush(env);
+  }
+}
+
+AppenderOpener::AppenderOpener(Napi::Env &env,
+                               std::shared_ptr<QueryThreadPool> pool,
+                               std::unique_ptr<AppenderSetup> setup,
+                               Napi::Promise::Deferred &deferred)
+    : QueryWorker(env, std::move(pool)), setup(std::move(setup)),
+      deferred(deferred) {}
+
+void AppenderOpener::Execute() {
+  try {
+    setup->Open();
+  } catch (std::exception &e) {
+    SetError(e.what());
+  }
+}
+
+void AppenderOpener::OnOK() {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+  auto appender = AddonData::Get(env)->appender_constructor.New(
+      {Napi::External<AppenderSetup>::New(env, setup.get())});
+  deferred.Resolve(appender);
+}
+
+void AppenderOpener::OnError(const Napi::Error &e) {
+  deferred.Reject(e.Value());
+}
+
+AppenderFlusher::AppenderFlusher(
+    Napi::Env &env, std::shared_ptr<QueryThreadPool> pool, Appender *owner,
+    std::shared_ptr<duckdb::Appender> appender,
+    std::vector<std::unique_ptr<duckdb::DataChunk>> chunks, bool close,
+    std::vector<Napi::Promise::Deferred> deferreds)
+    : QueryWorker(env, std::move(pool)), owner(owner),
+      owner_ref(Napi::Persistent(owner->Value())),
+      appender(std::move(appender)), chunks(std::move(chunks)), close(close),
+      deferreds(std::move(deferreds)) {}
+
+void AppenderFlusher::Execute() {
+  try {
+    for (auto &chunk : chunks) {
+      appender->AppendDataChunk(*chunk);
+    }
+    chunks.clear();
+    appender->Flush();
+    if (close) {
+      appender->Close();
+    }
+    if (result_cache) {
+      result_cache->Invalidate();
+    }
+  } catch (std::exception &e) {
+    SetError(e.what());
+  } catch (...) {
+    SetError("Unknown Error: Something happened during flushing the appender");
+  }
+}
+
+void AppenderFlusher::OnOK() {
+  Napi::HandleScope scope(Env());
+  owner->onFlushed(Env(), deferreds, nullptr);
+}
+
+void AppenderFlusher::OnError(const Napi::Error &e) {
+  Napi::HandleScope scope(Env());
+  owner->onFlushed(Env(), deferreds, &e);
+}
+} // namespace NodeDuckDB
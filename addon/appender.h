@@ -0,0 +1,115 @@
+#ifndef APPENDER_H
+#define APPENDER_H
+
+#include "duckdb.hpp"
+#include "query_thread_pool.h"
+#include "result_cache.h"
+#include "vector_writer.h"
+#include <memory>
+#include <napi.h>
+#include <string>
+#include <vector>
+
+namespace NodeDuckDB {
+// The table an Appender appends to. Open looks it up and creates the
+// duckdb::Appender, which waits for the connection's client context, so it
+// runs on a query thread, behind the work queued on the connection's strand.
+struct AppenderSetup {
+  std::shared_ptr<duckdb::Connection> connection;
+  std::shared_ptr<QueryThreadPool> pool;
+  std::shared_ptr<ResultCache> result_cache;
+  std::shared_ptr<QueryStrand> strand;
+  std::string schema;
+  std::string table;
+  std::vector<duckdb::LogicalType> types;
+  std::vector<std::string> column_labels;
+  std::shared_ptr<duckdb::Appender> appender;
+  void Open();
+};
+
+// Bulk loads rows into a table. Values are written straight into DataChunks on
+// the JS thread, full chunks are handed to duckdb::Appender on a worker thread
+// by flush/close.
+class Appender : public Napi::ObjectWrap<Appender> {
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  // only constructed by Appender.open, with the AppenderSetup it opened
+  Appender(const Napi::CallbackInfo &info);
+  static Napi::Value Open(const Napi::CallbackInfo &info);
+  void onFlushed(Napi::Env env, std::vector<Napi::Promise::Deferred> &deferreds,
+                 const Napi::Error *error);
+
+private:
+  Napi::Value AppendRows(const Napi::CallbackInfo &info);
+  Napi::Value AppendColumns(const Napi::CallbackInfo &info);
+  Napi::Value Flush(const Napi::CallbackInfo &info);
+  Napi::Value Close(const Napi::CallbackInfo &info);
+  Napi::Value IsClosed(const Napi::CallbackInfo &info);
+  Napi::Value GetPendingRowCount(const Napi::CallbackInfo &info);
+  void checkOpen(Napi::Env env);
+  void appendColumn(Napi::Env env, const Napi::Value &column,
+                    duckdb::idx_t column_idx, size_t source_offset,
+                    duckdb::idx_t count);
+  // moves the current chunk to the chunks to be flushed once it is full
+  void completeRows(duckdb::idx_t count);
+  Napi::Value queueFlush(Napi::Env env, bool close);
+  void startFlush(Napi::Env env);
+
+  std::shared_ptr<duckdb::Connection> connection;
+  std::shared_ptr<QueryThreadPool> pool;
+  std::shared_ptr<ResultCache> result_cache;
+  // the strand of the connection, flushes wait for its queries
+  std::shared_ptr<QueryStrand> strand;
+  std::shared_ptr<duckdb::Appender> appender;
+  std::vector<duckdb::LogicalType> types;
+  // the table's columns as named in errors
+  std::vector<std::string> column_labels;
+  std::unique_ptr<duckdb::DataChunk> current_chunk;
+  std::vector<std::unique_ptr<duckdb::DataChunk>> full_chunks;
+  VectorWriter writer;
+  // only one flush runs at a time so that chunks are appended in order,
+  // flush/close calls made meanwhile are served by the next one
+  bool flush_in_progress = false;
+  std::vector<Napi::Promise::Deferred> waiting;
+  bool close_requested = false;
+  bool closed = false;
+};
+
+class AppenderOpener : public QueryWorker {
+public:
+  AppenderOpener(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                 std::unique_ptr<AppenderSetup> setup,
+                 Napi::Promise::Deferred &deferred);
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+
+private:
+  std::unique_ptr<AppenderSetup> setup;
+  Napi::Promise::Deferred deferred;
+};
+
+class AppenderFlusher : public QueryWorker {
+public:
+  AppenderFlusher(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                  Appender *owner, std::shared_ptr<duckdb::Appender> appender,
+                  std::vector<std::unique_ptr<duckdb::DataChunk>> chunks,
+                  bool close, std::vector<Napi::Promise::Deferred> deferreds);
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+  // invalidated once the appended rows are committed
+  std::shared_ptr<ResultCache> result_cache;
+
+private:
+  Appender *owner;
+  // keeps the owner from being garbage collected while flushing
+  Napi::ObjectReference owner_ref;
+  std::shared_ptr<duckdb::Appender> appender;
+  std::vector<std::unique_ptr<duckdb::DataChunk>> chunks;
+  bool close;
+  std::vector<Napi::Promise::Deferred> deferreds;
+};
+} // namespace NodeDuckDB
+
+#endif
@@ -0,0 +1,474 @@
+#include "arrow_writer.h"
+#include "duckdb.hpp"
+#include <algorithm>
+#include <string.h>
+
+namespace NodeDuckDB {
+typedef uint64_t idx_t;
+
+// Arrow format constants (Schema.fbs / Message.fbs)
+static const uint16_t METADATA_V5 = 4;
+static const uint8_t HEADER_SCHEMA = 1;
+static const uint8_t HEADER_RECORD_BATCH = 3;
+static const uint8_t TYPE_INT = 2;
+static const uint8_t TYPE_FLOATING_POINT = 3;
+static const uint8_t TYPE_BINARY = 4;
+static const uint8_t TYPE_UTF8 = 5;
+static const uint8_t TYPE_BOOL = 6;
+static const uint8_t TYPE_DECIMAL = 7;
+static const uint8_t TYPE_DATE = 8;
+static const uint8_t TYPE_TIME = 9;
+static const uint8_t TYPE_TIMESTAMP = 10;
+static const uint16_t PRECISION_SINGLE = 1;
+static const uint16_t PRECISION_DOUBLE = 2;
+static const uint16_t DATE_UNIT_DAY = 0;
+static const uint16_t TIME_UNIT_MICROSECOND = 2;
+static const uint32_t CONTINUATION_MARKER = 0xFFFFFFFF;
+
+FlatBufferWriter::FlatBufferWriter() : buffer(4, 0) {}
+
+void FlatBufferWriter::Align(size_t alignment) {
+  buffer.resize((buffer.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+void FlatBufferWriter::SetOffset(size_t at, size_t target) {
+  uint32_t offset = static_cast<uint32_t>(target - at);
+  memcpy(buffer.data() + at, &offset, sizeof(offset));
+}
+
+size_t FlatBufferWriter::Table(const std::vector<Field> &fields,
+                               std::vector<size_t> &offsets) {
+  uint16_t field_count = 0;
+  for (auto &field : fields) {
+    field_count = std::max<uint16_t>(field_count, field.id + 1);
+  }
+  Align(2);
+  size_t vtable = buffer.size();
+  uint16_t vtable_size = 4 + 2 * field_count;
+  buffer.resize(vtable + vtable_size, 0);
+  Align(4);
+  size_t table = buffer.size();
+  int32_t vtable_offset = static_cast<int32_t>(table - vtable);
+  buffer.resize(table + 4);
+  memcpy(buffer.data() + table, &vtable_offset, 4);
+  for (auto &field : fields) {
+    size_t size = field.size == 0 ? 4 : field.size;
+    Align(size);
+    size_t position = buffer.size();
+    buffer.resize(position + size, 0);
+    if (field.size == 0) {
+      offsets.push_back(position);
+    } else {
+      // little endian: the low bytes of the value come first
+      memcpy(buffer.data() + position, &field.value, size);
+    }
+    uint16_t field_offset = static_cast<uint16_t>(position - table);
+    memcpy(buffer.data() + vtable + 4 + 2 * field.id, &field_offset, 2);
+  }
+  uint16_t table_size = static_cast<uint16_t>(buffer.size() - table);
+  memcpy(buffer.data() + vtable, &vtable_size, 2);
+  memcpy(buffer.data() + vtable + 2, &table_size, 2);
+  return table;
+}
+
+size_t FlatBufferWriter::String(const std::string &value) {
+  Align(4);
+  size_t position = buffer.size();
+  uint32_t length = static_cast<uint32_t>(value.size());
+  buffer.resize(position + 4 + value.size() + 1, 0);
+  memcpy(buffer.data() + position, &length, 4);
+  memcpy(buffer.data() + position + 4, value.data(), value.size());
+  return position;
+}
+
+size_t FlatBufferWriter::StructVector(const void *data, size_t count,
+                                      size_t element_size) {
+  // the elements (structs of 8 byte fields) have to be 8 byte aligned
+  Align(4);
+  if ((buffer.size() + 4) % 8 != 0) {
+    buffer.resize(buffer.size() + 4, 0);
+  }
+  size_t position = buffer.size();
+  uint32_t length = static_cast<uint32_t>(count);
+  buffer.resize(position + 4 + count * element_size, 0);
+  memcpy(buffer.data() + position, &length, 4);
+  if (count > 0) {
+    memcpy(buffer.data() + position + 4, data, count * element_size);
+  }
+  return position;
+}
+
+size_t FlatBufferWriter::OffsetVector(size_t count,
+                                      std::vector<size_t> &elements) {
+  Align(4);
+  size_t position = buffer.size();
+  uint32_t length = static_cast<uint32_t>(count);
+  buffer.resize(position + 4 + count * 4, 0);
+  memcpy(buffer.data() + position, &length, 4);
+  for (size_t i = 0; i < count; i++) {
+    elements.push_back(position + 4 + i * 4);
+  }
+  return position;
+}
+
+enum class ColumnKind : uint8_t {
+  // fixed width values copied as they are
+  FIXED,
+  BOOLEAN,
+  // string_t values (VARCHAR, BLOB)
+  STRING,
+  // any integer representation widened to a 128 bit decimal
+  DECIMAL,
+  // string representation of a duckdb::Value
+  VALUE
+};
+
+struct ColumnEncoding {
+  ColumnKind kind;
+  idx_t width;
+  uint8_t arrow_type;
+  std::vector<FlatBufferWriter::Field> arrow_type_fields;
+};
+
+static ColumnEncoding intEncoding(idx_t width, bool is_signed) {
+  return ColumnEncoding{
+      ColumnKind::FIXED,
+      width,
+      TYPE_INT,
+      {FlatBufferWriter::Scalar(0, 4, width * 8),
+       FlatBufferWriter::Scalar(1, 1, is_signed ? 1 : 0)}};
+}
+
+static ColumnEncoding getColumnEncoding(const duckdb::LogicalType &type) {
+  typedef FlatBufferWriter FB;
+  switch (type.id()) {
+  case duckdb::LogicalTypeId::BOOLEAN:
+    return ColumnEncoding{ColumnKind::BOOLEAN, 0, TYPE_BOOL, {}};
+  case duckdb::LogicalTypeId::TINYINT:
+    return intEncoding(1, true);
+  case duckdb::LogicalTypeId::SMALLINT:
+    return intEncoding(2, true);
+  case duckdb::LogicalTypeId::INTEGER:
+    return intEncoding(4, true);
+  case duckdb::LogicalTypeId::BIGINT:
+    return intEncoding(8, true);
+  case duckdb::LogicalTypeId::UTINYINT:
+    return intEncoding(1, false);
+  case duckdb::LogicalTypeId::USMALLINT:
+    return intEncoding(2, false);
+  case duckdb::LogicalTypeId::UINTEGER:
+    return intEncoding(4, false);
+  case duckdb::LogicalTypeId::FLOAT:
+    return ColumnEncoding{ColumnKind::FIXED,
+                          4,
+                          TYPE_FLOATING_POINT,
+                          {FB::Scalar(0, 2, PRECISION_SINGLE)}};
+  case duckdb::LogicalTypeId::DOUBLE:
+    return ColumnEncoding{ColumnKind::FIXED,
+                          8,
+                          TYPE_FLOATING_POINT,
+                          {FB::Scalar(0, 2, PRECISION_DOUBLE)}};
+  case duckdb::LogicalTypeId::DATE:
+    // days since epoch
+    return ColumnEncoding{
+        ColumnKind::FIXED, 4, TYPE_DATE, {FB::Scalar(0, 2, DATE_UNIT_DAY)}};
+  case duckdb::LogicalTypeId::TIME:
+    return ColumnEncoding{ColumnKind::FIXED,
+                          8,
+                          TYPE_TIME,
+                          {FB::Scalar(0, 2, TIME_UNIT_MICROSECOND),
+                           FB::Scalar(1, 4, 64)}};
+  case duckdb::LogicalTypeId::TIMESTAMP:
+    return ColumnEncoding{ColumnKind::FIXED,
+                          8,
+                          TYPE_TIMESTAMP,
+                          {FB::Scalar(0, 2, TIME_UNIT_MICROSECOND)}};
+  case duckdb::LogicalTypeId::DECIMAL:
+    return ColumnEncoding{ColumnKind::DECIMAL,
+                          16,
+                          TYPE_DECIMAL,
+                          {FB::Scalar(0, 4, type.width()),
+                           FB::Scalar(1, 4, type.scale()),
+                           FB::Scalar(2, 4, 128)}};
+  case duckdb::LogicalTypeId::HUGEINT:
+    return ColumnEncoding{
+        ColumnKind::DECIMAL,
+        16,
+        TYPE_DECIMAL,
+        {FB::Scalar(0, 4, 38), FB::Scalar(1, 4, 0), FB::Scalar(2, 4, 128)}};
+  case duckdb::LogicalTypeId::VARCHAR:
+    return ColumnEncoding{ColumnKind::STRING, 0, TYPE_UTF8, {}};
+  case duckdb::LogicalTypeId::BLOB:
+    return ColumnEncoding{ColumnKind::STRING, 0, TYPE_BINARY, {}};
+  default:
+    return ColumnEncoding{ColumnKind::VALUE, 0, TYPE_UTF8, {}};
+  }
+}
+
+ArrowIPCWriter::ArrowIPCWriter(const std::vector<std::string> &names,
+                               const std::vector<duckdb::LogicalType> &types)
+    : names(names), types(types) {}
+
+void ArrowIPCWriter::writeMessage(FlatBufferWriter &metadata,
+                                  std::vector<uint8_t> &out) {
+  // the metadata is padded so that the body starts 8 byte aligned
+  int32_t metadata_size =
+      static_cast<int32_t>((metadata.buffer.size() + 7) / 8 * 8);
+  size_t position = out.size();
+  out.resize(position + 8 + metadata_size, 0);
+  memcpy(out.data() + position, &CONTINUATION_MARKER, 4);
+  memcpy(out.data() + position + 4, &metadata_size, 4);
+  memcpy(out.data() + position + 8, metadata.buffer.data(),
+         metadata.buffer.size());
+}
+
+void ArrowIPCWriter::WriteEndOfStream(std::vector<uint8_t> &out) {
+  size_t position = out.size();
+  out.resize(position + 8, 0);
+  memcpy(out.data() + position, &CONTINUATION_MARKER, 4);
+}
+
+void ArrowIPCWriter::WriteSchema(std::vector<uint8_t> &out) {
+  typedef FlatBufferWriter FB;
+  FlatBufferWriter fb;
+  std::vector<size_t> message_offsets;
+  auto message = fb.Table({FB::Scalar(0, 2, METADATA_V5),
+                           FB::Scalar(1, 1, HEADER_SCHEMA), FB::Offset(2),
+                           FB::Scalar(3, 8, 0)},
+                          message_offsets);
+  fb.SetRoot(message);
+
+  std::vector<size_t> schema_offsets;
+  // endianness 0 is little endian
+  auto schema = fb.Table({FB::Scalar(0, 2, 0), FB::Offset(1)}, schema_offsets);
+  fb.SetOffset(message_offsets[0], schema);
+
+  std::vector<size_t> field_positions;
+  fb.SetOffset(schema_offsets[0],
+               fb.OffsetVector(types.size(), field_positions));
+  for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+    auto encoding = getColumnEncoding(types[col_idx]);
+    std::vector<size_t> field_offsets;
+    auto field = fb.Table({FB::Offset(0), FB::Scalar(1, 1, 1),
+                           FB::Scalar(2, 1, encoding.arrow_type),
+                           FB::Offset(3), FB::Offset(5)},
+                          field_offsets);
+    fb.SetOffset(field_positions[col_idx], field);
+    fb.SetOffset(field_offsets[0], fb.String(names[col_idx]));
+    std::vector<size_t> unused;
+    fb.SetOffset(field_offsets[1],
+                 fb.Table(encoding.arrow_type_fields, unused));
+    fb.SetOffset(field_offsets[2], fb.OffsetVector(0, unused));
+  }
+  writeMessage(fb, out);
+}
+
+struct ColumnBuffers {
+  ColumnEncoding encoding;
+  duckdb::PhysicalType physical_type;
+  duckdb::VectorData vdata;
+  bool is_flat;
+  int64_t null_count;
+  // VALUE columns are rendered once to size the buffers
+  std::vector<std::string> values;
+  std::vector<int64_t> lengths;
+};
+
+static int64_t padded(int64_t length) { return (length + 7) / 8 * 8; }
+
+static void writeValidity(const ColumnBuffers &column, idx_t count,
+                          uint8_t *target) {
+  for (idx_t i = 0; i < count; i++) {
+    if (column.vdata.validity.RowIsValid(column.vdata.sel->get_index(i))) {
+      target[i / 8] |= 1 << (i % 8);
+    }
+  }
+}
+
+template <class T>
+static void writeDecimals(const ColumnBuffers &column, idx_t count,
+                          uint8_t *target) {
+  auto source = reinterpret_cast<const T *>(column.vdata.data);
+  for (idx_t i = 0; i < count; i++) {
+    int64_t value = source[column.vdata.sel->get_index(i)];
+    uint64_t words[2] = {static_cast<uint64_t>(value),
+                         value < 0 ? ~0ULL : 0ULL};
+    memcpy(target + i * 16, words, 16);
+  }
+}
+
+static void writeValues(ColumnBuffers &column, idx_t count,
+                        std::vector<uint8_t *> &targets) {
+  auto &vdata = column.vdata;
+  switch (column.encoding.kind) {
+  case ColumnKind::FIXED: {
+    auto width = column.encoding.width;
+    if (column.is_flat) {
+      memcpy(targets[1], vdata.data, count * width);
+      return;
+    }
+    for (idx_t i = 0; i < count; i++) {
+      memcpy(targets[1] + i * width,
+             vdata.data + vdata.sel->get_index(i) * width, width);
+    }
+    return;
+  }
+  case ColumnKind::BOOLEAN: {
+    auto source = reinterpret_cast<const bool *>(vdata.data);
+    for (idx_t i = 0; i < count; i++) {
+      if (source[vdata.sel->get_index(i)]) {
+        targets[1][i / 8] |= 1 << (i % 8);
+      }
+    }
+    return;
+  }
+  case ColumnKind::STRING: {
+    auto source = reinterpret_cast<const duckdb::string_t *>(vdata.data);
+    auto offsets = reinterpret_cast<int32_t *>(targets[1]);
+    int32_t offset = 0;
+    for (idx_t i = 0; i < count; i++) {
+      offsets[i] = offset;
+      auto idx = vdata.sel->get_index(i);
+      if (vdata.validity.RowIsValid(idx)) {
+        auto size = source[idx].GetSize();
+        memcpy(targets[2] + offset, source[idx].GetDataUnsafe(), size);
+        offset += size;
+      }
+    }
+    offsets[count] = offset;
+    return;
+  }
+  case ColumnKind::VALUE: {
+    auto offsets = reinterpret_cast<int32_t *>(targets[1]);
+    int32_t offset = 0;
+    for (idx_t i = 0; i < count; i++) {
+      offsets[i] = offset;
+      memcpy(targets[2] + offset, column.values[i].data(),
+             column.values[i].size());
+      offset += column.values[i].size();
+    }
+    offsets[count] = offset;
+    return;
+  }
+  case ColumnKind::DECIMAL:
+    switch (column.physical_type) {
+    case duckdb::PhysicalType::INT16:
+      writeDecimals<int16_t>(column, count, targets[1]);
+      return;
+    case duckdb::PhysicalType::INT32:
+      writeDecimals<int32_t>(column, count, targets[1]);
+      return;
+    case duckdb::PhysicalType::INT64:
+      writeDecimals<int64_t>(column, count, targets[1]);
+      return;
+    default: {
+      auto source = reinterpret_cast<const duckdb::hugeint_t *>(vdata.data);
+      for (idx_t i = 0; i < count; i++) {
+        auto &value = source[vdata.sel->get_index(i)];
+        uint64_t words[2] = {value.lower, static_cast<uint64_t>(value.upper)};
+        memcpy(targets[1] + i * 16, words, 16);
+      }
+      return;
+    }
+    }
+  }
+}
+
+void ArrowIPCWriter::WriteRecordBatch(duckdb::DataChunk &chunk,
+                                      std::vector<uint8_t> &out) {
+  typedef FlatBufferWriter FB;
+  idx_t count = chunk.size();
+  std::vector<ColumnBuffers> columns(types.size());
+  std::vector<int64_t> nodes;
+  std::vector<int64_t> buffers;
+  int64_t body_length = 0;
+  for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+    auto &vector = chunk.data[col_idx];
+    auto &column = columns[col_idx];
+    column.encoding = getColumnEncoding(types[col_idx]);
+    column.physical_type = types[col_idx].InternalType();
+    column.is_flat = vector.GetVectorType() == duckdb::VectorType::FLAT_VECTOR;
+    vector.Orrify(count, column.vdata);
+    column.null_count = 0;
+    int64_t string_bytes = 0;
+    for (idx_t i = 0; i < count; i++) {
+      auto idx = column.vdata.sel->get_index(i);
+      if (!column.vdata.validity.RowIsValid(idx)) {
+        column.null_count++;
+        if (column.encoding.kind == ColumnKind::VALUE) {
+          column.values.push_back(std::string());
+        }
+        continue;
+      }
+      if (column.encoding.kind == ColumnKind::STRING) {
+        string_bytes +=
+            reinterpret_cast<const duckdb::string_t *>(column.vdata.data)[idx]
+                .GetSize();
+      } else if (column.encoding.kind == ColumnKind::VALUE) {
+        column.values.push_back(vector.GetValue(i).ToString());
+        string_bytes += column.values.back().size();
+      }
+    }
+
+    // validity bitmaps may be omitted when there are no nulls
+    column.lengths.push_back(column.null_count > 0 ? (count + 7) / 8 : 0);
+    switch (column.encoding.kind) {
+    case ColumnKind::FIXED:
+    case ColumnKind::DECIMAL:
+      column.lengths.push_back(count * column.encoding.width);
+      break;
+    case ColumnKind::BOOLEAN:
+      column.lengths.push_back((count + 7) / 8);
+      break;
+    case ColumnKind::STRING:
+    case ColumnKind::VALUE:
+      column.lengths.push_back((count + 1) * sizeof(int32_t));
+      column.lengths.push_back(string_bytes);
+      break;
+    }
+
+    nodes.push_back(count);
+    nodes.push_back(column.null_count);
+    for (auto length : column.lengths) {
+      buffers.push_back(body_length);
+      buffers.push_back(length);
+      body_length += padded(length);
+    }
+  }
+
+  FlatBufferWriter fb;
+  std::vector<size_t> message_offsets;
+  auto message = fb.Table({FB::Scalar(0, 2, METADATA_V5),
+                           FB::Scalar(1, 1, HEADER_RECORD_BATCH),
+                           FB::Offset(2), FB::Scalar(3, 8, body_length)},
+                          message_offsets);
+  fb.SetRoot(message);
+  std::vector<size_t> batch_offsets;
+  auto batch = fb.Table({FB::Scalar(0, 8, count), FB::Offset(1), FB::Offset(2)},
+                        batch_offsets);
+  fb.SetOffset(message_offsets[0], batch);
+  // FieldNode and Buffer are both structs of two longs
+  fb.SetOffset(batch_offsets[0],
+               fb.StructVector(nodes.data(), nodes.size() / 2, 16));
+  fb.SetOffset(batch_offsets[1],
+               fb.StructVector(buffers.data(), buffers.size() / 2, 16));
+  writeMessage(fb, out);
+
+  // the body is written in place, zero filled so that padding and the
+  // validity/boolean bitmaps start out cleared
+  size_t body = out.size();
+  out.resize(body + body_length, 0);
+  size_t buffer_idx = 0;
+  for (auto &column : columns) {
+    std::vector<uint8_t *> targets;
+    for (size_t i = 0; i < column.lengths.size(); i++) {
+      targets.push_back(out.data() + body + buffers[buffer_idx * 2]);
+      buffer_idx++;
+    }
+    if (column.null_count > 0) {
+      writeValidity(column, count, targets[0]);
+    }
+    writeValues(column, count, targets);
+  }
+}
+} // namespace NodeDuckDB
@@ -0,0 +1,64 @@
+#ifndef ARROW_WRITER_H
+#define ARROW_WRITER_H
+
+#include "duckdb.hpp"
+#include <string>
+#include <vector>
+
+namespace NodeDuckDB {
+// Minimal flatbuffer writer for the Arrow IPC metadata. Unlike the usual
+// back to front builders it writes front to back: a table is written before
+// the tables, vectors and strings it references, and the offsets to those are
+// patched in once they are written (flatbuffer offsets always point to higher
+// addresses).
+class FlatBufferWriter {
+public:
+  struct Field {
+    uint16_t id;
+    // size of a scalar field in bytes, 0 marks an offset field
+    uint8_t size;
+    uint64_t value;
+  };
+  static Field Scalar(uint16_t id, uint8_t size, uint64_t value) {
+    return Field{id, size, value};
+  }
+  static Field Offset(uint16_t id) { return Field{id, 0, 0}; }
+
+  FlatBufferWriter();
+  // Writes a table and its vtable, returns the position of the table. The
+  // positions of the offset fields are appended to `offsets` in field order.
+  size_t Table(const std::vector<Field> &fields, std::vector<size_t> &offsets);
+  size_t String(const std::string &value);
+  size_t StructVector(const void *data, size_t count, size_t element_size);
+  // Writes a vector of offsets, the positions of its elements are appended to
+  // `elements`
+  size_t OffsetVector(size_t count, std::vector<size_t> &elements);
+  void SetOffset(size_t at, size_t target);
+  void SetRoot(size_t table) { SetOffset(0, table); }
+  std::vector<uint8_t> buffer;
+
+private:
+  void Align(size_t alignment);
+};
+
+// Serializes the chunks of a query result into the Arrow IPC streaming
+// format. Columns without an Arrow counterpart (INTERVAL, LIST, STRUCT, ...)
+// are written as their string representation.
+class ArrowIPCWriter {
+public:
+  ArrowIPCWriter(const std::vector<std::string> &names,
+                 const std::vector<duckdb::LogicalType> &types);
+  // Appends the Schema message, has to precede the record batches
+  void WriteSchema(std::vector<uint8_t> &out);
+  // Appends a RecordBatch message holding all rows of the chunk
+  void WriteRecordBatch(duckdb::DataChunk &chunk, std::vector<uint8_t> &out);
+  static void WriteEndOfStream(std::vector<uint8_t> &out);
+
+private:
+  const std::vector<std::string> &names;
+  const std::vector<duckdb::LogicalType> &types;
+  void writeMessage(FlatBufferWriter &metadata, std::vector<uint8_t> &out);
+};
+} // namespace NodeDuckDB
+
+#endif
@@ -1,5 +1,9 @@
 #include "async_executor.h"
+#include "addon_data.h"
 #include "duckdb.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "result_cache.h"
 #include "result_iterator.h"
 #include <iostream>
 #include <napi.h>
@@ -8,21 +12,77 @@
 using namespace duckdb;
 
 namespace NodeDuckDB {
+// Size of a materialized result, results of other types only hold the chunks
+// fetched ahead
+static uint64_t resultByteSize(duckdb::QueryResult &result) {
+  if (!result.success ||
+      result.type != duckdb::QueryResultType::MATERIALIZED_RESULT) {
+    return 0;
+  }
+  auto &collection =
+      static_cast<duckdb::MaterializedQueryResult &>(result).collection;
+  uint64_t size = 0;
+  for (idx_t i = 0; i < collection.ChunkCount(); i++) {
+    size += chunkByteSize(collection.GetChunk(i));
+  }
+  return size;
+}
+
 AsyncExecutor::AsyncExecutor(
-    Napi::Env &env, std::string &query,
-    std::shared_ptr<duckdb::Connection> &connection,
+    Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+    std::string &query, std::shared_ptr<duckdb::Connection> &connection,
     Napi::Promise::Deferred &deferred, bool forceMaterialized,
-    ResultFormat &rowResultFormat,
-    std::shared_ptr<std::vector<ResultIterator *>> results)
-    : Napi::AsyncWorker(env), query(query), connection(connection),
+    ResultOptions &resultOptions,
+    std::shared_ptr<ResultRegistry> results,
+    std::shared_ptr<std::atomic<uint32_t>> interrupt_count)
+    : QueryWorker(env, std::move(pool)), query(query), connection(connection),
       deferred(deferred), forceMaterialized(forceMaterialized),
-      rowResultFormat(rowResultFormat), results(std::move(results)) {}
+      resultOptions(resultOptions), results(std::move(results)),
+      interrupt_count(interrupt_count),
+      queued_interrupt_count(interrupt_count->load()) {}
+
+AsyncExecutor::AsyncExecutor(
+    Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+    std::shared_ptr<duckdb::PreparedStatement> &prepared,
+    std::vector<duckdb::Value> &parameters,
+    std::shared_ptr<duckdb::Connection> &connection,
+    Napi::Promise::Deferred &deferred, bool forceMaterialized,
+    ResultOptions &resultOptions,
+    std::shared_ptr<ResultRegistry> results,
+    std::shared_ptr<std::atomic<uint32_t>> interrupt_count)
+    : QueryWorker(env, std::move(pool)), prepared(prepared),
+      parameters(parameters), connection(connection), deferred(deferred),
+      forceMaterialized(forceMaterialized), resultOptions(resultOptions),
+      results(std::move(results)), interrupt_count(interrupt_count),
+      queued_interrupt_count(interrupt_count->load()) {}
 
 AsyncExecutor::~AsyncExecutor() {}
 
 void AsyncExecutor::Execute() {
+  bool cancelled = cancellations && !cancellations->Start(request_id);
+  if (cancelled || interrupt_count->load() != queued_interrupt_count) {
+    if (cancellations) {
+      cancellations->Finish(request_id);
+    }
+    SetError(INTERRUPTED_ERROR);
+    return;
+  }
   try {
-    if (forceMaterialized) {
+    std::string cache_key;
+    bool writes = false;
+    if (serveCached(cache_key, writes)) {
+      if (cancellations) {
+        cancellations->Finish(request_id);
+      }
+      return;
+    }
+    uint64_t cache_generation = result_cache ? result_cache->Generation() : 0;
+    if (resultOptions.profile) {
+      connection->EnableProfiling();
+    }
+    if (prepared) {
+      result = prepared->Execute(parameters, !forceMaterialized);
+    } else if (forceMaterialized) {
       result = connection->Query(query);
     } else {
       result = connection->SendQuery(query);
@@ -30,22 +90,295 @@ void AsyncExecutor::Execute() {
     if (!result.get()->success) {
       SetError(result.get()->error);
     }
+    result_bytes = resultByteSize(*result);
+    if (result_cache) {
+      // also when the query failed, the statements of a query string before
+      // the failing one have been committed
+      if (writes) {
+        result_cache->Invalidate();
+      } else if (!cache_key.empty() && result->success &&
+                 result->type ==
+                     duckdb::QueryResultType::MATERIALIZED_RESULT) {
+        result_cache->Put(
+            cache_key, static_cast<duckdb::MaterializedQueryResult &>(*result),
+            cache_generation);
+        cached = true;
+      }
+    }
+    // a streaming query is only profiled once its result is exhausted
+    if (resultOptions.profile &&
+        (!result->success ||
+         result->type != duckdb::QueryResultType::STREAM_RESULT)) {
+      if (result->success) {
+        profile = connection->GetProfilingInformation(
+            duckdb::ProfilerPrintFormat::JSON);
+      }
+      connection->DisableProfiling();
+    }
   } catch (...) {
+    if (resultOptions.profile) {
+      connection->DisableProfiling();
+    }
     SetError("Unknown Error: Something happened during execution of the query");
   }
+  // a streaming query keeps using the connection until its result is read
+  bool streaming = result && result->success &&
+                   result->type == duckdb::QueryResultType::STREAM_RESULT;
+  if (cancellations && !streaming) {
+    cancellations->Finish(request_id);
+  }
+}
+
+// Serves the query from the result cache. Sets `key` when a materialized
+// result of the query may be cached, and `writes` when the query may change
+// data or settings, which invalidates the cache once it ran.
+bool AsyncExecutor::serveCached(std::string &key, bool &writes) {
+  if (!result_cache) {
+    return false;
+  }
+  if (prepared) {
+    writes = ResultCache::IsWrite(prepared->type);
+    // the statement isn't at hand, a CREATE may be temporary
+    if (prepared->type == duckdb::StatementType::CREATE_STATEMENT) {
+      temp_objects->store(true);
+    }
+  } else {
+    std::vector<std::unique_ptr<duckdb::SQLStatement>> statements;
+    try {
+      statements = connection->ExtractStatements(query);
+    } catch (duckdb::Exception &e) {
+      // running the query reports the error
+      return false;
+    }
+    for (auto &statement : statements) {
+      writes = writes || ResultCache::IsWrite(statement->type);
+      if (ResultCache::CreatesTemporary(*statement)) {
+        temp_objects->store(true);
+      }
+    }
+    if (statements.size() != 1) {
+      return false;
+    }
+  }
+  // a transaction may read its own uncommitted changes
+  if (writes || !resultOptions.cache || resultOptions.profile ||
+      !connection->context->transaction.IsAutoCommit() ||
+      temp_objects->load()) {
+    return false;
+  }
+  if (result_cache->IsVolatile(prepared ? prepared->query : query)) {
+    return false;
+  }
+  key = prepared ? ResultCache::Key(prepared->query, parameters)
+                 : ResultCache::Key(query);
+  auto entry = result_cache->Get(key);
+  if (!entry) {
+    return false;
+  }
+  result = duckdb::make_unique<CachedQueryResult>(std::move(entry));
+  cached = true;
+  return true;
 }
 
 void AsyncExecutor::OnOK() {
   Napi::HandleScope scope(Env());
-  Napi::Object result_iterator = ResultIterator::Create();
+  Napi::Object result_iterator = ResultIterator::Create(Env());
   ResultIterator *result_unwrapped = ResultIterator::Unwrap(result_iterator);
   result_unwrapped->result = std::move(result);
-  result_unwrapped->rowResultFormat = rowResultFormat;
-  results->push_back(result_unwrapped);
+  result_unwrapped->options = resultOptions;
+  result_unwrapped->pool = Pool();
+  result_unwrapped->metrics.queue_wait_ms = QueueWaitMs();
+  result_unwrapped->metrics.execute_ms = ExecuteMs();
+  result_unwrapped->shared_chunks = cached;
+  if (resultOptions.profile) {
+    if (result_unwrapped->result->type ==
+        duckdb::QueryResultType::STREAM_RESULT) {
+      result_unwrapped->profiled_connection = connection;
+    } else {
+      result_unwrapped->profile = std::move(profile);
+    }
+  }
+  results->Add(result_unwrapped);
+  result_unwrapped->registry = results;
+  // streaming results only hold the few chunks fetched ahead
+  result_unwrapped->setExternalMemory(result_bytes);
+  if (cancellations && !release) {
+    auto cancellations = this->cancellations;
+    auto request_id = this->request_id;
+    release = [cancellations, request_id]() {
+      cancellations->Finish(request_id);
+    };
+  }
+  if (release) {
+    // streaming results keep using the connection until they are read
+    if (result_unwrapped->result->type ==
+        duckdb::QueryResultType::STREAM_RESULT) {
+      result_unwrapped->release = std::move(release);
+    } else {
+      release();
+    }
+  }
+  if (result_unwrapped->result->type ==
+          duckdb::QueryResultType::STREAM_RESULT &&
+      ResultCache::NamesAny(prepared ? prepared->query : query,
+                            AddonData::Get(Env())->js_functions)) {
+    result_unwrapped->calls_js = true;
+    result_unwrapped->calls_js_off_thread =
+        duckdb::TaskScheduler::GetScheduler(*connection->context)
+            .NumberOfThreads() > 1;
+  }
   deferred.Resolve(result_iterator);
 }
 
 void AsyncExecutor::OnError(const Napi::Error &e) {
+  if (release) {
+    release();
+  }
+  tagInterruptedError(e);
+  deferred.Reject(e.Value());
+}
+
+BatchExecutor::BatchExecutor(
+    Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+    std::vector<std::string> queries,
+    std::shared_ptr<duckdb::Connection> &connection,
+    Napi::Promise::Deferred &deferred, bool transaction,
+    ResultOptions &resultOptions, std::shared_ptr<ResultRegistry> results,
+    std::shared_ptr<std::atomic<uint32_t>> interrupt_count)
+    : QueryWorker(env, std::move(pool)), queries(std::move(queries)),
+      connection(connection), deferred(deferred), transaction(transaction),
+      resultOptions(resultOptions), results(std::move(results)),
+      interrupt_count(interrupt_count),
+      queued_interrupt_count(interrupt_count->load()) {}
+
+// Rows changed by INSERT, UPDATE, DELETE and COPY, which return that count as
+// their only value, rows returned by any other statement
+static int64_t statementRowCount(duckdb::MaterializedQueryResult &result) {
+  switch (result.statement_type) {
+  case StatementType::INSERT_STATEMENT:
+  case StatementType::UPDATE_STATEMENT:
+  case StatementType::DELETE_STATEMENT:
+  case StatementType::COPY_STATEMENT:
+    if (result.collection.Count() == 1 && result.types.size() == 1) {
+      return result.collection.GetValue(0, 0).GetValue<int64_t>();
+    }
+    break;
+  default:
+    break;
+  }
+  return result.collection.Count();
+}
+
+void BatchExecutor::Execute() {
+  bool cancelled = cancellations && !cancellations->Start(request_id);
+  if (cancelled || interrupt_count->load() != queued_interrupt_count) {
+    if (cancellations) {
+      cancellations->Finish(request_id);
+    }
+    SetError(INTERRUPTED_ERROR);
+    return;
+  }
+  bool writes = false;
+  try {
+    std::vector<std::unique_ptr<duckdb::SQLStatement>> statements;
+    for (auto &query : queries) {
+      auto parsed = connection->ExtractStatements(query);
+      for (auto &statement : parsed) {
+        writes = writes || ResultCache::IsWrite(statement->type);
+        if (ResultCache::CreatesTemporary(*statement)) {
+          temp_objects->store(true);
+        }
+        statements.push_back(std::move(statement));
+      }
+    }
+    if (statements.empty()) {
+      SetError("Invalid argument: the batch contains no statements");
+      return;
+    }
+    if (transaction) {
+      connection->BeginTransaction();
+    }
+    bool succeeded = runStatements(statements);
+    if (transaction) {
+      if (succeeded) {
+        connection->Commit();
+      } else {
+        connection->Rollback();
+      }
+    }
+  } catch (std::exception &e) {
+    SetError(e.what());
+  } catch (...) {
+    SetError("Unknown Error: Something happened during execution of the batch");
+  }
+  // statements that ran before a failing one outside of a transaction have
+  // been committed
+  if (writes && result_cache) {
+    result_cache->Invalidate();
+  }
+  if (cancellations) {
+    cancellations->Finish(request_id);
+  }
+}
+
+// Stops at the first failing statement, earlier ones are only undone when the
+// batch runs in a transaction
+bool BatchExecutor::runStatements(
+    std::vector<std::unique_ptr<duckdb::SQLStatement>> &statements) {
+  for (idx_t i = 0; i < statements.size(); i++) {
+    // interrupting the connection or cancelling the batch also cancels the
+    // statements yet to run
+    if (interrupt_count->load() != queued_interrupt_count ||
+        (cancellations && cancellations->IsCancelled(request_id))) {
+      failed_statement = i;
+      SetError(INTERRUPTED_ERROR);
+      return false;
+    }
+    auto statement_result = connection->Query(std::move(statements[i]));
+    if (!statement_result->success) {
+      failed_statement = i;
+      SetError(statement_result->error);
+      return false;
+    }
+    row_counts.push_back(statementRowCount(*statement_result));
+    if (i == statements.size() - 1) {
+      result_bytes = resultByteSize(*statement_result);
+      result = std::move(statement_result);
+    }
+  }
+  return true;
+}
+
+void BatchExecutor::OnOK() {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+  Napi::Object result_iterator = ResultIterator::Create(env);
+  ResultIterator *result_unwrapped = ResultIterator::Unwrap(result_iterator);
+  result_unwrapped->result = std::move(result);
+  result_unwrapped->options = resultOptions;
+  result_unwrapped->pool = Pool();
+  result_unwrapped->metrics.queue_wait_ms = QueueWaitMs();
+  result_unwrapped->metrics.execute_ms = ExecuteMs();
+  results->Add(result_unwrapped);
+  result_unwrapped->registry = results;
+  result_unwrapped->setExternalMemory(result_bytes);
+
+  Napi::Array counts = Napi::Array::New(env, row_counts.size());
+  for (idx_t i = 0; i < row_counts.size(); i++) {
+    counts.Set(i, Napi::Number::New(env, row_counts[i]));
+  }
+  Napi::Object batch = Napi::Object::New(env);
+  batch.Set("rowCounts", counts);
+  batch.Set("result", result_iterator);
+  deferred.Resolve(batch);
+}
+
+void BatchExecutor::OnError(const Napi::Error &e) {
+  tagInterruptedError(e);
+  if (failed_statement >= 0) {
+    e.Value().Set("statementIndex",
+                  Napi::Number::New(e.Env(), failed_statement));
+  }
   deferred.Reject(e.Value());
 }
 } // namespace NodeDuckDB
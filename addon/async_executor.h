@@ -1,29 +1,112 @@
 #include "duckdb.hpp"
+#include "query_cancellations.h"
+#include "query_thread_pool.h"
+#include "result_cache.h"
 #include "result_iterator.h"
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <napi.h>
 #include <string>
+#include <vector>
 
 namespace NodeDuckDB {
-class AsyncExecutor : public Napi::AsyncWorker {
+class AsyncExecutor : public QueryWorker {
 public:
-  AsyncExecutor(Napi::Env &env, std::string &query,
+  AsyncExecutor(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                std::string &query,
                 std::shared_ptr<duckdb::Connection> &connection,
                 Napi::Promise::Deferred &deferred, bool forceMaterialized,
-                ResultFormat &rowResultFormat,
-                std::shared_ptr<std::vector<ResultIterator *>> results);
+                ResultOptions &resultOptions,
+                std::shared_ptr<ResultRegistry> results,
+                std::shared_ptr<std::atomic<uint32_t>> interrupt_count);
+  AsyncExecutor(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                std::shared_ptr<duckdb::PreparedStatement> &prepared,
+                std::vector<duckdb::Value> &parameters,
+                std::shared_ptr<duckdb::Connection> &connection,
+                Napi::Promise::Deferred &deferred, bool forceMaterialized,
+                ResultOptions &resultOptions,
+                std::shared_ptr<ResultRegistry> results,
+                std::shared_ptr<std::atomic<uint32_t>> interrupt_count);
   ~AsyncExecutor();
   void Execute() override;
   void OnOK() override;
   void OnError(const Napi::Error &e) override;
+  // set by ConnectionPool, called once the connection can run the next query
+  std::function<void()> release;
+  // the database's result cache, if it has one
+  std::shared_ptr<ResultCache> result_cache;
+  // set once the connection created a temporary object, which may shadow a
+  // table of the same name, its queries then bypass the result cache
+  std::shared_ptr<std::atomic<bool>> temp_objects;
+  // set by Connection and PreparedStatement for the query's timeoutMs and
+  // signal
+  std::shared_ptr<QueryCancellations> cancellations;
+  uint32_t request_id = 0;
 
 private:
   std::string query;
-  ResultFormat rowResultFormat;
+  // set when executing a prepared statement instead of a query string
+  std::shared_ptr<duckdb::PreparedStatement> prepared;
+  std::vector<duckdb::Value> parameters;
+  ResultOptions resultOptions;
   std::shared_ptr<duckdb::Connection> connection;
   std::unique_ptr<duckdb::QueryResult> result;
-  std::shared_ptr<std::vector<ResultIterator *>> results;
+  // profiler output of a materialized result
+  std::string profile;
+  // size of a materialized result
+  uint64_t result_bytes = 0;
+  // the result was served from or put into the result cache
+  bool cached = false;
+  std::shared_ptr<ResultRegistry> results;
   Napi::Promise::Deferred deferred;
   bool forceMaterialized;
+  // connection.interrupt() calls made since the query was queued cancel it
+  // before it starts, as interrupting the client context only affects the
+  // query that is running
+  std::shared_ptr<std::atomic<uint32_t>> interrupt_count;
+  uint32_t queued_interrupt_count;
+  bool serveCached(std::string &key, bool &writes);
+};
+
+// Runs the statements of connection.executeBatch back to back on one query
+// thread, optionally inside a single transaction. Resolves with the number of
+// rows each statement changed or returned and the materialized result of the
+// last statement. Other work on the connection waits on its strand until the
+// batch is done, keeping it out of the transaction.
+class BatchExecutor : public QueryWorker {
+public:
+  BatchExecutor(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                std::vector<std::string> queries,
+                std::shared_ptr<duckdb::Connection> &connection,
+                Napi::Promise::Deferred &deferred, bool transaction,
+                ResultOptions &resultOptions,
+                std::shared_ptr<ResultRegistry> results,
+                std::shared_ptr<std::atomic<uint32_t>> interrupt_count);
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+  // the database's result cache, if it has one
+  std::shared_ptr<ResultCache> result_cache;
+  std::shared_ptr<std::atomic<bool>> temp_objects;
+  std::shared_ptr<QueryCancellations> cancellations;
+  uint32_t request_id = 0;
+
+private:
+  std::vector<std::string> queries;
+  std::shared_ptr<duckdb::Connection> connection;
+  Napi::Promise::Deferred deferred;
+  bool transaction;
+  ResultOptions resultOptions;
+  std::shared_ptr<ResultRegistry> results;
+  std::shared_ptr<std::atomic<uint32_t>> interrupt_count;
+  uint32_t queued_interrupt_count;
+  std::vector<int64_t> row_counts;
+  // index of the statement that failed, -1 if parsing or the commit failed
+  int64_t failed_statement = -1;
+  std::unique_ptr<duckdb::QueryResult> result;
+  uint64_t result_bytes = 0;
+  bool runStatements(
+      std::vector<std::unique_ptr<duckdb::SQLStatement>> &statements);
 };
 } // namespace NodeDuckDB
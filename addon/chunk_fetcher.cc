@@ -0,0 +1,283 @@
+#include "chunk_fetcher.h"
+#include "arrow_writer.h"
+#include "duckdb.hpp"
+#include "result_iterator.h"
+#include <chrono>
+#include <errno.h>
+#include <napi.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace NodeDuckDB {
+ChunkFetcher::ChunkFetcher(Napi::Env &env,
+                           std::shared_ptr<QueryThreadPool> pool,
+                           ResultIterator *iterator,
+                           std::shared_ptr<duckdb::QueryResult> result,
+                           uint32_t chunk_count,
+                           std::shared_ptr<PrefetchHandoff> handoff)
+    : QueryWorker(env, std::move(pool)), iterator(iterator),
+      iterator_ref(Napi::Persistent(iterator->Value())),
+      result(std::move(result)), chunk_count(chunk_count),
+      handoff(std::move(handoff)) {}
+
+ChunkFetcher::~ChunkFetcher() {}
+
+bool ChunkFetcher::isAdopted() {
+  std::lock_guard<std::mutex> guard(handoff->lock);
+  return handoff->state == PrefetchHandoff::State::ADOPTED;
+}
+
+void ChunkFetcher::Execute() {
+  {
+    std::lock_guard<std::mutex> guard(handoff->lock);
+    if (handoff->state == PrefetchHandoff::State::ADOPTED) {
+      // a synchronous fetch took over before the prefetch started
+      return;
+    }
+    handoff->state = PrefetchHandoff::State::RUNNING;
+  }
+  std::vector<std::unique_ptr<duckdb::DataChunk>> chunks;
+  bool is_exhausted = false;
+  std::string error;
+  auto start = std::chrono::steady_clock::now();
+  try {
+    for (uint32_t i = 0; i < chunk_count; i++) {
+      auto chunk = result->Fetch();
+      if (!chunk || chunk->size() == 0) {
+        is_exhausted = true;
+        break;
+      }
+      chunks.push_back(std::move(chunk));
+    }
+  } catch (const duckdb::InvalidInputException &e) {
+    error = isInactiveStreamError(e) ? INACTIVE_STREAM_ERROR : e.what();
+  } catch (std::exception &e) {
+    error = e.what();
+  } catch (...) {
+    error = "Unknown Error: Something happened while fetching the result";
+  }
+  {
+    std::lock_guard<std::mutex> guard(handoff->lock);
+    handoff->chunks = std::move(chunks);
+    handoff->is_exhausted = is_exhausted;
+    handoff->error = error;
+    handoff->fetch_ms = elapsedMs(start);
+    handoff->state = PrefetchHandoff::State::DONE;
+  }
+  handoff->done.notify_all();
+  if (!error.empty()) {
+    SetError(error);
+  }
+}
+
+// Once adopted the chunks were consumed by the synchronous fetch, which also
+// finished the fetch in progress
+void ChunkFetcher::OnOK() {
+  if (isAdopted()) {
+    return;
+  }
+  Napi::HandleScope scope(Env());
+  iterator->metrics.fetch_ms += handoff->fetch_ms;
+  iterator->metrics.chunks_fetched += handoff->chunks.size();
+  iterator->onChunksFetched(Env(), handoff->chunks, handoff->is_exhausted);
+}
+
+void ChunkFetcher::OnError(const Napi::Error &e) {
+  if (isAdopted()) {
+    return;
+  }
+  tagInterruptedError(e);
+  iterator->onFetchError(Env(), e);
+}
+
+ArrowBatchFetcher::ArrowBatchFetcher(
+    Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+    ResultIterator *iterator, std::shared_ptr<duckdb::QueryResult> result,
+    std::unique_ptr<duckdb::DataChunk> chunk, bool exhausted,
+    bool write_schema, Napi::Promise::Deferred &deferred)
+    : QueryWorker(env, std::move(pool)), iterator(iterator),
+      iterator_ref(Napi::Persistent(iterator->Value())),
+      result(std::move(result)), chunk(std::move(chunk)),
+      is_exhausted(exhausted), write_schema(write_schema),
+      deferred(deferred) {}
+
+void ArrowBatchFetcher::Execute() {
+  try {
+    if (!chunk && !is_exhausted) {
+      auto start = std::chrono::steady_clock::now();
+      chunk = result->Fetch();
+      fetch_ms = elapsedMs(start);
+      fetched = chunk && chunk->size() > 0;
+    }
+    if (!chunk || chunk->size() == 0) {
+      is_exhausted = true;
+      chunk.reset();
+    }
+    auto start = std::chrono::steady_clock::now();
+    data = duckdb::make_unique<std::vector<uint8_t>>();
+    ArrowIPCWriter writer(result->names, result->types);
+    if (write_schema) {
+      writer.WriteSchema(*data);
+    }
+    if (chunk) {
+      writer.WriteRecordBatch(*chunk, *data);
+      chunk_bytes = chunkByteSize(*chunk);
+    } else {
+      ArrowIPCWriter::WriteEndOfStream(*data);
+    }
+    encode_ms = elapsedMs(start);
+  } catch (const duckdb::InvalidInputException &e) {
+    SetError(isInactiveStreamError(e) ? INACTIVE_STREAM_ERROR : e.what());
+  } catch (std::exception &e) {
+    SetError(e.what());
+  } catch (...) {
+    SetError("Unknown Error: Something happened while fetching the result");
+  }
+}
+
+void ArrowBatchFetcher::OnOK() {
+  Napi::HandleScope scope(Env());
+  auto env = Env();
+  auto &metrics = iterator->metrics;
+  metrics.fetch_ms += fetch_ms;
+  metrics.conversion_ms += encode_ms;
+  if (fetched) {
+    metrics.chunks_fetched++;
+  }
+  if (chunk) {
+    metrics.rows_emitted += chunk->size();
+  }
+  metrics.bytes_emitted += data->size();
+  if (!chunk) {
+    iterator->arrow_end_sent = true;
+  }
+  iterator->onBatchFetched(env, is_exhausted, chunk_bytes);
+  if (data->empty()) {
+    deferred.Resolve(env.Null());
+    return;
+  }
+  auto bytes = data.release();
+  deferred.Resolve(Napi::Buffer<uint8_t>::New(
+      env, bytes->data(), bytes->size(),
+      [](Napi::Env, uint8_t *, std::vector<uint8_t> *bytes) { delete bytes; },
+      bytes));
+}
+
+void ArrowBatchFetcher::OnError(const Napi::Error &e) {
+  tagInterruptedError(e);
+  iterator->onFetchError(Env(), e);
+  deferred.Reject(e.Value());
+}
+// Size at which a text batch is handed to JS, large enough that moving
+// batches through a JS stream costs little next to encoding them
+const size_t TEXT_BATCH_SIZE = 1 << 20;
+
+TextBatchFetcher::TextBatchFetcher(
+    Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+    ResultIterator *iterator, std::shared_ptr<duckdb::QueryResult> result,
+    std::vector<std::unique_ptr<duckdb::DataChunk>> chunks, bool exhausted,
+    TextFormat format, bool write_header, std::string path,
+    Napi::Promise::Deferred &deferred)
+    : QueryWorker(env, std::move(pool)), iterator(iterator),
+      iterator_ref(Napi::Persistent(iterator->Value())),
+      result(std::move(result)), chunks(std::move(chunks)),
+      is_exhausted(exhausted), format(format), write_header(write_header),
+      path(std::move(path)), deferred(deferred) {}
+
+bool TextBatchFetcher::writeToFile(FILE *file) {
+  if (fwrite(data->data(), 1, data->size(), file) != data->size()) {
+    SetError("Could not write to " + path + ": " + strerror(errno));
+    return false;
+  }
+  bytes += data->size();
+  data->clear();
+  return true;
+}
+
+void TextBatchFetcher::Execute() {
+  try {
+    std::unique_ptr<FILE, decltype(&fclose)> file(nullptr, &fclose);
+    if (!path.empty()) {
+      file.reset(fopen(path.c_str(), "wb"));
+      if (!file) {
+        SetError("Could not open " + path + ": " + strerror(errno));
+        return;
+      }
+    }
+    data = duckdb::make_unique<std::string>();
+    TextWriter writer(result->names, result->types, format);
+    if (write_header) {
+      writer.WriteHeader(*data);
+    }
+    size_t next_chunk = 0;
+    while (true) {
+      std::unique_ptr<duckdb::DataChunk> chunk;
+      if (next_chunk < chunks.size()) {
+        chunk = std::move(chunks[next_chunk++]);
+      } else if (!is_exhausted && (file || data->size() < TEXT_BATCH_SIZE)) {
+        auto start = std::chrono::steady_clock::now();
+        chunk = result->Fetch();
+        fetch_ms += elapsedMs(start);
+        if (!chunk || chunk->size() == 0) {
+          is_exhausted = true;
+          break;
+        }
+        chunks_fetched++;
+      } else {
+        break;
+      }
+      auto start = std::chrono::steady_clock::now();
+      writer.WriteChunk(*chunk, *data);
+      encode_ms += elapsedMs(start);
+      rows += chunk->size();
+      chunk_bytes += chunkByteSize(*chunk);
+      if (file && !writeToFile(file.get())) {
+        return;
+      }
+    }
+    if (file) {
+      // an empty result still gets its header
+      if (!writeToFile(file.get())) {
+        return;
+      }
+      if (fclose(file.release()) != 0) {
+        SetError("Could not write to " + path + ": " + strerror(errno));
+      }
+    } else {
+      bytes = data->size();
+    }
+  } catch (const duckdb::InvalidInputException &e) {
+    SetError(isInactiveStreamError(e) ? INACTIVE_STREAM_ERROR : e.what());
+  } catch (std::exception &e) {
+    SetError(e.what());
+  } catch (...) {
+    SetError("Unknown Error: Something happened while fetching the result");
+  }
+}
+
+void TextBatchFetcher::OnOK() {
+  Napi::HandleScope scope(Env());
+  auto env = Env();
+  auto &metrics = iterator->metrics;
+  metrics.fetch_ms += fetch_ms;
+  metrics.chunks_fetched += chunks_fetched;
+  metrics.conversion_ms += encode_ms;
+  metrics.rows_emitted += rows;
+  metrics.bytes_emitted += bytes;
+  iterator->onBatchFetched(env, is_exhausted, chunk_bytes);
+  if (!path.empty() || data->empty()) {
+    deferred.Resolve(env.Null());
+    return;
+  }
+  auto text = data.release();
+  deferred.Resolve(Napi::Buffer<char>::New(
+      env, &(*text)[0], text->size(),
+      [](Napi::Env, char *, std::string *text) { delete text; }, text));
+}
+
+void TextBatchFetcher::OnError(const Napi::Error &e) {
+  tagInterruptedError(e);
+  iterator->onFetchError(Env(), e);
+  deferred.Reject(e.Value());
+}
+} // namespace NodeDuckDB
@@ -0,0 +1,111 @@
+#ifndef CHUNK_FETCHER_H
+#define CHUNK_FETCHER_H
+
+#include "duckdb.hpp"
+#include "query_thread_pool.h"
+#include "result_iterator.h"
+#include "text_writer.h"
+#include <memory>
+#include <napi.h>
+#include <string>
+#include <vector>
+
+namespace NodeDuckDB {
+// Pulls the next chunks of a result on a worker thread so that producing
+// them (running the query pipeline for streaming results) doesn't block the
+// event loop. The chunks go through the handoff, where a synchronous fetch
+// may take them over before OnOK runs.
+class ChunkFetcher : public QueryWorker {
+public:
+  ChunkFetcher(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+               ResultIterator *iterator,
+               std::shared_ptr<duckdb::QueryResult> result,
+               uint32_t chunk_count,
+               std::shared_ptr<PrefetchHandoff> handoff);
+  ~ChunkFetcher();
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+
+private:
+  ResultIterator *iterator;
+  // keeps the iterator from being garbage collected while fetching
+  Napi::ObjectReference iterator_ref;
+  std::shared_ptr<duckdb::QueryResult> result;
+  uint32_t chunk_count;
+  std::shared_ptr<PrefetchHandoff> handoff;
+  bool isAdopted();
+};
+
+// Encodes the next chunk of a result as an Arrow IPC record batch (preceded by
+// the schema on the first call) on a worker thread. The encoded bytes are
+// handed to JS as an external buffer without copying.
+class ArrowBatchFetcher : public QueryWorker {
+public:
+  ArrowBatchFetcher(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                    ResultIterator *iterator,
+                    std::shared_ptr<duckdb::QueryResult> result,
+                    std::unique_ptr<duckdb::DataChunk> chunk, bool exhausted,
+                    bool write_schema, Napi::Promise::Deferred &deferred);
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+
+private:
+  ResultIterator *iterator;
+  Napi::ObjectReference iterator_ref;
+  std::shared_ptr<duckdb::QueryResult> result;
+  // an already prefetched chunk, fetched from the result otherwise
+  std::unique_ptr<duckdb::DataChunk> chunk;
+  bool is_exhausted;
+  bool write_schema;
+  std::unique_ptr<std::vector<uint8_t>> data;
+  Napi::Promise::Deferred deferred;
+  // whether the chunk was fetched by this worker rather than prefetched
+  bool fetched = false;
+  // size of the encoded chunk as stored by DuckDB
+  uint64_t chunk_bytes = 0;
+  double fetch_ms = 0;
+  double encode_ms = 0;
+};
+
+// Encodes the next chunks of a result as CSV or NDJSON on a worker thread.
+// Without a path batches of about TEXT_BATCH_SIZE bytes are handed to JS as
+// external buffers, with a path all remaining chunks are written to the file
+// and nothing crosses to the JS thread.
+class TextBatchFetcher : public QueryWorker {
+public:
+  TextBatchFetcher(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                   ResultIterator *iterator,
+                   std::shared_ptr<duckdb::QueryResult> result,
+                   std::vector<std::unique_ptr<duckdb::DataChunk>> chunks,
+                   bool exhausted, TextFormat format, bool write_header,
+                   std::string path, Napi::Promise::Deferred &deferred);
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+
+private:
+  bool writeToFile(FILE *file);
+  ResultIterator *iterator;
+  Napi::ObjectReference iterator_ref;
+  std::shared_ptr<duckdb::QueryResult> result;
+  // already prefetched chunks, encoded before fetching more
+  std::vector<std::unique_ptr<duckdb::DataChunk>> chunks;
+  bool is_exhausted;
+  TextFormat format;
+  bool write_header;
+  std::string path;
+  std::unique_ptr<std::string> data;
+  Napi::Promise::Deferred deferred;
+  uint64_t chunks_fetched = 0;
+  uint64_t rows = 0;
+  uint64_t bytes = 0;
+  // size of the encoded chunks as stored by DuckDB
+  uint64_t chunk_bytes = 0;
+  double fetch_ms = 0;
+  double encode_ms = 0;
+};
+} // namespace NodeDuckDB
+
+#endif
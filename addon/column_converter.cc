@@ -0,0 +1,790 @@
+#include "column_converter.h"
+#include "duckdb.hpp"
+#include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/types/hugeint.hpp"
+#include <cmath>
+#include <deque>
+#include <string.h>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+namespace NodeDuckDB {
+typedef uint64_t idx_t;
+
+// Milliseconds of a timestamp in microseconds, rounded down so that pre-epoch
+// timestamps with a sub-millisecond part don't move forward in time
+static double MicrosToEpochMs(int64_t micros) {
+  return std::floor(micros / 1000.0);
+}
+
+static int64_t GetTime(int64_t timestamp) {
+  return (int64_t)(timestamp & 0xFFFFFFFFFFFFFFFF);
+}
+
+static Napi::Value ConvertHugeInt(Napi::Env env,
+                                  duckdb::hugeint_t huge_int) {
+  // hugeint_t represents a signed 128 bit integer in two's complement
+  // notation napi's BigInt is basically a regular signed integer (MSB) so we
+  // want to make sure we pass the absolute value of the huge int into napi
+  // plus the sign bit
+  int is_negative = huge_int.upper < 0;
+  duckdb::hugeint_t positive_huge_int =
+      is_negative ? huge_int * duckdb::hugeint_t(-1) : huge_int;
+  uint64_t arr[2]{positive_huge_int.lower, (uint64_t)positive_huge_int.upper};
+  return Napi::BigInt::New(env, is_negative, 2, &arr[0]);
+}
+
+void ColumnConverter::SetVector(duckdb::Vector &vector, idx_t count,
+                                shared_ptr<duckdb::DataChunk> chunk) {
+  this->vector = &vector;
+  this->chunk = std::move(chunk);
+  is_flat = vector.GetVectorType() == duckdb::VectorType::FLAT_VECTOR;
+  vector.Orrify(count, vdata);
+}
+
+Napi::Value ColumnConverter::Convert(Napi::Env env, idx_t row) {
+  auto idx = vdata.sel->get_index(row);
+  if (!vdata.validity.RowIsValid(idx)) {
+    return env.Null();
+  }
+  return ConvertValid(env, idx);
+}
+
+Napi::Value ColumnConverter::ConvertColumn(Napi::Env env, idx_t offset,
+                                           idx_t count) {
+  Napi::Array array = Napi::Array::New(env, count);
+  for (idx_t i = 0; i < count; i++) {
+    array.Set(i, Convert(env, offset + i));
+  }
+  return array;
+}
+
+Napi::Uint8Array ColumnConverter::GetValidity(Napi::Env env, idx_t offset,
+                                              idx_t count) {
+  auto validity = Napi::Uint8Array::New(env, (count + 7) / 8);
+  uint8_t *validity_data = validity.Data();
+  memset(validity_data, 0, validity.ByteLength());
+  for (idx_t i = 0; i < count; i++) {
+    if (vdata.validity.RowIsValid(vdata.sel->get_index(offset + i))) {
+      validity_data[i / 8] |= 1 << (i % 8);
+    }
+  }
+  return validity;
+}
+
+// Converter for types that have a typed array representation in columnar form
+template <class SRC, class DST = SRC>
+class TypedConverter : public ColumnConverter {
+public:
+  Napi::Value ConvertColumn(Napi::Env env, idx_t offset,
+                            idx_t count) override {
+    auto array = Napi::TypedArrayOf<DST>::New(env, count);
+    auto source = reinterpret_cast<const SRC *>(vdata.data);
+    DST *target = array.Data();
+    if (std::is_same<SRC, DST>::value && is_flat) {
+      memcpy(target, source + offset, count * sizeof(DST));
+      return array;
+    }
+    for (idx_t i = 0; i < count; i++) {
+      target[i] = static_cast<DST>(source[vdata.sel->get_index(offset + i)]);
+    }
+    return array;
+  }
+
+protected:
+  inline SRC GetData(idx_t idx) {
+    return reinterpret_cast<const SRC *>(vdata.data)[idx];
+  }
+};
+
+template <class T> class NumberConverter : public TypedConverter<T> {
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    return Napi::Number::New(env, this->GetData(idx));
+  }
+};
+
+class BooleanConverter : public TypedConverter<bool, uint8_t> {
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    return Napi::Boolean::New(env, GetData(idx));
+  }
+};
+
+class BigIntConverter : public TypedConverter<int64_t> {
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    return Napi::BigInt::New(env, GetData(idx));
+  }
+};
+
+class HugeIntConverter : public ColumnConverter {
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    return ConvertHugeInt(
+        env, reinterpret_cast<const duckdb::hugeint_t *>(vdata.data)[idx]);
+  }
+};
+
+class StringConverter : public ColumnConverter {
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    auto &str = reinterpret_cast<const duckdb::string_t *>(vdata.data)[idx];
+    return Napi::String::New(env, str.GetDataUnsafe(), str.GetSize());
+  }
+};
+
+// Key of the string interning maps, the bytes are owned by the map or by the
+// chunk being converted
+struct StringKey {
+  const char *data;
+  size_t size;
+  bool operator==(const StringKey &other) const {
+    return size == other.size && memcmp(data, other.data, size) == 0;
+  }
+};
+
+struct StringKeyHash {
+  size_t operator()(const StringKey &key) const {
+    return duckdb::Hash(key.data, key.size);
+  }
+};
+
+// Distinct values and bytes interned per column, further values of high
+// cardinality columns get new strings so that the dictionary stays bounded
+const size_t MAX_INTERNED_STRINGS = 1 << 16;
+const size_t MAX_INTERNED_BYTES = 16 << 20;
+
+// VARCHAR converter for columns that repeat a few values: each distinct value
+// is created once per result and reused for all its rows. N-API can't
+// reference strings, the interned ones are kept alive by a JS array.
+class InterningStringConverter : public ColumnConverter {
+public:
+  // Returns { dictionary, codes }: the distinct values of the rows and for
+  // each row the index of its value in the dictionary (0 for nulls)
+  Napi::Value ConvertColumn(Napi::Env env, idx_t offset,
+                            idx_t count) override {
+    unordered_map<StringKey, uint32_t, StringKeyHash> chunk_codes;
+    auto dictionary = Napi::Array::New(env);
+    auto codes = Napi::Uint32Array::New(env, count);
+    uint32_t *codes_data = codes.Data();
+    for (idx_t i = 0; i < count; i++) {
+      auto idx = vdata.sel->get_index(offset + i);
+      if (!vdata.validity.RowIsValid(idx)) {
+        codes_data[i] = 0;
+        continue;
+      }
+      auto key = GetKey(idx);
+      auto entry = chunk_codes.find(key);
+      if (entry == chunk_codes.end()) {
+        uint32_t code = dictionary.Length();
+        dictionary.Set(code, Intern(env, key));
+        entry = chunk_codes.emplace(key, code).first;
+      }
+      codes_data[i] = entry->second;
+    }
+    auto column = Napi::Object::New(env);
+    column.Set("length", Napi::Number::New(env, count));
+    column.Set("dictionary", dictionary);
+    column.Set("codes", codes);
+    return column;
+  }
+
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    return Intern(env, GetKey(idx));
+  }
+
+private:
+  inline StringKey GetKey(idx_t idx) {
+    auto &str = reinterpret_cast<const duckdb::string_t *>(vdata.data)[idx];
+    return StringKey{str.GetDataUnsafe(), str.GetSize()};
+  }
+
+  Napi::Value Intern(Napi::Env env, const StringKey &key) {
+    auto entry = ids.find(key);
+    if (entry != ids.end()) {
+      return strings.Value().Get(entry->second);
+    }
+    auto value = Napi::String::New(env, key.data, key.size);
+    if (ids.size() < MAX_INTERNED_STRINGS &&
+        interned_bytes + key.size <= MAX_INTERNED_BYTES) {
+      if (strings.IsEmpty()) {
+        strings = Napi::Persistent(Napi::Array::New(env));
+      }
+      uint32_t id = ids.size();
+      storage.emplace_back(key.data, key.size);
+      interned_bytes += key.size;
+      ids.emplace(StringKey{storage.back().data(), storage.back().size()}, id);
+      strings.Value().Set(id, value);
+    }
+    return value;
+  }
+
+  unordered_map<StringKey, uint32_t, StringKeyHash> ids;
+  // owns the bytes of the keys of `ids`, a deque never moves its elements
+  deque<string> storage;
+  size_t interned_bytes = 0;
+  // interned strings by id
+  Napi::Reference<Napi::Array> strings;
+};
+
+// BLOBs of at least this size are handed to JS as external buffers pointing
+// into the chunk, smaller ones are cheaper to copy than to track with a
+// finalizer
+const idx_t EXTERNAL_BLOB_MIN_SIZE = 256;
+
+class BlobConverter : public ColumnConverter {
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    auto &str = reinterpret_cast<const duckdb::string_t *>(vdata.data)[idx];
+    if (!chunk || str.GetSize() < EXTERNAL_BLOB_MIN_SIZE) {
+      return Napi::Buffer<char>::Copy(env, str.GetDataUnsafe(), str.GetSize());
+    }
+    // the buffer keeps the chunk holding its bytes alive
+    return Napi::Buffer<char>::New(
+        env, const_cast<char *>(str.GetDataUnsafe()), str.GetSize(),
+        [](Napi::Env, char *, shared_ptr<duckdb::DataChunk> *chunk) {
+          delete chunk;
+        },
+        new shared_ptr<duckdb::DataChunk>(chunk));
+  }
+};
+
+const double MS_PER_DAY = 24 * 60 * 60 * 1000;
+
+// Temporal types read from their integer storage, returned as a Float64Array
+// of epoch milliseconds (microseconds since midnight for TIME) in columnar form
+template <class T> class TemporalConverter : public ColumnConverter {
+public:
+  explicit TemporalConverter(TemporalFormat format) : format(format) {}
+  Napi::Value ConvertColumn(Napi::Env env, idx_t offset,
+                            idx_t count) override {
+    auto array = Napi::Float64Array::New(env, count);
+    auto source = reinterpret_cast<const T *>(vdata.data);
+    double *target = array.Data();
+    for (idx_t i = 0; i < count; i++) {
+      target[i] = ToEpoch(source[vdata.sel->get_index(offset + i)]);
+    }
+    return array;
+  }
+
+protected:
+  virtual double ToEpoch(T value) = 0;
+  inline T GetData(idx_t idx) {
+    return reinterpret_cast<const T *>(vdata.data)[idx];
+  }
+  TemporalFormat format;
+};
+
+// DATE is stored as days since the epoch
+class DateConverter : public TemporalConverter<int32_t> {
+public:
+  explicit DateConverter(TemporalFormat format) : TemporalConverter(format) {}
+
+protected:
+  double ToEpoch(int32_t days) override { return days * MS_PER_DAY; }
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    auto days = GetData(idx);
+    switch (format) {
+    case TemporalFormat::DATE:
+      return Napi::Date::New(env, ToEpoch(days));
+    case TemporalFormat::EPOCH:
+      return Napi::Number::New(env, ToEpoch(days));
+    default:
+      return Napi::String::New(env,
+                               duckdb::Date::ToString(duckdb::date_t(days)));
+    }
+  }
+};
+
+// TIMESTAMP is stored as microseconds since the epoch
+class TimestampConverter : public TemporalConverter<int64_t> {
+public:
+  explicit TimestampConverter(TemporalFormat format)
+      : TemporalConverter(format) {}
+
+protected:
+  double ToEpoch(int64_t micros) override { return MicrosToEpochMs(micros); }
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    auto ms = ToEpoch(GetData(idx));
+    if (format == TemporalFormat::DATE) {
+      return Napi::Date::New(env, ms);
+    }
+    return Napi::Number::New(env, ms);
+  }
+};
+
+class TimeConverter : public TemporalConverter<int64_t> {
+public:
+  TimeConverter() : TemporalConverter(TemporalFormat::DEFAULT) {}
+
+protected:
+  double ToEpoch(int64_t tval) override { return GetTime(tval); }
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    return Napi::Number::New(env, ToEpoch(GetData(idx)));
+  }
+};
+
+static Napi::Value ConvertInterval(Napi::Env env,
+                                   const duckdb::interval_t &interval) {
+  auto object = Napi::Object::New(env);
+  object.Set("months", Napi::Number::New(env, interval.months));
+  object.Set("days", Napi::Number::New(env, interval.days));
+  object.Set("micros", Napi::Number::New(env, interval.micros));
+  return object;
+}
+
+class IntervalConverter : public ColumnConverter {
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    return ConvertInterval(
+        env, reinterpret_cast<const duckdb::interval_t *>(vdata.data)[idx]);
+  }
+};
+
+// Unscaled DECIMAL values, stored in the smallest integer type that fits the
+// decimal's width
+static double decimalToDouble(int64_t value) {
+  return static_cast<double>(value);
+}
+static double decimalToDouble(duckdb::hugeint_t value) {
+  return static_cast<double>(value.upper) * 18446744073709551616.0 +
+         static_cast<double>(value.lower);
+}
+static Napi::Value decimalToBigInt(Napi::Env env, int64_t value) {
+  return Napi::BigInt::New(env, value);
+}
+static Napi::Value decimalToBigInt(Napi::Env env, duckdb::hugeint_t value) {
+  return ConvertHugeInt(env, value);
+}
+static std::string decimalDigits(int64_t value) {
+  return std::to_string(value);
+}
+static std::string decimalDigits(duckdb::hugeint_t value) {
+  return duckdb::Hugeint::ToString(value);
+}
+
+// Inserts the decimal point into the digits of the unscaled value
+static std::string formatDecimal(std::string digits, uint8_t scale) {
+  bool is_negative = !digits.empty() && digits[0] == '-';
+  if (is_negative) {
+    digits.erase(0, 1);
+  }
+  if (scale > 0) {
+    if (digits.size() <= scale) {
+      digits.insert(0, scale - digits.size() + 1, '0');
+    }
+    digits.insert(digits.size() - scale, 1, '.');
+  }
+  return is_negative ? "-" + digits : digits;
+}
+
+template <class T> class DecimalConverter : public ColumnConverter {
+public:
+  DecimalConverter(DecimalFormat format, uint8_t scale)
+      : format(format), scale(scale), divisor(std::pow(10.0, scale)) {}
+  Napi::Value ConvertColumn(Napi::Env env, idx_t offset,
+                            idx_t count) override {
+    if (format == DecimalFormat::NUMBER) {
+      auto array = Napi::Float64Array::New(env, count);
+      double *target = array.Data();
+      for (idx_t i = 0; i < count; i++) {
+        target[i] = toDouble(GetData(vdata.sel->get_index(offset + i)));
+      }
+      return array;
+    }
+    if (format == DecimalFormat::BIGINT) {
+      return bigIntColumn(env, offset, count,
+                          std::is_same<T, duckdb::hugeint_t>());
+    }
+    return ColumnConverter::ConvertColumn(env, offset, count);
+  }
+
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    auto value = GetData(idx);
+    switch (format) {
+    case DecimalFormat::BIGINT:
+      return decimalToBigInt(env, value);
+    case DecimalFormat::STRING:
+      return Napi::String::New(env,
+                               formatDecimal(decimalDigits(value), scale));
+    default:
+      return Napi::Number::New(env, toDouble(value));
+    }
+  }
+
+private:
+  // unscaled values of up to 64 bits fit a BigInt64Array
+  Napi::Value bigIntColumn(Napi::Env env, idx_t offset, idx_t count,
+                           std::false_type) {
+    auto array = Napi::BigInt64Array::New(env, count);
+    int64_t *target = array.Data();
+    for (idx_t i = 0; i < count; i++) {
+      target[i] = GetData(vdata.sel->get_index(offset + i));
+    }
+    return array;
+  }
+  Napi::Value bigIntColumn(Napi::Env env, idx_t offset, idx_t count,
+                           std::true_type) {
+    return ColumnConverter::ConvertColumn(env, offset, count);
+  }
+  inline T GetData(idx_t idx) {
+    return reinterpret_cast<const T *>(vdata.data)[idx];
+  }
+  inline double toDouble(T value) { return decimalToDouble(value) / divisor; }
+  DecimalFormat format;
+  uint8_t scale;
+  double divisor;
+};
+
+// LIST cells are read from the list's child vector through the offset and
+// length of their entry, the elements converted by a converter of the child
+// type. The vector is flattened first so that its child vector can be
+// accessed directly.
+class ListConverter : public ColumnConverter {
+public:
+  ListConverter(const duckdb::LogicalType &type,
+                TemporalFormat temporal_format, DecimalFormat decimal_format)
+      : child_type(duckdb::ListType::GetChildType(type)),
+        temporal_format(temporal_format), decimal_format(decimal_format),
+        child(CreateColumnConverter(child_type, temporal_format,
+                                    decimal_format)) {}
+  void SetVector(duckdb::Vector &vector, idx_t count,
+                 shared_ptr<duckdb::DataChunk> chunk) override {
+    vector.Normalify(count);
+    ColumnConverter::SetVector(vector, count, chunk);
+    // the child vector is only set up once a list has elements
+    auto child_count = duckdb::ListVector::GetListSize(vector);
+    child_vector = nullptr;
+    if (child_count > 0) {
+      child_vector = &duckdb::ListVector::GetEntry(vector);
+      child->SetVector(*child_vector, child_count, std::move(chunk));
+    }
+  }
+  // Arrow style: the elements of all lists in one column (a typed array
+  // where the child type has one) and the offsets at which each list starts
+  // and the last one ends
+  Napi::Value ConvertColumn(Napi::Env env, idx_t offset,
+                            idx_t count) override {
+    auto offsets = Napi::Int32Array::New(env, count + 1);
+    int32_t *offset_data = offsets.Data();
+    offset_data[0] = 0;
+    auto entries = reinterpret_cast<const duckdb::list_entry_t *>(vdata.data);
+    idx_t element_count = 0;
+    idx_t first_element = 0;
+    // the lists of a chunk usually follow each other in the child vector
+    bool is_contiguous = true;
+    for (idx_t i = 0; i < count; i++) {
+      auto idx = vdata.sel->get_index(offset + i);
+      if (vdata.validity.RowIsValid(idx) && entries[idx].length > 0) {
+        if (element_count == 0) {
+          first_element = entries[idx].offset;
+        } else if (entries[idx].offset != first_element + element_count) {
+          is_contiguous = false;
+        }
+        element_count += entries[idx].length;
+      }
+      offset_data[i + 1] = static_cast<int32_t>(element_count);
+    }
+
+    Napi::Value values;
+    if (is_contiguous) {
+      // without elements nothing is read from the child vector
+      values = child->ConvertColumn(env, first_element, element_count);
+    } else {
+      duckdb::SelectionVector sel(element_count);
+      idx_t element_idx = 0;
+      for (idx_t i = 0; i < count; i++) {
+        auto idx = vdata.sel->get_index(offset + i);
+        if (!vdata.validity.RowIsValid(idx)) {
+          continue;
+        }
+        for (idx_t j = 0; j < entries[idx].length; j++) {
+          sel.set_index(element_idx++, entries[idx].offset + j);
+        }
+      }
+      duckdb::Vector elements(*child_vector, sel, element_count);
+      auto converter =
+          CreateColumnConverter(child_type, temporal_format, decimal_format);
+      converter->SetVector(elements, element_count, chunk);
+      values = converter->ConvertColumn(env, 0, element_count);
+    }
+
+    auto column = Napi::Object::New(env);
+    column.Set("length", Napi::Number::New(env, count));
+    column.Set("offsets", offsets);
+    column.Set("values", values);
+    return column;
+  }
+
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    auto &entry =
+        reinterpret_cast<const duckdb::list_entry_t *>(vdata.data)[idx];
+    auto array = Napi::Array::New(env, entry.length);
+    for (idx_t i = 0; i < entry.length; i++) {
+      array.Set(i, child->Convert(env, entry.offset + i));
+    }
+    return array;
+  }
+
+private:
+  duckdb::LogicalType child_type;
+  TemporalFormat temporal_format;
+  DecimalFormat decimal_format;
+  unique_ptr<ColumnConverter> child;
+  duckdb::Vector *child_vector = nullptr;
+};
+
+// STRUCT cells are converted field by field from the child vectors, which
+// share the row indexes of the flattened struct vector. The fields are
+// defined on each object in one call, with the names resolved once.
+class StructConverter : public ColumnConverter {
+public:
+  StructConverter(const duckdb::LogicalType &type,
+                  TemporalFormat temporal_format,
+                  DecimalFormat decimal_format) {
+    for (auto &child_type : duckdb::StructType::GetChildTypes(type)) {
+      names.push_back(child_type.first);
+      children.push_back(CreateColumnConverter(
+          child_type.second, temporal_format, decimal_format));
+    }
+    properties.resize(names.size());
+    for (auto &property : properties) {
+      property = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                  static_cast<napi_property_attributes>(
+                      napi_writable | napi_enumerable | napi_configurable),
+                  nullptr};
+    }
+  }
+  void SetVector(duckdb::Vector &vector, idx_t count,
+                 shared_ptr<duckdb::DataChunk> chunk) override {
+    vector.Normalify(count);
+    ColumnConverter::SetVector(vector, count, chunk);
+    auto &entries = duckdb::StructVector::GetEntries(vector);
+    for (idx_t i = 0; i < children.size(); i++) {
+      children[i]->SetVector(*entries[i].second, count, chunk);
+    }
+  }
+
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    resolveKeys(env);
+    for (idx_t i = 0; i < children.size(); i++) {
+      properties[i].value = children[i]->Convert(env, idx);
+    }
+    napi_value object;
+    napi_status status = napi_create_object(env, &object);
+    NAPI_THROW_IF_FAILED(env, status, Napi::Value());
+    status = napi_define_properties(env, object, properties.size(),
+                                    properties.data());
+    NAPI_THROW_IF_FAILED(env, status, Napi::Value());
+    return Napi::Value(env, object);
+  }
+
+private:
+  // The field names become JS strings once per converter rather than once
+  // per object, the handles are refreshed in the current handle scope
+  void resolveKeys(Napi::Env env) {
+    if (keys.empty()) {
+      for (auto &name : names) {
+        keys.push_back(Napi::Persistent(Napi::String::New(env, name)));
+      }
+    }
+    for (idx_t i = 0; i < keys.size(); i++) {
+      properties[i].name = keys[i].Value();
+    }
+  }
+
+  std::vector<std::string> names;
+  std::vector<unique_ptr<ColumnConverter>> children;
+  std::vector<Napi::Reference<Napi::String>> keys;
+  // names are set from `keys`, values for each object
+  std::vector<napi_property_descriptor> properties;
+};
+
+// Falls back to materializing a duckdb::Value per cell; the vector is
+// flattened first so that the storage index equals the row index
+class ValueConverter : public ColumnConverter {
+public:
+  void SetVector(duckdb::Vector &vector, idx_t count,
+                 shared_ptr<duckdb::DataChunk> chunk) override {
+    vector.Normalify(count);
+    ColumnConverter::SetVector(vector, count, std::move(chunk));
+  }
+
+protected:
+  Napi::Value ConvertValid(Napi::Env env, idx_t idx) override {
+    return ConvertValue(env, vector->GetValue(idx));
+  }
+};
+
+static unique_ptr<ColumnConverter>
+createDecimalConverter(const duckdb::LogicalType &type, DecimalFormat format) {
+  switch (type.InternalType()) {
+  case duckdb::PhysicalType::INT16:
+    return unique_ptr<ColumnConverter>(
+        new DecimalConverter<int16_t>(format, type.scale()));
+  case duckdb::PhysicalType::INT32:
+    return unique_ptr<ColumnConverter>(
+        new DecimalConverter<int32_t>(format, type.scale()));
+  case duckdb::PhysicalType::INT64:
+    return unique_ptr<ColumnConverter>(
+        new DecimalConverter<int64_t>(format, type.scale()));
+  case duckdb::PhysicalType::INT128:
+    return unique_ptr<ColumnConverter>(
+        new DecimalConverter<duckdb::hugeint_t>(format, type.scale()));
+  default:
+    throw runtime_error("unexpected storage type for decimal");
+  }
+}
+
+unique_ptr<ColumnConverter>
+CreateColumnConverter(const duckdb::LogicalType &type,
+                      TemporalFormat temporal_format,
+                      DecimalFormat decimal_format, bool intern_strings) {
+  switch (type.id()) {
+  case duckdb::LogicalTypeId::BOOLEAN:
+    return unique_ptr<ColumnConverter>(new BooleanConverter());
+  case duckdb::LogicalTypeId::TINYINT:
+    return unique_ptr<ColumnConverter>(new NumberConverter<int8_t>());
+  case duckdb::LogicalTypeId::SMALLINT:
+    return unique_ptr<ColumnConverter>(new NumberConverter<int16_t>());
+  case duckdb::LogicalTypeId::INTEGER:
+    return unique_ptr<ColumnConverter>(new NumberConverter<int32_t>());
+  case duckdb::LogicalTypeId::BIGINT:
+    return unique_ptr<ColumnConverter>(new BigIntConverter());
+  case duckdb::LogicalTypeId::HUGEINT:
+    return unique_ptr<ColumnConverter>(new HugeIntConverter());
+  case duckdb::LogicalTypeId::UTINYINT:
+    return unique_ptr<ColumnConverter>(new NumberConverter<uint8_t>());
+  case duckdb::LogicalTypeId::USMALLINT:
+    return unique_ptr<ColumnConverter>(new NumberConverter<uint16_t>());
+  case duckdb::LogicalTypeId::UINTEGER:
+    return unique_ptr<ColumnConverter>(new NumberConverter<uint32_t>());
+  case duckdb::LogicalTypeId::FLOAT:
+    return unique_ptr<ColumnConverter>(new NumberConverter<float>());
+  case duckdb::LogicalTypeId::DOUBLE:
+    return unique_ptr<ColumnConverter>(new NumberConverter<double>());
+  case duckdb::LogicalTypeId::VARCHAR:
+    if (intern_strings) {
+      return unique_ptr<ColumnConverter>(new InterningStringConverter());
+    }
+    return unique_ptr<ColumnConverter>(new StringConverter());
+  case duckdb::LogicalTypeId::BLOB:
+    return unique_ptr<ColumnConverter>(new BlobConverter());
+  case duckdb::LogicalTypeId::TIMESTAMP:
+    if (type.InternalType() != duckdb::PhysicalType::INT64) {
+      throw runtime_error("expected int64 for timestamp");
+    }
+    return unique_ptr<ColumnConverter>(
+        new TimestampConverter(temporal_format));
+  case duckdb::LogicalTypeId::TIME:
+    if (type.InternalType() != duckdb::PhysicalType::INT64) {
+      throw runtime_error("expected int64 for time");
+    }
+    return unique_ptr<ColumnConverter>(new TimeConverter());
+  case duckdb::LogicalTypeId::DATE:
+    if (type.InternalType() != duckdb::PhysicalType::INT32) {
+      throw runtime_error("expected int32 for date");
+    }
+    return unique_ptr<ColumnConverter>(new DateConverter(temporal_format));
+  case duckdb::LogicalTypeId::INTERVAL:
+    return unique_ptr<ColumnConverter>(new IntervalConverter());
+  case duckdb::LogicalTypeId::DECIMAL:
+    return createDecimalConverter(type, decimal_format);
+  case duckdb::LogicalTypeId::LIST:
+    return unique_ptr<ColumnConverter>(
+        new ListConverter(type, temporal_format, decimal_format));
+  case duckdb::LogicalTypeId::STRUCT:
+    return unique_ptr<ColumnConverter>(
+        new StructConverter(type, temporal_format, decimal_format));
+  default:
+    return unique_ptr<ColumnConverter>(new ValueConverter());
+  }
+}
+
+Napi::Value ConvertValue(Napi::Env env, const duckdb::Value &value) {
+  if (value.is_null) {
+    return env.Null();
+  }
+
+  switch (value.type().id()) {
+  case duckdb::LogicalTypeId::BOOLEAN:
+    return Napi::Boolean::New(env, value.GetValue<bool>());
+  case duckdb::LogicalTypeId::TINYINT:
+    return Napi::Number::New(env, value.GetValue<int8_t>());
+  case duckdb::LogicalTypeId::SMALLINT:
+    return Napi::Number::New(env, value.GetValue<int16_t>());
+  case duckdb::LogicalTypeId::INTEGER:
+    return Napi::Number::New(env, value.GetValue<int32_t>());
+  case duckdb::LogicalTypeId::BIGINT:
+    return Napi::BigInt::New(env, value.GetValue<int64_t>());
+  case duckdb::LogicalTypeId::HUGEINT:
+    return ConvertHugeInt(env, value.GetValue<duckdb::hugeint_t>());
+  case duckdb::LogicalTypeId::FLOAT:
+    return Napi::Number::New(env, value.GetValue<float>());
+  case duckdb::LogicalTypeId::DOUBLE:
+    return Napi::Number::New(env, value.GetValue<double>());
+  case duckdb::LogicalTypeId::DECIMAL:
+    return Napi::Number::New(
+        env, value.CastAs(duckdb::LogicalType::DOUBLE).GetValue<double>());
+  case duckdb::LogicalTypeId::VARCHAR:
+    return Napi::String::New(env, value.GetValue<string>());
+  case duckdb::LogicalTypeId::BLOB:
+    return Napi::Buffer<char>::Copy(env, value.str_value.c_str(),
+                                    value.str_value.length());
+  case duckdb::LogicalTypeId::TIMESTAMP: {
+    if (value.type().InternalType() != duckdb::PhysicalType::INT64) {
+      throw runtime_error("expected int64 for timestamp");
+    }
+    int64_t tval = value.GetValue<int64_t>();
+    return Napi::Number::New(env, MicrosToEpochMs(tval));
+  }
+  case duckdb::LogicalTypeId::TIME: {
+    if (value.type().InternalType() != duckdb::PhysicalType::INT64) {
+      throw runtime_error("expected int64 for time");
+    }
+    int64_t tval = value.GetValue<int64_t>();
+    return Napi::Number::New(env, GetTime(tval));
+  }
+  case duckdb::LogicalTypeId::INTERVAL:
+    return ConvertInterval(env, value.value_.interval);
+  case duckdb::LogicalTypeId::UTINYINT:
+    return Napi::Number::New(env, value.GetValue<uint8_t>());
+  case duckdb::LogicalTypeId::USMALLINT:
+    return Napi::Number::New(env, value.GetValue<uint16_t>());
+  case duckdb::LogicalTypeId::UINTEGER:
+    // GetValue is not supported for uint32_t, so using the wider type
+    return Napi::Number::New(env, value.GetValue<int64_t>());
+  case duckdb::LogicalTypeId::LIST: {
+    auto array = Napi::Array::New(env);
+    for (size_t i = 0; i < value.list_value.size(); i++) {
+      auto &element = value.list_value[i];
+      auto mapped_value = ConvertValue(env, element);
+      array.Set(i, mapped_value);
+    }
+    return array;
+  }
+  case duckdb::LogicalTypeId::STRUCT: {
+    auto object = Napi::Object::New(env);
+    auto &child_types = duckdb::StructType::GetChildTypes(value.type());
+    for (size_t i = 0; i < value.struct_value.size(); i++) {
+      auto &key = child_types[i].first;
+      auto &element = value.struct_value[i];
+      auto child_value = ConvertValue(env, element);
+      object.Set(key, child_value);
+    }
+    return object;
+  }
+  default:
+    // default to getting string representation
+    return Napi::String::New(env, value.ToString());
+  }
+}
+} // namespace NodeDuckDB
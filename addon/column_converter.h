@@ -0,0 +1,62 @@
+#ifndef COLUMN_CONVERTER_H
+#define COLUMN_CONVERTER_H
+
+#include "duckdb.hpp"
+#include <cstdint>
+#include <memory>
+#include <napi.h>
+
+namespace NodeDuckDB {
+// How DATE and TIMESTAMP cells are returned by row: DEFAULT keeps DATEs as
+// strings and TIMESTAMPs as epoch milliseconds, DATE returns both as JS Dates
+// and EPOCH both as epoch milliseconds. Columnar fetches always return epoch
+// milliseconds in a Float64Array.
+enum class TemporalFormat : uint8_t { DEFAULT = 0, DATE = 1, EPOCH = 2 };
+// How DECIMAL cells are returned: as the nearest double, as a BigInt of the
+// unscaled value (the decimal times 10^scale) or as an exact string
+enum class DecimalFormat : uint8_t { NUMBER = 0, BIGINT = 1, STRING = 2 };
+
+// Converts the cells of one result column straight from the vector's physical
+// storage into JS values. A converter is resolved once per result from the
+// column's logical type and pointed at each new chunk's vector with SetVector.
+class ColumnConverter {
+public:
+  virtual ~ColumnConverter() {}
+  // `chunk` owns the vector, converters may keep it alive to hand out its
+  // memory without copying
+  virtual void SetVector(duckdb::Vector &vector, duckdb::idx_t count,
+                         std::shared_ptr<duckdb::DataChunk> chunk = nullptr);
+  // Converts a single row of the current vector
+  virtual Napi::Value Convert(Napi::Env env, duckdb::idx_t row);
+  // Converts `count` rows starting at `offset` into a single column value
+  // (a typed array where there is one, a JS array otherwise)
+  virtual Napi::Value ConvertColumn(Napi::Env env, duckdb::idx_t offset,
+                                    duckdb::idx_t count);
+  // Validity bitmap: bit i (LSB first) is set when row offset + i is not null
+  Napi::Uint8Array GetValidity(Napi::Env env, duckdb::idx_t offset,
+                               duckdb::idx_t count);
+
+protected:
+  // Converts a non-null value at the (already resolved) storage index
+  virtual Napi::Value ConvertValid(Napi::Env env, duckdb::idx_t idx) = 0;
+  duckdb::Vector *vector = nullptr;
+  std::shared_ptr<duckdb::DataChunk> chunk;
+  duckdb::VectorData vdata;
+  bool is_flat = false;
+};
+
+// With `intern_strings` a VARCHAR column hands out the same JS string for
+// equal values throughout the result and is returned as
+// { dictionary, codes } in columnar form. Strings nested in LIST and STRUCT
+// values are not interned.
+std::unique_ptr<ColumnConverter>
+CreateColumnConverter(const duckdb::LogicalType &type,
+                      TemporalFormat temporal_format = TemporalFormat::DEFAULT,
+                      DecimalFormat decimal_format = DecimalFormat::NUMBER,
+                      bool intern_strings = false);
+
+// Slow path for types without a dedicated converter
+Napi::Value ConvertValue(Napi::Env env, const duckdb::Value &value);
+} // namespace NodeDuckDB
+
+#endif
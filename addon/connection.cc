@@ -1,11 +1,14 @@
 #include "connection.h"
+#include "addon_data.h"
 #include "async_executor.h"
 #include "duckdb.h"
 #include "duckdb.hpp"
 #include "duckdb/main/client_context.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
 #include "parquet-extension.hpp"
+#include "prepared_statement.h"
 #include "result_iterator.h"
+#include "scalar_function.h"
 #include "type-converters.h"
 #include <iostream>
 #include <memory>
@@ -13,18 +16,20 @@
 using namespace std;
 
 namespace NodeDuckDB {
-Napi::FunctionReference Connection::constructor;
-
 Napi::Object Connection::Init(Napi::Env env, Napi::Object exports) {
 
   Napi::Function func =
       DefineClass(env, "Connection",
                   {InstanceMethod("execute", &Connection::Execute),
+                   InstanceMethod("executeBatch", &Connection::ExecuteBatch),
+                   InstanceMethod("prepare", &Connection::Prepare),
+                   InstanceMethod("registerFunction",
+                                  &Connection::RegisterFunction),
+                   InstanceMethod("interrupt", &Connection::Interrupt),
                    InstanceMethod("close", &Connection::Close),
                    InstanceAccessor<&Connection::IsClosed>("isClosed")});
 
-  constructor = Napi::Persistent(func);
-  constructor.SuppressDestruct();
+  AddonData::Get(env)->connection_constructor = Napi::Persistent(func);
 
   exports.Set("Connection", func);
   return exports;
@@ -35,13 +40,18 @@ Connection::Connection(const Napi::CallbackInfo &info)
   Napi::Env env = info.Env();
 
   if (!info[0].IsObject() ||
-      !info[0].ToObject().InstanceOf(DuckDB::constructor.Value())) {
+      !info[0].ToObject().InstanceOf(
+          AddonData::Get(env)->duckdb_constructor.Value())) {
     throw Napi::TypeError::New(env, "Must provide a valid DuckDB object");
   }
 
   bool read_only = false;
   string database_name = "";
-  results = std::make_shared<std::vector<ResultIterator *>>();
+  results = std::make_shared<ResultRegistry>();
+  interrupt_count = std::make_shared<std::atomic<uint32_t>>(0);
+  cancellations = std::make_shared<QueryCancellations>();
+  strand = std::make_shared<QueryStrand>();
+  temp_objects = std::make_shared<std::atomic<bool>>(false);
 
   duckdb::DBConfig config;
   if (read_only)
@@ -52,6 +62,63 @@ Connection::Connection(const Napi::CallbackInfo &info)
     throw Napi::TypeError::New(env, "Database is closed");
   }
   connection = duckdb::make_shared<duckdb::Connection>(*unwrappedDb->database);
+  unwrappedDb->ConfigureConnection(env, *connection);
+  pool = unwrappedDb->pool;
+  result_cache = unwrappedDb->result_cache;
+}
+
+void parseExecuteOptions(const Napi::Env &env, const Napi::Object &options,
+                         bool &forceMaterialized,
+                         ResultOptions &resultOptions) {
+  if (!options.Get("forceMaterialized").IsUndefined()) {
+    forceMaterialized =
+        TypeConverters::convertBoolean(env, options, "forceMaterialized");
+  }
+
+  if (!options.Get("rowResultFormat").IsUndefined()) {
+    resultOptions.rowResultFormat = static_cast<ResultFormat>(
+        TypeConverters::convertEnum(env, options, "rowResultFormat",
+                                    static_cast<int>(ResultFormat::OBJECT),
+                                    static_cast<int>(ResultFormat::ARRAY)));
+  }
+
+  if (!options.Get("prefetchChunkCount").IsUndefined()) {
+    auto prefetchChunkCount =
+        TypeConverters::convertNumber(env, options, "prefetchChunkCount");
+    if (prefetchChunkCount < 1) {
+      throw Napi::TypeError::New(
+          env, "Invalid prefetchChunkCount: must be a positive number");
+    }
+    resultOptions.prefetchChunkCount = prefetchChunkCount;
+  }
+
+  if (!options.Get("profile").IsUndefined()) {
+    resultOptions.profile =
+        TypeConverters::convertBoolean(env, options, "profile");
+  }
+
+  if (!options.Get("cache").IsUndefined()) {
+    resultOptions.cache = TypeConverters::convertBoolean(env, options, "cache");
+  }
+
+  if (!options.Get("temporalFormat").IsUndefined()) {
+    resultOptions.temporalFormat = static_cast<TemporalFormat>(
+        TypeConverters::convertEnum(env, options, "temporalFormat",
+                                    static_cast<int>(TemporalFormat::DEFAULT),
+                                    static_cast<int>(TemporalFormat::EPOCH)));
+  }
+
+  if (!options.Get("decimalFormat").IsUndefined()) {
+    resultOptions.decimalFormat = static_cast<DecimalFormat>(
+        TypeConverters::convertEnum(env, options, "decimalFormat",
+                                    static_cast<int>(DecimalFormat::NUMBER),
+                                    static_cast<int>(DecimalFormat::STRING)));
+  }
+
+  if (!options.Get("internStrings").IsUndefined()) {
+    resultOptions.internStrings =
+        TypeConverters::convertBoolean(env, options, "internStrings");
+  }
 }
 
 Napi::Value Connection::Execute(const Napi::CallbackInfo &info) {
@@ -66,31 +133,107 @@ Napi::Value Connection::Execute(const Napi::CallbackInfo &info) {
       throw Napi::TypeError::New(env, "Second argument is an optional object");
     }
 
+    if (!info[2].IsUndefined() && !info[2].IsNumber()) {
+      throw Napi::TypeError::New(env, "Third argument is an optional number");
+    }
+
     if (this->connection == nullptr) {
       throw Napi::TypeError::New(env, "Connection is closed");
     }
 
     auto query = info[0].ToString().Utf8Value();
     auto forceMaterializedValue = false;
-    ResultFormat rowResultFormatValue = ResultFormat::OBJECT;
+    ResultOptions resultOptions;
     if (!info[1].IsUndefined()) {
-      auto options = info[1].ToObject();
-      if (!options.Get("forceMaterialized").IsUndefined()) {
-        forceMaterializedValue =
-            TypeConverters::convertBoolean(env, options, "forceMaterialized");
+      parseExecuteOptions(env, info[1].ToObject(), forceMaterializedValue,
+                          resultOptions);
+    }
+
+    AsyncExecutor *wk = new AsyncExecutor(
+        env, pool, query, connection, deferred, forceMaterializedValue,
+        resultOptions, results, interrupt_count);
+    wk->result_cache = result_cache;
+    wk->temp_objects = temp_objects;
+    wk->cancellations = cancellations;
+    if (!info[2].IsUndefined()) {
+      wk->request_id = info[2].ToNumber().Uint32Value();
+    }
+    cancellations->Queue(wk->request_id);
+    wk->SetStrand(strand);
+    wk->Queue();
+  } catch (Napi::Error &e) {
+    deferred.Reject(e.Value());
+  } catch (...) {
+    deferred.Reject(
+        Napi::Error::New(
+            env,
+            "Unknown Error: Something happened when preparing to run the query")
+            .Value());
+  }
+
+  return deferred.Promise();
+}
+
+// Takes a script of semicolon separated statements or an array of them
+Napi::Value Connection::ExecuteBatch(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  try {
+    std::vector<std::string> queries;
+    if (info[0].IsString()) {
+      queries.push_back(info[0].ToString().Utf8Value());
+    } else if (info[0].IsArray()) {
+      auto statements = info[0].As<Napi::Array>();
+      for (uint32_t i = 0; i < statements.Length(); i++) {
+        Napi::Value statement = statements.Get(i);
+        if (!statement.IsString()) {
+          throw Napi::TypeError::New(
+              env, "First argument must be a string or an array of strings");
+        }
+        queries.push_back(statement.ToString().Utf8Value());
       }
+    } else {
+      throw Napi::TypeError::New(
+          env, "First argument must be a string or an array of strings");
+    }
+
+    if (!info[1].IsUndefined() && !info[1].IsObject()) {
+      throw Napi::TypeError::New(env, "Second argument is an optional object");
+    }
+
+    if (!info[2].IsUndefined() && !info[2].IsNumber()) {
+      throw Napi::TypeError::New(env, "Third argument is an optional number");
+    }
 
-      if (!options.Get("rowResultFormat").IsUndefined()) {
-        rowResultFormatValue = static_cast<ResultFormat>(
-            TypeConverters::convertEnum(env, options, "rowResultFormat",
-                                        static_cast<int>(ResultFormat::OBJECT),
-                                        static_cast<int>(ResultFormat::ARRAY)));
+    if (this->connection == nullptr) {
+      throw Napi::TypeError::New(env, "Connection is closed");
+    }
+
+    // the result of the last statement is always materialized
+    auto forceMaterializedValue = true;
+    auto transaction = false;
+    ResultOptions resultOptions;
+    if (!info[1].IsUndefined()) {
+      auto options = info[1].ToObject();
+      parseExecuteOptions(env, options, forceMaterializedValue,
+                          resultOptions);
+      if (!options.Get("transaction").IsUndefined()) {
+        transaction =
+            TypeConverters::convertBoolean(env, options, "transaction");
       }
     }
 
-    AsyncExecutor *wk = new AsyncExecutor(env, query, connection, deferred,
-                                          forceMaterializedValue,
-                                          rowResultFormatValue, results);
+    auto wk = new BatchExecutor(env, pool, std::move(queries), connection,
+                                deferred, transaction, resultOptions, results,
+                                interrupt_count);
+    wk->result_cache = result_cache;
+    wk->temp_objects = temp_objects;
+    wk->cancellations = cancellations;
+    if (!info[2].IsUndefined()) {
+      wk->request_id = info[2].ToNumber().Uint32Value();
+    }
+    cancellations->Queue(wk->request_id);
+    wk->SetStrand(strand);
     wk->Queue();
   } catch (Napi::Error &e) {
     deferred.Reject(e.Value());
@@ -98,20 +241,117 @@ Napi::Value Connection::Execute(const Napi::CallbackInfo &info) {
     deferred.Reject(
         Napi::Error::New(
             env,
-            "Unknown Error: Something happened when preparing to run the query")
+            "Unknown Error: Something happened when preparing to run the batch")
+            .Value());
+  }
+
+  return deferred.Promise();
+}
+
+Napi::Value Connection::Prepare(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  try {
+    if (!info[0].IsString()) {
+      throw Napi::TypeError::New(env, "First argument must be a string");
+    }
+
+    if (this->connection == nullptr) {
+      throw Napi::TypeError::New(env, "Connection is closed");
+    }
+
+    auto query = info[0].ToString().Utf8Value();
+    AsyncPreparer *wk = new AsyncPreparer(env, pool, query, connection,
+                                          deferred, results, interrupt_count);
+    wk->result_cache = result_cache;
+    wk->temp_objects = temp_objects;
+    wk->cancellations = cancellations;
+    wk->SetStrand(strand);
+    wk->Queue();
+  } catch (Napi::Error &e) {
+    deferred.Reject(e.Value());
+  } catch (...) {
+    deferred.Reject(
+        Napi::Error::New(env, "Unknown Error: Something happened when "
+                              "preparing the statement")
+            .Value());
+  }
+
+  return deferred.Promise();
+}
+
+// Takes the function name, the argument type names, the return type name and
+// the JS function
+Napi::Value Connection::RegisterFunction(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  try {
+    if (!info[0].IsString()) {
+      throw Napi::TypeError::New(env, "First argument must be a string");
+    }
+    if (!info[1].IsArray()) {
+      throw Napi::TypeError::New(env,
+                                 "Second argument must be an array of types");
+    }
+    if (!info[3].IsFunction()) {
+      throw Napi::TypeError::New(env, "Fourth argument must be a function");
+    }
+    if (this->connection == nullptr) {
+      throw Napi::TypeError::New(env, "Connection is closed");
+    }
+
+    auto argument_type_names = info[1].As<Napi::Array>();
+    std::vector<duckdb::LogicalType> argument_types;
+    for (uint32_t i = 0; i < argument_type_names.Length(); i++) {
+      argument_types.push_back(
+          parseLogicalType(env, argument_type_names.Get(i)));
+    }
+    auto return_type = parseLogicalType(env, info[2]);
+    // before the function is registered, so that any query that can call it
+    // is known to, see ResultIterator::calls_js
+    AddonData::Get(env)->js_functions.insert(
+        ResultCache::FunctionKey(info[0].ToString().Utf8Value()));
+    auto function = std::make_shared<JSScalarFunction>(
+        env, info[3].As<Napi::Function>(), info[0].ToString().Utf8Value(),
+        std::move(argument_types), std::move(return_type));
+    auto wk = new FunctionRegistrar(env, pool, connection, std::move(function),
+                                    deferred);
+    wk->result_cache = result_cache;
+    wk->SetStrand(strand);
+    wk->Queue();
+  } catch (Napi::Error &e) {
+    deferred.Reject(e.Value());
+  } catch (...) {
+    deferred.Reject(
+        Napi::Error::New(env, "Unknown Error: Something happened when "
+                              "registering the function")
             .Value());
   }
 
   return deferred.Promise();
 }
 
+// Cancels the running query and the ones queued on this connection so far,
+// or only the query of the given request id. Interrupted queries reject with
+// an error whose code is ERR_DUCKDB_INTERRUPTED.
+Napi::Value Connection::Interrupt(const Napi::CallbackInfo &info) {
+  if (!connection) {
+    return info.Env().Undefined();
+  }
+  if (info[0].IsNumber()) {
+    cancellations->Cancel(info[0].ToNumber().Uint32Value(),
+                          *connection->context);
+  } else {
+    interrupt_count->fetch_add(1);
+    connection->context->Interrupt();
+  }
+  return info.Env().Undefined();
+}
+
+// Also closes the results of the connection that are still open, which frees
+// their native memory right away rather than once they are garbage collected
 Napi::Value Connection::Close(const Napi::CallbackInfo &info) {
-  // the following gives segfaults for some reason now
-  // for (auto &result : *results) {
-  //   if (result != nullptr) {
-  //     result->close();
-  //   }
-  // }
+  results->CloseAll();
   if (connection) {
     connection.reset();
   }
@@ -2,25 +2,45 @@
 #define connection_H
 
 #include "duckdb.hpp"
+#include "query_cancellations.h"
+#include "query_thread_pool.h"
+#include "result_cache.h"
 #include "result_iterator.h"
+#include <atomic>
 #include <napi.h>
 #include <vector>
 
 namespace NodeDuckDB {
+// Reads the options object shared by connection.execute and
+// preparedStatement.execute
+void parseExecuteOptions(const Napi::Env &env, const Napi::Object &options,
+                         bool &forceMaterialized, ResultOptions &resultOptions);
+
 class Connection : public Napi::ObjectWrap<Connection> {
 public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
   Connection(const Napi::CallbackInfo &info);
+  duckdb::shared_ptr<duckdb::Connection> connection;
+  std::shared_ptr<QueryThreadPool> pool;
+  std::shared_ptr<ResultCache> result_cache;
+  // runs the work on the connection one query at a time
+  std::shared_ptr<QueryStrand> strand;
 
 private:
-  static Napi::FunctionReference constructor;
   Napi::Value Execute(const Napi::CallbackInfo &info);
+  Napi::Value ExecuteBatch(const Napi::CallbackInfo &info);
+  Napi::Value Prepare(const Napi::CallbackInfo &info);
+  Napi::Value RegisterFunction(const Napi::CallbackInfo &info);
+  Napi::Value Interrupt(const Napi::CallbackInfo &info);
   Napi::Value Close(const Napi::CallbackInfo &info);
   Napi::Value IsClosed(const Napi::CallbackInfo &info);
 
   duckdb::shared_ptr<duckdb::DuckDB> database;
-  duckdb::shared_ptr<duckdb::Connection> connection;
-  std::shared_ptr<std::vector<ResultIterator *>> results;
+  std::shared_ptr<ResultRegistry> results;
+  std::shared_ptr<std::atomic<uint32_t>> interrupt_count;
+  std::shared_ptr<QueryCancellations> cancellations;
+  // set once a temporary object was created on the connection
+  std::shared_ptr<std::atomic<bool>> temp_objects;
 };
 } // namespace NodeDuckDB
 #endif
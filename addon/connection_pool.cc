@@ -0,0 +1,237 @@
+#include "connection_pool.h"
+#include "addon_data.h"
+#include "async_executor.h"
+#include "connection.h"
+#include "duckdb.h"
+#include "duckdb.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "result_iterator.h"
+#include "type-converters.h"
+#include <algorithm>
+#include <napi.h>
+
+namespace NodeDuckDB {
+Napi::Object ConnectionPool::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "ConnectionPool",
+      {InstanceMethod("execute", &ConnectionPool::Execute),
+       InstanceMethod("interrupt", &ConnectionPool::Interrupt),
+       InstanceMethod("close", &ConnectionPool::Close),
+       InstanceAccessor<&ConnectionPool::IsClosed>("isClosed"),
+       InstanceAccessor<&ConnectionPool::GetSize>("size"),
+       InstanceAccessor<&ConnectionPool::GetIdleCount>("idleCount"),
+       InstanceAccessor<&ConnectionPool::GetWaitingCount>("waitingCount")});
+
+  AddonData::Get(env)->connection_pool_constructor = Napi::Persistent(func);
+
+  exports.Set("ConnectionPool", func);
+  return exports;
+}
+
+ConnectionPool::ConnectionPool(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<ConnectionPool>(info) {
+  Napi::Env env = info.Env();
+
+  if (!info[0].IsObject() ||
+      !info[0].ToObject().InstanceOf(
+          AddonData::Get(env)->duckdb_constructor.Value())) {
+    throw Napi::TypeError::New(env, "Must provide a valid DuckDB object");
+  }
+
+  if (!info[1].IsUndefined() && !info[1].IsObject()) {
+    throw Napi::TypeError::New(env, "Second argument is an optional object");
+  }
+
+  auto unwrappedDb = DuckDB::Unwrap(info[0].ToObject());
+  if (unwrappedDb->IsClosed()) {
+    throw Napi::TypeError::New(env, "Database is closed");
+  }
+
+  // more connections than query threads would only queue on the threads
+  int32_t size = unwrappedDb->pool->ThreadCount();
+  if (size == 0) {
+    // queries run on the libuv threadpool, which has 4 threads by default
+    size = DEFAULT_QUERY_THREAD_POOL_SIZE;
+  }
+  if (!info[1].IsUndefined()) {
+    auto options = info[1].ToObject();
+    if (!options.Get("size").IsUndefined()) {
+      size = TypeConverters::convertNumber(env, options, "size");
+      if (size < 1) {
+        throw Napi::TypeError::New(env,
+                                   "Invalid size: must be a positive number");
+      }
+    }
+  }
+
+  state = std::make_shared<ConnectionPoolState>();
+  state->pool = unwrappedDb->pool;
+  state->result_cache = unwrappedDb->result_cache;
+  for (int32_t i = 0; i < size; i++) {
+    PooledConnection pooled;
+    pooled.connection =
+        duckdb::make_shared<duckdb::Connection>(*unwrappedDb->database);
+    unwrappedDb->ConfigureConnection(env, *pooled.connection);
+    pooled.results = std::make_shared<ResultRegistry>();
+    pooled.interrupt_count = std::make_shared<std::atomic<uint32_t>>(0);
+    pooled.temp_objects = std::make_shared<std::atomic<bool>>(false);
+    state->connections.push_back(std::move(pooled));
+    state->idle.push_back(i);
+  }
+}
+
+Napi::Value ConnectionPool::Execute(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  try {
+    if (!info[0].IsString()) {
+      throw Napi::TypeError::New(env, "First argument must be a string");
+    }
+
+    if (!info[1].IsUndefined() && !info[1].IsObject()) {
+      throw Napi::TypeError::New(env, "Second argument is an optional object");
+    }
+
+    if (!info[2].IsUndefined() && !info[2].IsNumber()) {
+      throw Napi::TypeError::New(env, "Third argument is an optional number");
+    }
+
+    if (state->closed) {
+      throw Napi::TypeError::New(env, "Connection pool is closed");
+    }
+
+    PoolRequest request{0, info[0].ToString().Utf8Value(), false,
+                        ResultOptions(), deferred};
+    if (!info[1].IsUndefined()) {
+      parseExecuteOptions(env, info[1].ToObject(), request.forceMaterialized,
+                          request.resultOptions);
+    }
+    if (!info[2].IsUndefined()) {
+      request.id = info[2].ToNumber().Uint32Value();
+    }
+    state->submit(env, request);
+  } catch (Napi::Error &e) {
+    deferred.Reject(e.Value());
+  } catch (...) {
+    deferred.Reject(
+        Napi::Error::New(
+            env,
+            "Unknown Error: Something happened when preparing to run the query")
+            .Value());
+  }
+
+  return deferred.Promise();
+}
+
+// Cancels the query with the given request id, whether it is waiting for a
+// connection or running
+Napi::Value ConnectionPool::Interrupt(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!info[0].IsNumber()) {
+    throw Napi::TypeError::New(env, "First argument must be a number");
+  }
+  state->interrupt(env, info[0].ToNumber().Uint32Value());
+  return env.Undefined();
+}
+
+Napi::Value ConnectionPool::Close(const Napi::CallbackInfo &info) {
+  state->close(info.Env());
+  return info.Env().Undefined();
+}
+
+Napi::Value ConnectionPool::IsClosed(const Napi::CallbackInfo &info) {
+  return Napi::Boolean::New(info.Env(), state->closed);
+}
+
+Napi::Value ConnectionPool::GetSize(const Napi::CallbackInfo &info) {
+  return Napi::Number::New(info.Env(), state->connections.size());
+}
+
+Napi::Value ConnectionPool::GetIdleCount(const Napi::CallbackInfo &info) {
+  return Napi::Number::New(info.Env(), state->idle.size());
+}
+
+Napi::Value ConnectionPool::GetWaitingCount(const Napi::CallbackInfo &info) {
+  return Napi::Number::New(info.Env(), state->waiting.size());
+}
+
+void ConnectionPoolState::submit(Napi::Env env, PoolRequest &request) {
+  if (idle.empty()) {
+    waiting.push_back(request);
+    return;
+  }
+  auto connection_idx = idle.back();
+  idle.pop_back();
+  dispatch(env, connection_idx, request);
+}
+
+void ConnectionPoolState::interrupt(Napi::Env env, uint32_t request_id) {
+  if (request_id == 0) {
+    return;
+  }
+  auto waiting_request =
+      std::find_if(waiting.begin(), waiting.end(),
+                   [request_id](const PoolRequest &request) {
+                     return request.id == request_id;
+                   });
+  if (waiting_request != waiting.end()) {
+    auto error = Napi::Error::New(env, INTERRUPTED_ERROR);
+    tagInterruptedError(error);
+    waiting_request->deferred.Reject(error.Value());
+    waiting.erase(waiting_request);
+    return;
+  }
+  for (auto &pooled : connections) {
+    if (pooled.request_id == request_id && pooled.connection) {
+      pooled.interrupt_count->fetch_add(1);
+      pooled.connection->context->Interrupt();
+    }
+  }
+}
+
+void ConnectionPoolState::close(Napi::Env env) {
+  closed = true;
+  while (!waiting.empty()) {
+    waiting.front().deferred.Reject(
+        Napi::Error::New(env, "Connection pool is closed").Value());
+    waiting.pop_front();
+  }
+  // busy connections are closed when they are released
+  for (auto connection_idx : idle) {
+    connections[connection_idx].connection.reset();
+  }
+  idle.clear();
+}
+
+void ConnectionPoolState::dispatch(Napi::Env env, size_t connection_idx,
+                                   PoolRequest &request) {
+  auto &pooled = connections[connection_idx];
+  pooled.request_id = request.id;
+  auto wk = new AsyncExecutor(env, pool, request.query, pooled.connection,
+                              request.deferred, request.forceMaterialized,
+                              request.resultOptions, pooled.results,
+                              pooled.interrupt_count);
+  wk->result_cache = result_cache;
+  wk->temp_objects = pooled.temp_objects;
+  auto self = shared_from_this();
+  wk->release = [self, env, connection_idx]() {
+    self->release(env, connection_idx);
+  };
+  wk->Queue();
+}
+
+void ConnectionPoolState::release(Napi::Env env, size_t connection_idx) {
+  connections[connection_idx].request_id = 0;
+  if (closed) {
+    connections[connection_idx].connection.reset();
+    return;
+  }
+  if (!waiting.empty()) {
+    auto request = waiting.front();
+    waiting.pop_front();
+    dispatch(env, connection_idx, request);
+    return;
+  }
+  idle.push_back(connection_idx);
+}
+} // namespace NodeDuckDB
@@ -0,0 +1,76 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include "duckdb.hpp"
+#include "query_thread_pool.h"
+#include "result_cache.h"
+#include "result_iterator.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <napi.h>
+#include <string>
+#include <vector>
+
+namespace NodeDuckDB {
+struct PooledConnection {
+  std::shared_ptr<duckdb::Connection> connection;
+  std::shared_ptr<ResultRegistry> results;
+  std::shared_ptr<std::atomic<uint32_t>> interrupt_count;
+  std::shared_ptr<std::atomic<bool>> temp_objects;
+  // the request the connection is serving, 0 while idle
+  uint32_t request_id = 0;
+};
+
+struct PoolRequest {
+  uint32_t id;
+  std::string query;
+  bool forceMaterialized;
+  ResultOptions resultOptions;
+  Napi::Promise::Deferred deferred;
+};
+
+// Shared by a ConnectionPool and the queries it dispatched, which hand their
+// connection back once the query failed, or its result was materialized,
+// exhausted or closed
+class ConnectionPoolState
+    : public std::enable_shared_from_this<ConnectionPoolState> {
+public:
+  void submit(Napi::Env env, PoolRequest &request);
+  void interrupt(Napi::Env env, uint32_t request_id);
+  void close(Napi::Env env);
+
+  std::vector<PooledConnection> connections;
+  std::vector<size_t> idle;
+  std::deque<PoolRequest> waiting;
+  std::shared_ptr<QueryThreadPool> pool;
+  std::shared_ptr<ResultCache> result_cache;
+  bool closed = false;
+
+private:
+  void dispatch(Napi::Env env, size_t connection_idx, PoolRequest &request);
+  void release(Napi::Env env, size_t connection_idx);
+};
+
+// Keeps a fixed number of connections to a database open and runs each query
+// on an idle one, queueing queries while all of them are busy. Unlike a
+// single Connection it can serve concurrent streaming results.
+class ConnectionPool : public Napi::ObjectWrap<ConnectionPool> {
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  ConnectionPool(const Napi::CallbackInfo &info);
+
+private:
+  Napi::Value Execute(const Napi::CallbackInfo &info);
+  Napi::Value Interrupt(const Napi::CallbackInfo &info);
+  Napi::Value Close(const Napi::CallbackInfo &info);
+  Napi::Value IsClosed(const Napi::CallbackInfo &info);
+  Napi::Value GetSize(const Napi::CallbackInfo &info);
+  Napi::Value GetIdleCount(const Napi::CallbackInfo &info);
+  Napi::Value GetWaitingCount(const Napi::CallbackInfo &info);
+
+  std::shared_ptr<ConnectionPoolState> state;
+};
+} // namespace NodeDuckDB
+
+#endif
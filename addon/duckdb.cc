@@ -1,25 +1,45 @@
 #include "duckdb.h"
+#include "addon_data.h"
 #include "async_executor.h"
 #include "connection.h"
 #include "duckdb.hpp"
 #include "duckdb/main/client_context.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
 #include "parquet-extension.hpp"
+#include "query_thread_pool.h"
 #include "result_iterator.h"
 #include "type-converters.h"
 #include <iostream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
 using namespace std;
 
 namespace NodeDuckDB {
 using namespace TypeConverters;
 
-Napi::FunctionReference DuckDB::constructor;
+// Databases exported by handle. The registry is shared by the environments of
+// all threads, but doesn't keep the databases open: once a database is closed
+// everywhere, attaching to it fails.
+struct ExportedDatabase {
+  std::weak_ptr<duckdb::DuckDB> database;
+  std::vector<std::string> connection_pragmas;
+  std::shared_ptr<ResultCache> result_cache;
+};
+static std::mutex exported_lock;
+static std::unordered_map<std::string, ExportedDatabase> exported_databases;
+static uint64_t last_handle_id = 0;
 
 Napi::Object DuckDB::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(
       env, "DuckDB",
       {
+          StaticMethod("open", &DuckDB::Open),
           InstanceMethod("close", &DuckDB::Close),
+          InstanceMethod("closeAsync", &DuckDB::CloseAsync),
+          InstanceMethod("checkpoint", &DuckDB::Checkpoint),
           InstanceAccessor<&DuckDB::IsClosed>("isClosed"),
           InstanceAccessor<&DuckDB::GetAccessMode>("accessMode"),
           InstanceAccessor<&DuckDB::GetCheckPointWALSize>("checkPointWALSize"),
@@ -32,53 +52,225 @@ Napi::Object DuckDB::Init(Napi::Env env, Napi::Object exports) {
           InstanceAccessor<&DuckDB::GetCollation>("collation"),
           InstanceAccessor<&DuckDB::GetDefaultOrderType>("defaultOrderType"),
           InstanceAccessor<&DuckDB::GetDefaultNullOrder>("defaultNullOrder"),
+          InstanceAccessor<&DuckDB::GetQueryThreadPoolSize>(
+              "queryThreadPoolSize"),
+          InstanceAccessor<&DuckDB::GetThreads>("threads"),
+          InstanceMethod("exportHandle", &DuckDB::ExportHandle),
+          InstanceAccessor<&DuckDB::GetResultCacheStats>("resultCacheStats"),
+          InstanceMethod("clearResultCache", &DuckDB::ClearResultCache),
       });
-  constructor = Napi::Persistent(func);
-  constructor.SuppressDestruct();
+  AddonData::Get(env)->duckdb_constructor = Napi::Persistent(func);
   exports.Set("DuckDB", func);
   return exports;
 }
 
-DuckDB::DuckDB(const Napi::CallbackInfo &info)
-    : Napi::ObjectWrap<DuckDB>(info) {
-  Napi::Env env = info.Env();
+void DatabaseSetup::Parse(Napi::Env env, Napi::Value value) {
+  if (value.IsUndefined()) {
+    return;
+  }
+  if (!value.IsObject()) {
+    throw Napi::TypeError::New(env, "Invalid argument: must be an object");
+  }
+  auto config = value.ToObject();
 
-  string path;
-  duckdb::DBConfig nativeConfig;
+  if (!config.Get("path").IsUndefined()) {
+    path = convertString(env, config, "path");
+  }
+
+  if (!config.Get("handle").IsUndefined()) {
+    attach_handle = convertString(env, config, "handle");
+    if (!path.empty()) {
+      throw Napi::TypeError::New(
+          env, "Invalid argument: path can't be combined with handle");
+    }
+  }
+
+  if (config.Get("options").IsUndefined()) {
+    return;
+  }
+  // the database options only apply when opening a database
+  if (attach_handle.empty()) {
+    setDBConfig(env, config, native_config);
+  }
 
-  if (!info[0].IsUndefined()) {
-    if (!info[0].IsObject()) {
-      throw Napi::TypeError::New(env, "Invalid argument: must be an object");
+  auto optionsObject = config.Get("options").ToObject();
+  if (!optionsObject.Get("queryThreadPoolSize").IsUndefined()) {
+    query_thread_pool_size =
+        convertNumber(env, optionsObject, "queryThreadPoolSize");
+    if (query_thread_pool_size < 0) {
+      throw Napi::TypeError::New(
+          env, "Invalid queryThreadPoolSize: must not be negative");
     }
-    auto config = info[0].ToObject();
+  }
 
-    if (!config.Get("path").IsUndefined()) {
-      path = convertString(env, config, "path");
+  // like the database options, the thread count is the database's, which an
+  // attached object shares with every other
+  if (attach_handle.empty() && !optionsObject.Get("threads").IsUndefined()) {
+    threads = convertNumber(env, optionsObject, "threads");
+    if (threads < 1) {
+      throw Napi::TypeError::New(env,
+                                 "Invalid threads: must be a positive number");
     }
+  }
 
-    if (!config.Get("options").IsUndefined()) {
-      setDBConfig(env, config, nativeConfig);
+  if (!optionsObject.Get("connectionPragmas").IsUndefined()) {
+    connection_pragmas =
+        convertPragmas(env, optionsObject, "connectionPragmas");
+    has_connection_pragmas = true;
+  }
+
+  if (!optionsObject.Get("resultCacheSize").IsUndefined()) {
+    result_cache_size = convertUInt64(env, optionsObject, "resultCacheSize");
+  }
+}
+
+void DatabaseSetup::Open() {
+  if (!attach_handle.empty()) {
+    std::lock_guard<std::mutex> guard(exported_lock);
+    auto exported = exported_databases.find(attach_handle);
+    if (exported != exported_databases.end()) {
+      database = exported->second.database.lock();
+      if (!has_connection_pragmas) {
+        connection_pragmas = exported->second.connection_pragmas;
+      }
+      // writes through either object have to invalidate the same cache
+      result_cache = exported->second.result_cache;
+    }
+    if (!database) {
+      throw std::runtime_error("Invalid handle: the database is closed or "
+                               "was never exported");
+    }
+  } else {
+    try {
+      database = duckdb::make_unique<duckdb::DuckDB>(path, &native_config);
+      database->LoadExtension<duckdb::ParquetExtension>();
+    } catch (std::exception &) {
+      throw;
+    } catch (...) {
+      throw std::runtime_error("An error occured during DuckDB initialisation");
+    }
+    if (result_cache_size > 0) {
+      result_cache = std::make_shared<ResultCache>(result_cache_size);
     }
   }
+  if (threads > 0) {
+    // applied before any connection is handed out so that the first query
+    // already runs in parallel
+    duckdb::Connection connection(*database);
+    auto result = connection.Query("PRAGMA threads=" + std::to_string(threads));
+    if (!result->success) {
+      throw std::runtime_error(result->error);
+    }
+  }
+}
+
+DuckDB::DuckDB(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<DuckDB>(info) {
+  Napi::Env env = info.Env();
+
+  // DuckDB.open hands over a database it opened on a query thread
+  if (info[0].IsExternal()) {
+    adopt(*info[0].As<Napi::External<DatabaseSetup>>().Data());
+    return;
+  }
+
+  DatabaseSetup setup;
+  setup.Parse(env, info[0]);
   try {
-    database = duckdb::make_unique<duckdb::DuckDB>(path, &nativeConfig);
-    database->LoadExtension<duckdb::ParquetExtension>();
-  } catch (duckdb::IOException e) {
-    throw Napi::Error::New(env, e.what());
-  } catch (std::exception e) {
+    setup.Open();
+  } catch (std::exception &e) {
     throw Napi::Error::New(env, e.what());
-  } catch (...) {
-    throw Napi::Error::New(env,
-                           "An error occured during DuckDB initialisation");
+  }
+  setup.pool =
+      std::make_shared<QueryThreadPool>(env, setup.query_thread_pool_size);
+  adopt(setup);
+}
+
+void DuckDB::adopt(DatabaseSetup &setup) {
+  database = std::move(setup.database);
+  pool = std::move(setup.pool);
+  connection_pragmas = std::move(setup.connection_pragmas);
+  result_cache = std::move(setup.result_cache);
+}
+
+// Parses the config on the JS thread, but opens the database, which may have to
+// replay a large write ahead log, on a query thread of its own pool
+Napi::Value DuckDB::Open(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  try {
+    auto setup = duckdb::make_unique<DatabaseSetup>();
+    setup->Parse(env, info[0]);
+    auto pool =
+        std::make_shared<QueryThreadPool>(env, setup->query_thread_pool_size);
+    setup->pool = pool;
+    auto wk = new DatabaseOpener(env, pool, std::move(setup), deferred);
+    wk->Queue();
+  } catch (Napi::Error &e) {
+    deferred.Reject(e.Value());
+  }
+  return deferred.Promise();
+}
+
+void DuckDB::ConfigureConnection(Napi::Env env,
+                                 duckdb::Connection &connection) {
+  for (auto &pragma : connection_pragmas) {
+    auto result = connection.Query(pragma);
+    if (!result->success) {
+      throw Napi::Error::New(env, result->error);
+    }
   }
 }
 
+// Other DuckDB objects attached to the database by handle, and connections,
+// keep it open until they are closed too
 Napi::Value DuckDB::Close(const Napi::CallbackInfo &info) {
   if (database) {
     database.reset();
   }
   return info.Env().Undefined();
 }
+
+// Like Close, but if this was the last reference to the database it is shut
+// down on a query thread, queued behind the work already waiting for one
+Napi::Value DuckDB::CloseAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  if (!database) {
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
+  }
+  // the task empties the holder on the query thread, so the database shuts
+  // down there even if the JS thread still holds the holder at that point
+  auto closing = std::make_shared<decltype(database)>(std::move(database));
+  auto wk = new DatabaseTask(
+      env, pool, [closing]() { closing->reset(); }, deferred);
+  wk->Queue();
+  return deferred.Promise();
+}
+
+// Writes the changes in the write ahead log to the database file
+Napi::Value DuckDB::Checkpoint(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  if (!database) {
+    deferred.Reject(Napi::Error::New(env, "Database is closed").Value());
+    return deferred.Promise();
+  }
+  auto checkpointed = database;
+  auto wk = new DatabaseTask(
+      env, pool,
+      [checkpointed]() {
+        duckdb::Connection connection(*checkpointed);
+        auto result = connection.Query("CHECKPOINT");
+        if (!result->success) {
+          throw std::runtime_error(result->error);
+        }
+      },
+      deferred);
+  wk->Queue();
+  return deferred.Promise();
+}
 Napi::Value DuckDB::IsClosed(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
   return Napi::Boolean::New(env, IsClosed());
@@ -126,4 +318,104 @@ Napi::Value DuckDB::GetDefaultNullOrder(const Napi::CallbackInfo &info) {
   return Napi::Number::New(
       env, static_cast<double>(database->instance->config.default_null_order));
 }
+Napi::Value DuckDB::GetThreads(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  return Napi::Number::New(env,
+                           database->instance->scheduler->NumberOfThreads());
+}
+// Registers the database so that DuckDB objects in other worker threads can
+// attach to it with the returned handle
+Napi::Value DuckDB::ExportHandle(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (IsClosed()) {
+    throw Napi::Error::New(env, "Database is closed");
+  }
+  std::lock_guard<std::mutex> guard(exported_lock);
+  if (handle.empty()) {
+    // forget the databases that have been closed since they were exported
+    for (auto it = exported_databases.begin();
+         it != exported_databases.end();) {
+      it = it->second.database.expired() ? exported_databases.erase(it)
+                                         : std::next(it);
+    }
+    handle = "node-duckdb:" + std::to_string(++last_handle_id);
+    exported_databases[handle] = {database, connection_pragmas,
+                                  result_cache};
+  }
+  return Napi::String::New(env, handle);
+}
+
+Napi::Value DuckDB::GetResultCacheStats(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!result_cache) {
+    return env.Null();
+  }
+  auto stats = result_cache->GetStats();
+  Napi::Object object = Napi::Object::New(env);
+  object.Set("hits", Napi::Number::New(env, stats.hits));
+  object.Set("misses", Napi::Number::New(env, stats.misses));
+  object.Set("evictions", Napi::Number::New(env, stats.evictions));
+  object.Set("invalidations", Napi::Number::New(env, stats.invalidations));
+  object.Set("entries", Napi::Number::New(env, stats.entries));
+  object.Set("bytes", Napi::Number::New(env, stats.bytes));
+  return object;
+}
+
+Napi::Value DuckDB::ClearResultCache(const Napi::CallbackInfo &info) {
+  if (result_cache) {
+    result_cache->Invalidate();
+  }
+  return info.Env().Undefined();
+}
+
+Napi::Value DuckDB::GetQueryThreadPoolSize(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  return Napi::Number::New(env, pool->ThreadCount());
+}
+
+DatabaseOpener::DatabaseOpener(Napi::Env &env,
+                               std::shared_ptr<QueryThreadPool> pool,
+                               std::unique_ptr<DatabaseSetup> setup,
+                               Napi::Promise::Deferred &deferred)
+    : QueryWorker(env, std::move(pool)), setup(std::move(setup)),
+      deferred(deferred) {}
+
+void DatabaseOpener::Execute() {
+  try {
+    setup->Open();
+  } catch (std::exception &e) {
+    SetError(e.what());
+  }
+}
+
+void DatabaseOpener::OnOK() {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+  auto db = AddonData::Get(env)->duckdb_constructor.New(
+      {Napi::External<DatabaseSetup>::New(env, setup.get())});
+  deferred.Resolve(db);
+}
+
+void DatabaseOpener::OnError(const Napi::Error &e) {
+  deferred.Reject(e.Value());
+}
+
+DatabaseTask::DatabaseTask(Napi::Env &env,
+                           std::shared_ptr<QueryThreadPool> pool,
+                           std::function<void()> task,
+                           Napi::Promise::Deferred &deferred)
+    : QueryWorker(env, std::move(pool)), task(std::move(task)),
+      deferred(deferred) {}
+
+void DatabaseTask::Execute() {
+  try {
+    task();
+  } catch (std::exception &e) {
+    SetError(e.what());
+  }
+}
+
+void DatabaseTask::OnOK() { deferred.Resolve(Env().Undefined()); }
+
+void DatabaseTask::OnError(const Napi::Error &e) { deferred.Reject(e.Value()); }
 } // namespace NodeDuckDB
@@ -2,19 +2,58 @@
 #define DUCKDB_H
 
 #include "duckdb.hpp"
+#include "query_thread_pool.h"
+#include "result_cache.h"
+#include <functional>
+#include <memory>
 #include <napi.h>
+#include <string>
+#include <vector>
 
 namespace NodeDuckDB {
+const int32_t DEFAULT_QUERY_THREAD_POOL_SIZE = 4;
+
+// The config of a DuckDB object, parsed on the JS thread, and what opening the
+// database with it results in. Open only throws std::exceptions and doesn't
+// touch JS values, so DuckDB.open can run it on a query thread.
+struct DatabaseSetup {
+  std::string path;
+  // attaches to an exported database instead of opening one
+  std::string attach_handle;
+  bool has_connection_pragmas = false;
+  duckdb::DBConfig native_config;
+  int32_t query_thread_pool_size = DEFAULT_QUERY_THREAD_POOL_SIZE;
+  int32_t threads = 0;
+  uint64_t result_cache_size = 0;
+  std::vector<std::string> connection_pragmas;
+  duckdb::shared_ptr<duckdb::DuckDB> database;
+  std::shared_ptr<ResultCache> result_cache;
+  std::shared_ptr<QueryThreadPool> pool;
+  void Parse(Napi::Env env, Napi::Value config);
+  void Open();
+};
+
 class DuckDB : public Napi::ObjectWrap<DuckDB> {
 public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
   DuckDB(const Napi::CallbackInfo &info);
   duckdb::shared_ptr<duckdb::DuckDB> database;
-  static Napi::FunctionReference constructor;
+  // runs the queries of all connections to this database, outlives close() as
+  // long as connections still use it
+  std::shared_ptr<QueryThreadPool> pool;
+  // set by the resultCacheSize option, shared with the DuckDB objects
+  // attached by handle as they see the same data
+  std::shared_ptr<ResultCache> result_cache;
   bool IsClosed(void);
+  // Applies the connectionPragmas option to a new connection
+  void ConfigureConnection(Napi::Env env, duckdb::Connection &connection);
 
 private:
+  static Napi::Value Open(const Napi::CallbackInfo &info);
+  void adopt(DatabaseSetup &setup);
   Napi::Value Close(const Napi::CallbackInfo &info);
+  Napi::Value CloseAsync(const Napi::CallbackInfo &info);
+  Napi::Value Checkpoint(const Napi::CallbackInfo &info);
   Napi::Value IsClosed(const Napi::CallbackInfo &info);
   Napi::Value GetAccessMode(const Napi::CallbackInfo &info);
   Napi::Value GetCheckPointWALSize(const Napi::CallbackInfo &info);
@@ -25,6 +64,42 @@ private:
   Napi::Value GetCollation(const Napi::CallbackInfo &info);
   Napi::Value GetDefaultOrderType(const Napi::CallbackInfo &info);
   Napi::Value GetDefaultNullOrder(const Napi::CallbackInfo &info);
+  Napi::Value GetQueryThreadPoolSize(const Napi::CallbackInfo &info);
+  Napi::Value GetThreads(const Napi::CallbackInfo &info);
+  Napi::Value ExportHandle(const Napi::CallbackInfo &info);
+  Napi::Value GetResultCacheStats(const Napi::CallbackInfo &info);
+  Napi::Value ClearResultCache(const Napi::CallbackInfo &info);
+  std::vector<std::string> connection_pragmas;
+  // set once the database is exported, see ExportHandle
+  std::string handle;
+};
+
+class DatabaseOpener : public QueryWorker {
+public:
+  DatabaseOpener(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                 std::unique_ptr<DatabaseSetup> setup,
+                 Napi::Promise::Deferred &deferred);
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+
+private:
+  std::unique_ptr<DatabaseSetup> setup;
+  Napi::Promise::Deferred deferred;
+};
+
+// Runs work on the database that doesn't produce a result, e.g. a checkpoint
+class DatabaseTask : public QueryWorker {
+public:
+  DatabaseTask(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+               std::function<void()> task, Napi::Promise::Deferred &deferred);
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+
+private:
+  std::function<void()> task;
+  Napi::Promise::Deferred deferred;
 };
 } // namespace NodeDuckDB
 
@@ -0,0 +1,150 @@
+#include "prepared_statement.h"
+#include "addon_data.h"
+#include "async_executor.h"
+#include "connection.h"
+#include "duckdb.hpp"
+#include "type-converters.h"
+#include <napi.h>
+
+namespace NodeDuckDB {
+Napi::Object PreparedStatement::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "PreparedStatement",
+      {InstanceMethod("execute", &PreparedStatement::Execute),
+       InstanceMethod("close", &PreparedStatement::Close),
+       InstanceAccessor<&PreparedStatement::IsClosed>("isClosed"),
+       InstanceAccessor<&PreparedStatement::GetParameterCount>(
+           "parameterCount")});
+
+  AddonData::Get(env)->prepared_statement_constructor = Napi::Persistent(func);
+
+  exports.Set("PreparedStatement", func);
+  return exports;
+}
+
+PreparedStatement::PreparedStatement(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<PreparedStatement>(info) {}
+
+Napi::Object PreparedStatement::Create(Napi::Env env) {
+  return AddonData::Get(env)->prepared_statement_constructor.New({});
+}
+
+Napi::Value PreparedStatement::Execute(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  try {
+    if (!info[0].IsUndefined() && !info[0].IsArray()) {
+      throw Napi::TypeError::New(env, "First argument is an optional array");
+    }
+
+    if (!info[1].IsUndefined() && !info[1].IsObject()) {
+      throw Napi::TypeError::New(env, "Second argument is an optional object");
+    }
+
+    if (!info[2].IsUndefined() && !info[2].IsNumber()) {
+      throw Napi::TypeError::New(env, "Third argument is an optional number");
+    }
+
+    if (statement == nullptr) {
+      throw Napi::TypeError::New(env, "Prepared statement is closed");
+    }
+
+    auto parameters = TypeConverters::convertParameters(env, info[0]);
+    if (parameters.size() != statement->n_param) {
+      throw Napi::TypeError::New(
+          env, "Expected " + std::to_string(statement->n_param) +
+                   " parameters, got " + std::to_string(parameters.size()));
+    }
+
+    auto forceMaterializedValue = false;
+    ResultOptions resultOptions;
+    if (!info[1].IsUndefined()) {
+      parseExecuteOptions(env, info[1].ToObject(), forceMaterializedValue,
+                          resultOptions);
+    }
+
+    AsyncExecutor *wk = new AsyncExecutor(
+        env, pool, statement, parameters, connection, deferred,
+        forceMaterializedValue, resultOptions, results, interrupt_count);
+    wk->result_cache = result_cache;
+    wk->temp_objects = temp_objects;
+    wk->cancellations = cancellations;
+    if (!info[2].IsUndefined()) {
+      wk->request_id = info[2].ToNumber().Uint32Value();
+    }
+    cancellations->Queue(wk->request_id);
+    wk->SetStrand(strand);
+    wk->Queue();
+  } catch (Napi::Error &e) {
+    deferred.Reject(e.Value());
+  } catch (...) {
+    deferred.Reject(
+        Napi::Error::New(env, "Unknown Error: Something happened when "
+                              "preparing to run the statement")
+            .Value());
+  }
+
+  return deferred.Promise();
+}
+
+Napi::Value PreparedStatement::Close(const Napi::CallbackInfo &info) {
+  statement.reset();
+  connection.reset();
+  return info.Env().Undefined();
+}
+
+Napi::Value PreparedStatement::IsClosed(const Napi::CallbackInfo &info) {
+  return Napi::Boolean::New(info.Env(), statement == nullptr);
+}
+
+Napi::Value
+PreparedStatement::GetParameterCount(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (statement == nullptr) {
+    return env.Undefined();
+  }
+  return Napi::Number::New(env, statement->n_param);
+}
+
+AsyncPreparer::AsyncPreparer(
+    Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+    std::string &query, std::shared_ptr<duckdb::Connection> &connection,
+    Napi::Promise::Deferred &deferred,
+    std::shared_ptr<ResultRegistry> results,
+    std::shared_ptr<std::atomic<uint32_t>> interrupt_count)
+    : QueryWorker(env, std::move(pool)), query(query), connection(connection),
+      results(std::move(results)), interrupt_count(std::move(interrupt_count)),
+      deferred(deferred) {}
+
+void AsyncPreparer::Execute() {
+  try {
+    statement = connection->Prepare(query);
+    if (!statement->success) {
+      SetError(statement->error);
+    }
+  } catch (...) {
+    SetError("Unknown Error: Something happened during preparation of the "
+             "statement");
+  }
+}
+
+void AsyncPreparer::OnOK() {
+  Napi::HandleScope scope(Env());
+  Napi::Object prepared_statement = PreparedStatement::Create(Env());
+  PreparedStatement *unwrapped = PreparedStatement::Unwrap(prepared_statement);
+  unwrapped->statement = std::move(statement);
+  unwrapped->connection = connection;
+  unwrapped->pool = Pool();
+  unwrapped->results = results;
+  unwrapped->interrupt_count = interrupt_count;
+  unwrapped->cancellations = cancellations;
+  unwrapped->strand = Strand();
+  unwrapped->result_cache = result_cache;
+  unwrapped->temp_objects = temp_objects;
+  deferred.Resolve(prepared_statement);
+}
+
+void AsyncPreparer::OnError(const Napi::Error &e) {
+  deferred.Reject(e.Value());
+}
+} // namespace NodeDuckDB
@@ -0,0 +1,66 @@
+#ifndef PREPARED_STATEMENT_H
+#define PREPARED_STATEMENT_H
+
+#include "duckdb.hpp"
+#include "query_cancellations.h"
+#include "query_thread_pool.h"
+#include "result_cache.h"
+#include "result_iterator.h"
+#include <atomic>
+#include <memory>
+#include <napi.h>
+#include <string>
+#include <vector>
+
+namespace NodeDuckDB {
+// Wraps a statement that was parsed, bound and planned once so that it can be
+// executed many times with different parameters
+class PreparedStatement : public Napi::ObjectWrap<PreparedStatement> {
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  PreparedStatement(const Napi::CallbackInfo &info);
+  static Napi::Object Create(Napi::Env env);
+  std::shared_ptr<duckdb::PreparedStatement> statement;
+  std::shared_ptr<duckdb::Connection> connection;
+  std::shared_ptr<QueryThreadPool> pool;
+  std::shared_ptr<ResultRegistry> results;
+  std::shared_ptr<std::atomic<uint32_t>> interrupt_count;
+  std::shared_ptr<QueryCancellations> cancellations;
+  std::shared_ptr<QueryStrand> strand;
+  std::shared_ptr<ResultCache> result_cache;
+  std::shared_ptr<std::atomic<bool>> temp_objects;
+
+private:
+  Napi::Value Execute(const Napi::CallbackInfo &info);
+  Napi::Value Close(const Napi::CallbackInfo &info);
+  Napi::Value IsClosed(const Napi::CallbackInfo &info);
+  Napi::Value GetParameterCount(const Napi::CallbackInfo &info);
+};
+
+class AsyncPreparer : public QueryWorker {
+public:
+  AsyncPreparer(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                std::string &query,
+                std::shared_ptr<duckdb::Connection> &connection,
+                Napi::Promise::Deferred &deferred,
+                std::shared_ptr<ResultRegistry> results,
+                std::shared_ptr<std::atomic<uint32_t>> interrupt_count);
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+  // handed to the prepared statement
+  std::shared_ptr<ResultCache> result_cache;
+  std::shared_ptr<std::atomic<bool>> temp_objects;
+  std::shared_ptr<QueryCancellations> cancellations;
+
+private:
+  std::string query;
+  std::shared_ptr<duckdb::Connection> connection;
+  std::unique_ptr<duckdb::PreparedStatement> statement;
+  std::shared_ptr<ResultRegistry> results;
+  std::shared_ptr<std::atomic<uint32_t>> interrupt_count;
+  Napi::Promise::Deferred deferred;
+};
+} // namespace NodeDuckDB
+
+#endif
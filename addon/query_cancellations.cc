@@ -0,0 +1,59 @@
+#include "query_cancellations.h"
+#include "duckdb/main/client_context.hpp"
+
+namespace NodeDuckDB {
+void QueryCancellations::Queue(uint32_t request_id) {
+  if (request_id == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  queued.insert(request_id);
+}
+
+// Queries that already finished aren't tracked, so cancelling them is a no-op
+void QueryCancellations::Cancel(uint32_t request_id,
+                                duckdb::ClientContext &context) {
+  if (request_id == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  if (running == request_id) {
+    cancelled.insert(request_id);
+    context.Interrupt();
+  } else if (queued.count(request_id) > 0) {
+    cancelled.insert(request_id);
+  }
+}
+
+bool QueryCancellations::Start(uint32_t request_id) {
+  if (request_id == 0) {
+    return true;
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  queued.erase(request_id);
+  if (cancelled.erase(request_id) > 0) {
+    return false;
+  }
+  running = request_id;
+  return true;
+}
+
+bool QueryCancellations::IsCancelled(uint32_t request_id) {
+  if (request_id == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  return cancelled.count(request_id) > 0;
+}
+
+void QueryCancellations::Finish(uint32_t request_id) {
+  if (request_id == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  cancelled.erase(request_id);
+  if (running == request_id) {
+    running = 0;
+  }
+}
+} // namespace NodeDuckDB
@@ -0,0 +1,38 @@
+#ifndef QUERY_CANCELLATIONS_H
+#define QUERY_CANCELLATIONS_H
+
+#include "duckdb.hpp"
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+
+namespace NodeDuckDB {
+// Queries of a connection cancelled one at a time by their timeoutMs or
+// signal, identified by the request id JS passes along with them. Unlike
+// connection.interrupt() a cancellation only stops its own query: a queued
+// one is skipped once it gets to run, and the client context is only
+// interrupted while the query is the one using the connection. A streaming
+// query uses it until its result is exhausted or closed, or until the next
+// query starts. Request id 0 is never cancelled. Shared by the connection and
+// its query threads.
+class QueryCancellations {
+public:
+  // called on the JS thread as the query is queued
+  void Queue(uint32_t request_id);
+  // called on the JS thread
+  void Cancel(uint32_t request_id, duckdb::ClientContext &context);
+  // called on a query thread before the query runs, false if it was
+  // cancelled while queued
+  bool Start(uint32_t request_id);
+  bool IsCancelled(uint32_t request_id);
+  void Finish(uint32_t request_id);
+
+private:
+  std::mutex lock;
+  std::unordered_set<uint32_t> queued;
+  std::unordered_set<uint32_t> cancelled;
+  uint32_t running = 0;
+};
+} // namespace NodeDuckDB
+
+#endif
@@ -0,0 +1,213 @@
+#include "query_thread_pool.h"
+#include <exception>
+#include <napi.h>
+
+namespace NodeDuckDB {
+double elapsedMs(const std::chrono::steady_clock::time_point &since) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+QueryWorker::QueryWorker(Napi::Env env, std::shared_ptr<QueryThreadPool> pool)
+    : env(env), pool(std::move(pool)) {}
+
+QueryWorker::~QueryWorker() {}
+
+void QueryWorker::Queue() {
+  queued_at = std::chrono::steady_clock::now();
+  pool->schedule(this);
+}
+
+double QueryWorker::QueueWaitMs() const {
+  return std::chrono::duration<double, std::milli>(started_at - queued_at)
+      .count();
+}
+
+double QueryWorker::ExecuteMs() const {
+  return std::chrono::duration<double, std::milli>(finished_at - started_at)
+      .count();
+}
+
+void QueryWorker::SetError(const std::string &message) {
+  failed = true;
+  error = message;
+}
+
+void QueryWorker::OnComplete() {
+  Napi::HandleScope scope(env);
+  try {
+    if (failed) {
+      OnError(Napi::Error::New(env, error));
+    } else {
+      OnOK();
+    }
+  } catch (const Napi::Error &e) {
+    // same as an exception thrown from an AsyncWorker callback
+    e.ThrowAsJavaScriptException();
+  }
+}
+
+QueryThreadPool::QueryThreadPool(Napi::Env env, size_t thread_count) {
+  completions = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo &) {}),
+      "node-duckdb-query", 0, 1);
+  // an idle pool doesn't keep the process alive
+  completions.Unref(env);
+  for (size_t i = 0; i < thread_count; i++) {
+    threads.emplace_back(&QueryThreadPool::run, this);
+  }
+}
+
+// Queued workers hold a reference to the pool, so by the time it is destroyed
+// the queue is empty and the threads are idle
+QueryThreadPool::~QueryThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  work_available.notify_all();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  completions.Release();
+}
+
+void QueryThreadPool::schedule(QueryWorker *worker) {
+  if (pending++ == 0) {
+    completions.Ref(worker->Env());
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (worker->strand) {
+      if (worker->strand->busy) {
+        worker->strand->waiting.push_back(worker);
+        return;
+      }
+      worker->strand->busy = true;
+    }
+    if (!threads.empty()) {
+      queue.push_back(worker);
+    }
+  }
+  if (threads.empty()) {
+    queueOnLibuv(worker->Env(), worker);
+    return;
+  }
+  work_available.notify_one();
+}
+
+QueryWorker *QueryThreadPool::finishOnStrand(QueryWorker *worker) {
+  QueryWorker *next;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    auto &strand = *worker->strand;
+    if (strand.waiting.empty()) {
+      strand.busy = false;
+      return nullptr;
+    }
+    next = strand.waiting.front();
+    strand.waiting.pop_front();
+    if (threads.empty()) {
+      return next;
+    }
+    queue.push_back(next);
+  }
+  work_available.notify_one();
+  return nullptr;
+}
+
+void QueryThreadPool::execute(QueryWorker *worker) {
+  worker->started_at = std::chrono::steady_clock::now();
+  try {
+    worker->Execute();
+  } catch (std::exception &e) {
+    worker->SetError(e.what());
+  } catch (...) {
+    worker->SetError("Unknown Error: Something happened on a query thread");
+  }
+  worker->finished_at = std::chrono::steady_clock::now();
+}
+
+void QueryThreadPool::run() {
+  while (true) {
+    QueryWorker *worker;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      work_available.wait(guard, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      worker = queue.front();
+      queue.pop_front();
+    }
+    execute(worker);
+    if (worker->strand) {
+      finishOnStrand(worker);
+    }
+    completions.NonBlockingCall(
+        worker, [this](Napi::Env env, Napi::Function, QueryWorker *worker) {
+          onWorkerComplete(env, worker);
+        });
+  }
+}
+
+void QueryThreadPool::queueOnLibuv(Napi::Env env, QueryWorker *worker) {
+  napi_status status = napi_create_async_work(
+      env, nullptr, Napi::String::New(env, "node-duckdb-query"),
+      &QueryThreadPool::executeOnLibuv, &QueryThreadPool::completeOnLibuv,
+      worker, &worker->async_work);
+  NAPI_THROW_IF_FAILED_VOID(env, status);
+  status = napi_queue_async_work(env, worker->async_work);
+  NAPI_THROW_IF_FAILED_VOID(env, status);
+}
+
+void QueryThreadPool::executeOnLibuv(napi_env, void *data) {
+  auto worker = static_cast<QueryWorker *>(data);
+  worker->pool->execute(worker);
+}
+
+// The next worker of the strand is queued from here rather than from the
+// libuv thread, async work can only be queued on the JS thread
+void QueryThreadPool::completeOnLibuv(napi_env env, napi_status,
+                                      void *data) {
+  auto worker = static_cast<QueryWorker *>(data);
+  auto pool = worker->pool.get();
+  napi_delete_async_work(env, worker->async_work);
+  worker->async_work = nullptr;
+  auto next = worker->strand ? pool->finishOnStrand(worker) : nullptr;
+  if (next) {
+    try {
+      pool->queueOnLibuv(env, next);
+    } catch (const Napi::Error &e) {
+      e.ThrowAsJavaScriptException();
+    }
+  }
+  pool->onWorkerComplete(env, worker);
+}
+
+void QueryThreadPool::defer(Napi::Env env, std::function<void()> callback) {
+  if (pending++ == 0) {
+    completions.Ref(env);
+  }
+  completions.NonBlockingCall(
+      new std::function<void()>(std::move(callback)),
+      [this](Napi::Env env, Napi::Function, std::function<void()> *callback) {
+        std::unique_ptr<std::function<void()>> owned(callback);
+        if (--pending == 0) {
+          completions.Unref(env);
+        }
+        // may release the last reference to the pool as it is destroyed
+        (*owned)();
+      });
+}
+
+void QueryThreadPool::onWorkerComplete(Napi::Env env, QueryWorker *worker) {
+  if (--pending == 0) {
+    completions.Unref(env);
+  }
+  worker->OnComplete();
+  // may release the last reference to the pool, nothing can follow this
+  delete worker;
+}
+} // namespace NodeDuckDB
@@ -0,0 +1,117 @@
+#ifndef QUERY_THREAD_POOL_H
+#define QUERY_THREAD_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <napi.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NodeDuckDB {
+class QueryThreadPool;
+class QueryWorker;
+
+// Work on one connection, run one worker at a time in the order it was
+// queued. A query only starts once the previous work on its connection is
+// done rather than waiting for the connection inside DuckDB, so what runs on
+// the connection is known and nothing runs within a batch's transaction but
+// the batch. Guarded by the lock of the pool it is used with.
+class QueryStrand {
+private:
+  friend class QueryThreadPool;
+  std::deque<QueryWorker *> waiting;
+  bool busy = false;
+};
+
+// Milliseconds passed since the given time point
+double elapsedMs(const std::chrono::steady_clock::time_point &since);
+
+// Work that runs on a QueryThreadPool thread. Mirrors Napi::AsyncWorker:
+// Execute runs off the JS thread and reports failure through SetError, then
+// OnOK or OnError runs on the JS thread and the worker is deleted.
+class QueryWorker {
+public:
+  virtual ~QueryWorker();
+  void Queue();
+  Napi::Env Env() const { return env; }
+  // runs the worker after the work queued before it on the same strand
+  void SetStrand(std::shared_ptr<QueryStrand> worker_strand) {
+    strand = std::move(worker_strand);
+  }
+
+protected:
+  QueryWorker(Napi::Env env, std::shared_ptr<QueryThreadPool> pool);
+  virtual void Execute() = 0;
+  virtual void OnOK() = 0;
+  virtual void OnError(const Napi::Error &e) = 0;
+  void SetError(const std::string &message);
+  const std::shared_ptr<QueryThreadPool> &Pool() const { return pool; }
+  const std::shared_ptr<QueryStrand> &Strand() const { return strand; }
+  // time between Queue and Execute starting on a pool thread
+  double QueueWaitMs() const;
+  double ExecuteMs() const;
+
+private:
+  friend class QueryThreadPool;
+  void OnComplete();
+  Napi::Env env;
+  std::shared_ptr<QueryThreadPool> pool;
+  std::shared_ptr<QueryStrand> strand;
+  std::string error;
+  bool failed = false;
+  std::chrono::steady_clock::time_point queued_at;
+  std::chrono::steady_clock::time_point started_at;
+  std::chrono::steady_clock::time_point finished_at;
+  // set while the worker runs on the libuv threadpool
+  napi_async_work async_work = nullptr;
+};
+
+// Threads dedicated to running queries and fetching results, so that long
+// queries don't occupy the libuv threadpool that fs, dns and zlib rely on.
+// Completions are sent back to the JS thread through a single
+// ThreadSafeFunction, which only keeps the event loop alive while work is
+// pending. Without threads the workers run on the libuv threadpool instead,
+// to compare against. Owned by the DuckDB object and shared with its
+// connections and queued workers.
+class QueryThreadPool {
+public:
+  QueryThreadPool(Napi::Env env, size_t thread_count);
+  ~QueryThreadPool();
+  size_t ThreadCount() const { return threads.size(); }
+  // Runs the callback on the JS thread after the current callback returns,
+  // for work that can't start where it is triggered, like in a finalizer
+  void defer(Napi::Env env, std::function<void()> callback);
+
+private:
+  friend class QueryWorker;
+  // called on the JS thread
+  void schedule(QueryWorker *worker);
+  void run();
+  // runs a worker's Execute and times it, on a pool or libuv thread
+  void execute(QueryWorker *worker);
+  // Called once a worker's Execute is done. Queues the next worker of its
+  // strand on the threads, or returns it to queue on the libuv threadpool.
+  QueryWorker *finishOnStrand(QueryWorker *worker);
+  // called on the JS thread when there are no threads
+  void queueOnLibuv(Napi::Env env, QueryWorker *worker);
+  static void executeOnLibuv(napi_env env, void *data);
+  static void completeOnLibuv(napi_env env, napi_status status, void *data);
+  void onWorkerComplete(Napi::Env env, QueryWorker *worker);
+
+  std::vector<std::thread> threads;
+  std::mutex lock;
+  std::condition_variable work_available;
+  std::deque<QueryWorker *> queue;
+  bool stopping = false;
+  Napi::ThreadSafeFunction completions;
+  // workers queued but not yet completed, only touched on the JS thread
+  size_t pending = 0;
+};
+} // namespace NodeDuckDB
+
+#endif
@@ -0,0 +1,217 @@
+#include "result_cache.h"
+#include "duckdb/parser/statement/create_statement.hpp"
+#include "result_iterator.h"
+#include <cctype>
+
+namespace NodeDuckDB {
+typedef uint64_t idx_t;
+
+// Collapses whitespace outside of quotes and drops trailing semicolons, so
+// that formatting differences don't lead to separate entries
+std::string ResultCache::Key(const std::string &query) {
+  std::string key;
+  key.reserve(query.size());
+  char quote = 0;
+  bool pending_space = false;
+  for (char c : query) {
+    if (quote == 0 && std::isspace(static_cast<unsigned char>(c))) {
+      pending_space = !key.empty();
+      continue;
+    }
+    if (pending_space) {
+      key += ' ';
+      pending_space = false;
+    }
+    if (quote == 0 && (c == '\'' || c == '"')) {
+      quote = c;
+    } else if (c == quote) {
+      quote = 0;
+    }
+    key += c;
+  }
+  while (!key.empty() && (key.back() == ';' || key.back() == ' ')) {
+    key.pop_back();
+  }
+  return key;
+}
+
+std::string ResultCache::Key(const std::string &query,
+                             const std::vector<duckdb::Value> &parameters) {
+  auto key = Key(query);
+  for (auto &parameter : parameters) {
+    // the type tells 1 and '1' apart
+    key += '\0';
+    key += parameter.type().ToString();
+    key += '\0';
+    key += parameter.is_null ? "NULL" : parameter.ToString();
+  }
+  return key;
+}
+
+std::shared_ptr<CachedResult> ResultCache::Get(const std::string &key) {
+  std::lock_guard<std::mutex> guard(lock);
+  auto found = index.find(key);
+  if (found == index.end()) {
+    stats.misses++;
+    return nullptr;
+  }
+  stats.hits++;
+  entries.splice(entries.begin(), entries, found->second);
+  return found->second->second;
+}
+
+void ResultCache::Put(const std::string &key,
+                      duckdb::MaterializedQueryResult &result,
+                      uint64_t generation) {
+  auto cached = std::make_shared<CachedResult>();
+  cached->names = result.names;
+  cached->types = result.types;
+  auto &collection = result.collection;
+  for (idx_t i = 0; i < collection.ChunkCount(); i++) {
+    auto &chunk = collection.GetChunk(i);
+    cached->bytes += chunkByteSize(chunk);
+    auto copy = duckdb::make_unique<duckdb::DataChunk>();
+    copy->InitializeEmpty(result.types);
+    copy->Reference(chunk);
+    cached->chunks.push_back(std::move(copy));
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+  if (generation != this->generation || cached->bytes > max_bytes ||
+      index.find(key) != index.end()) {
+    return;
+  }
+  evict(cached->bytes);
+  entries.emplace_front(key, cached);
+  index[key] = entries.begin();
+  stats.entries++;
+  stats.bytes += cached->bytes;
+}
+
+// Expects the lock to be held
+void ResultCache::evict(uint64_t needed_bytes) {
+  while (!entries.empty() && stats.bytes + needed_bytes > max_bytes) {
+    auto &entry = entries.back();
+    stats.bytes -= entry.second->bytes;
+    stats.entries--;
+    stats.evictions++;
+    index.erase(entry.first);
+    entries.pop_back();
+  }
+}
+
+void ResultCache::Invalidate() {
+  std::lock_guard<std::mutex> guard(lock);
+  generation++;
+  if (!entries.empty()) {
+    stats.invalidations++;
+  }
+  entries.clear();
+  index.clear();
+  stats.entries = 0;
+  stats.bytes = 0;
+}
+
+uint64_t ResultCache::Generation() {
+  std::lock_guard<std::mutex> guard(lock);
+  return generation;
+}
+
+ResultCache::Stats ResultCache::GetStats() {
+  std::lock_guard<std::mutex> guard(lock);
+  return stats;
+}
+
+bool ResultCache::IsWrite(duckdb::StatementType type) {
+  return type != duckdb::StatementType::SELECT_STATEMENT;
+}
+
+bool ResultCache::CreatesTemporary(duckdb::SQLStatement &statement) {
+  if (statement.type != duckdb::StatementType::CREATE_STATEMENT) {
+    return false;
+  }
+  auto &info = *static_cast<duckdb::CreateStatement &>(statement).info;
+  return info.temporary || info.schema == duckdb::TEMP_SCHEMA;
+}
+
+static const std::unordered_set<std::string> VOLATILE_FUNCTIONS = {
+    "random", "setseed", "nextval", "currval", "uuid", "gen_random_uuid",
+    "now", "today", "current_date", "current_time", "current_timestamp",
+    "get_current_time", "get_current_timestamp", "localtime",
+    "localtimestamp", "transaction_timestamp", "current_setting",
+    "current_schema"};
+
+bool ResultCache::NamesAny(const std::string &query,
+                           const std::unordered_set<std::string> &names) {
+  std::string word;
+  char quote = 0;
+  // one past the end so that the last word is checked as well
+  for (size_t i = 0; i <= query.size(); i++) {
+    char c = i < query.size() ? query[i] : ' ';
+    auto lower = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (quote != 0 && c != quote) {
+      // string literals are skipped, quoted identifiers are words
+      if (quote == '"') {
+        word += lower;
+      }
+      continue;
+    }
+    if (quote == 0 &&
+        (std::isalnum(static_cast<unsigned char>(c)) || c == '_')) {
+      word += lower;
+      continue;
+    }
+    if (c == '\'' || c == '"') {
+      quote = quote == 0 ? c : 0;
+    }
+    if (names.count(word) > 0) {
+      return true;
+    }
+    word.clear();
+  }
+  return false;
+}
+
+bool ResultCache::IsVolatile(const std::string &query) {
+  if (NamesAny(query, VOLATILE_FUNCTIONS)) {
+    return true;
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  return NamesAny(query, functions);
+}
+
+std::string ResultCache::FunctionKey(const std::string &name) {
+  std::string lower;
+  for (char c : name) {
+    lower += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+  return lower;
+}
+
+void ResultCache::AddFunction(const std::string &name) {
+  auto key = FunctionKey(name);
+  std::lock_guard<std::mutex> guard(lock);
+  functions.insert(std::move(key));
+}
+
+CachedQueryResult::CachedQueryResult(std::shared_ptr<CachedResult> cached)
+    : duckdb::QueryResult(duckdb::QueryResultType::MATERIALIZED_RESULT,
+                          duckdb::StatementType::SELECT_STATEMENT,
+                          cached->types, cached->names),
+      cached(std::move(cached)) {}
+
+std::unique_ptr<duckdb::DataChunk> CachedQueryResult::FetchRaw() {
+  auto chunk = duckdb::make_unique<duckdb::DataChunk>();
+  if (chunk_idx >= cached->chunks.size()) {
+    return chunk;
+  }
+  chunk->InitializeEmpty(types);
+  chunk->Reference(*cached->chunks[chunk_idx++]);
+  return chunk;
+}
+
+std::string CachedQueryResult::ToString() {
+  return "[cached result of " + std::to_string(cached->chunks.size()) +
+         " chunks]";
+}
+} // namespace NodeDuckDB
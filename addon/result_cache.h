@@ -0,0 +1,100 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "duckdb.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace NodeDuckDB {
+// Chunks of a materialized SELECT result, never modified once cached
+struct CachedResult {
+  std::vector<std::string> names;
+  std::vector<duckdb::LogicalType> types;
+  std::vector<std::unique_ptr<duckdb::DataChunk>> chunks;
+  uint64_t bytes = 0;
+};
+
+// Results of read queries kept per database, keyed by the normalized query
+// text and the bound parameters, within a byte budget with least recently
+// used entries evicted first. Any statement that may write drops all entries.
+// Shared by the connections of the database and its query threads.
+class ResultCache {
+public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t invalidations = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+  };
+  explicit ResultCache(uint64_t max_bytes) : max_bytes(max_bytes) {}
+  static std::string Key(const std::string &query);
+  static std::string Key(const std::string &query,
+                         const std::vector<duckdb::Value> &parameters);
+  // Counts a hit or a miss
+  std::shared_ptr<CachedResult> Get(const std::string &key);
+  // Copies the materialized result (without copying its data, the chunks
+  // share their buffers) unless it exceeds the budget or a write happened
+  // since `generation` was read
+  void Put(const std::string &key, duckdb::MaterializedQueryResult &result,
+           uint64_t generation);
+  void Invalidate();
+  // changes with every invalidation, read before running a query so that a
+  // result computed before a write isn't cached after it
+  uint64_t Generation();
+  Stats GetStats();
+  // Statements other than SELECT may change data or settings
+  static bool IsWrite(duckdb::StatementType type);
+  // Whether the statement creates a temporary table, view or other object,
+  // which only the connection that created it sees
+  static bool CreatesTemporary(duckdb::SQLStatement &statement);
+  // Whether the query calls a function whose result may change between runs:
+  // random(), now(), nextval() and the like, or a registered JS function.
+  // Goes by the words outside of string literals, so a column named like
+  // such a function also keeps a query out of the cache.
+  bool IsVolatile(const std::string &query);
+  void AddFunction(const std::string &name);
+  // Whether a word of the query outside of string literals is one of `names`
+  static bool NamesAny(const std::string &query,
+                       const std::unordered_set<std::string> &names);
+  // function names are case insensitive, the lower case name
+  static std::string FunctionKey(const std::string &name);
+
+private:
+  typedef std::pair<std::string, std::shared_ptr<CachedResult>> Entry;
+  void evict(uint64_t needed_bytes);
+  std::mutex lock;
+  uint64_t max_bytes;
+  uint64_t generation = 0;
+  // most recently used first
+  std::list<Entry> entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  Stats stats;
+  // names of the JS functions registered on the database's connections
+  std::unordered_set<std::string> functions;
+};
+
+// Hands out the chunks of a cached result, referencing rather than copying
+// their data, so each hit gets its own result over the shared chunks. Its type
+// is MATERIALIZED_RESULT, but it isn't a duckdb::MaterializedQueryResult.
+class CachedQueryResult : public duckdb::QueryResult {
+public:
+  explicit CachedQueryResult(std::shared_ptr<CachedResult> cached);
+  std::unique_ptr<duckdb::DataChunk> FetchRaw() override;
+  std::string ToString() override;
+
+private:
+  std::shared_ptr<CachedResult> cached;
+  size_t chunk_idx = 0;
+};
+} // namespace NodeDuckDB
+
+#endif
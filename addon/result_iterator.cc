@@ -1,24 +1,35 @@
 #include "result_iterator.h"
+#include "addon_data.h"
+#include "chunk_fetcher.h"
+#include "column_converter.h"
 #include "duckdb.hpp"
-#include "duckdb/common/types/hugeint.hpp"
+#include "text_writer.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <string.h>
 using namespace std;
 
 namespace NodeDuckDB {
-Napi::FunctionReference ResultIterator::constructor;
-
 Napi::Object ResultIterator::Init(Napi::Env env, Napi::Object exports) {
-  Napi::Function func =
-      DefineClass(env, "ResultIterator",
-                  {InstanceMethod("fetchRow", &ResultIterator::FetchRow),
-                   InstanceMethod("describe", &ResultIterator::Describe),
-                   InstanceMethod("close", &ResultIterator::Close),
-                   InstanceAccessor<&ResultIterator::GetType>("type"),
-                   InstanceAccessor<&ResultIterator::IsClosed>("isClosed")});
+  Napi::Function func = DefineClass(
+      env, "ResultIterator",
+      {InstanceMethod("fetchRow", &ResultIterator::FetchRow),
+       InstanceMethod("fetchRows", &ResultIterator::FetchRows),
+       InstanceMethod("fetchChunk", &ResultIterator::FetchChunk),
+       InstanceMethod("fetchChunkAsync", &ResultIterator::FetchChunkAsync),
+       InstanceMethod("fetchRowsAsync", &ResultIterator::FetchRowsAsync),
+       InstanceMethod("fetchArrowBatch", &ResultIterator::FetchArrowBatch),
+       InstanceMethod("fetchTextBatch", &ResultIterator::FetchTextBatch),
+       InstanceMethod("writeTextFile", &ResultIterator::WriteTextFile),
+       InstanceMethod("describe", &ResultIterator::Describe),
+       InstanceMethod("close", &ResultIterator::Close),
+       InstanceAccessor<&ResultIterator::GetType>("type"),
+       InstanceAccessor<&ResultIterator::IsClosed>("isClosed"),
+       InstanceAccessor<&ResultIterator::GetMetrics>("metrics"),
+       InstanceAccessor<&ResultIterator::GetProfile>("profile")});
 
-  constructor = Napi::Persistent(func);
-  constructor.SuppressDestruct();
+  AddonData::Get(env)->result_iterator_constructor = Napi::Persistent(func);
 
   exports.Set("ResultIterator", func);
   return exports;
@@ -29,21 +40,254 @@ ResultIterator::ResultIterator(const Napi::CallbackInfo &info)
   Napi::Env env = info.Env();
 }
 
-Napi::Object ResultIterator::Create() { return constructor.New({}); }
+// Doesn't close the result as JS promises can't be rejected while being
+// garbage collected. The native result is freed before the connection is
+// handed back as it still uses it, and the pool's next query is dispatched
+// once the finalizer has returned.
+ResultIterator::~ResultIterator() {
+  if (registry) {
+    registry->Remove(this);
+  }
+  setExternalMemory(0);
+  result.reset();
+  releaseConnection(true);
+}
+
+void ResultRegistry::CloseAll() {
+  // closing unlinks the results
+  std::vector<ResultIterator *> open(results.begin(), results.end());
+  for (auto result : open) {
+    result->close();
+  }
+}
+
+void ResultIterator::setExternalMemory(int64_t bytes) {
+  if (bytes != external_memory) {
+    Napi::MemoryManagement::AdjustExternalMemory(Env(),
+                                                 bytes - external_memory);
+    external_memory = bytes;
+  }
+}
+
+// A materialized result hands over its chunks as they are read, the memory
+// they took is returned as they are freed
+void ResultIterator::releaseChunkMemory(uint64_t bytes) {
+  if (external_memory > 0) {
+    setExternalMemory(
+        std::max<int64_t>(0, external_memory - static_cast<int64_t>(bytes)));
+  }
+}
+
+Napi::Object ResultIterator::Create(Napi::Env env) {
+  return AddonData::Get(env)->result_iterator_constructor.New({});
+}
 
 typedef uint64_t idx_t;
 
-int64_t GetDate(int64_t timestamp) { return timestamp; }
+const char *INACTIVE_STREAM_ERROR =
+    "Attempting to fetch from an unsuccessful or closed streaming "
+    "query result: only "
+    "one stream can be active on one connection at a time)";
+
+bool isInactiveStreamError(const duckdb::InvalidInputException &e) {
+  return strncmp(e.what(),
+                 "Invalid Input Error: Attempting to fetch from an "
+                 "unsuccessful or closed streaming query result",
+                 50) == 0;
+}
+
+const char *INTERRUPTED_ERROR = "Interrupted!";
+const char *INTERRUPTED_ERROR_CODE = "ERR_DUCKDB_INTERRUPTED";
+static const char *JS_FUNCTION_FETCH_ERROR =
+    "Cannot fetch synchronously from a query calling a JS function while an "
+    "asynchronous fetch is in progress or on a database with several threads, "
+    "fetch asynchronously";
 
-int64_t GetTime(int64_t timestamp) {
-  return (int64_t)(timestamp & 0xFFFFFFFFFFFFFFFF);
+void tagInterruptedError(const Napi::Error &e) {
+  if (e.Message().find(INTERRUPTED_ERROR) != std::string::npos) {
+    e.Value().Set("code", INTERRUPTED_ERROR_CODE);
+  }
 }
 
-#define EPOCH_DATE 719528
-#define SECONDS_PER_DAY (60 * 60 * 24)
+uint64_t chunkByteSize(duckdb::DataChunk &chunk, idx_t offset, idx_t count) {
+  uint64_t size = 0;
+  for (auto &vector : chunk.data) {
+    auto type = vector.GetType().InternalType();
+    if (type != duckdb::PhysicalType::VARCHAR) {
+      size += duckdb::GetTypeIdSize(type) * count;
+      continue;
+    }
+    duckdb::VectorData vdata;
+    vector.Orrify(chunk.size(), vdata);
+    auto strings = reinterpret_cast<const duckdb::string_t *>(vdata.data);
+    for (idx_t i = offset; i < offset + count; i++) {
+      auto idx = vdata.sel->get_index(i);
+      if (vdata.validity.RowIsValid(idx)) {
+        size += strings[idx].GetSize();
+      }
+    }
+  }
+  return size;
+}
+
+void ResultIterator::setCurrentChunk(
+    std::unique_ptr<duckdb::DataChunk> chunk) {
+  // the previous chunk is freed once the next one replaces it
+  releaseChunkMemory(current_chunk_bytes);
+  accountEmitted();
+  current_chunk = std::move(chunk);
+  current_chunk_bytes = 0;
+  chunk_offset = 0;
+  emitted_offset = 0;
+  if (!current_chunk || current_chunk->size() == 0) {
+    // streaming results throw when fetched from again once exhausted
+    exhausted = true;
+    releaseConnection();
+    return;
+  }
+  if (converters.empty()) {
+    for (auto &type : result->types) {
+      converters.push_back(CreateColumnConverter(type, options.temporalFormat,
+                                                 options.decimalFormat,
+                                                 options.internStrings));
+    }
+  }
+  // JS gets copies of the BLOBs of shared chunks rather than buffers it
+  // could write into
+  std::shared_ptr<duckdb::DataChunk> owner;
+  if (!shared_chunks) {
+    owner = current_chunk;
+  }
+  for (idx_t col_idx = 0; col_idx < converters.size(); col_idx++) {
+    converters[col_idx]->SetVector(current_chunk->data[col_idx],
+                                   current_chunk->size(), owner);
+  }
+  if (external_memory > 0) {
+    current_chunk_bytes = chunkByteSize(*current_chunk);
+  }
+}
+
+bool ResultIterator::hasRemainingRows() {
+  return current_chunk && chunk_offset < current_chunk->size();
+}
+
+// Adds the rows handed out since the last call to bytes_emitted, so that the
+// size of the current chunk is computed once per slice rather than per row
+void ResultIterator::accountEmitted() {
+  if (current_chunk && chunk_offset > emitted_offset) {
+    metrics.bytes_emitted += chunkByteSize(*current_chunk, emitted_offset,
+                                           chunk_offset - emitted_offset);
+  }
+  emitted_offset = chunk_offset;
+}
+
+// Waits for a fetch in flight as it still uses the connection. The profile of
+// an exhausted result is taken before the connection runs another query.
+void ResultIterator::releaseConnection(bool defer_dispatch) {
+  if (fetch_in_progress) {
+    return;
+  }
+  if (profiled_connection) {
+    if (exhausted) {
+      profile = profiled_connection->GetProfilingInformation(
+          duckdb::ProfilerPrintFormat::JSON);
+    }
+    profiled_connection->DisableProfiling();
+    profiled_connection.reset();
+  }
+  if (!release) {
+    return;
+  }
+  auto release_fn = std::move(release);
+  release = nullptr;
+  if (defer_dispatch) {
+    pool->defer(Env(), std::move(release_fn));
+    return;
+  }
+  release_fn();
+}
+
+// Takes over the prefetch in flight, waiting for it if it already runs.
+// Pending async fetches aren't served here: that would start another fetch
+// while the caller is about to read the result synchronously.
+bool ResultIterator::adoptPrefetch(Napi::Env env) {
+  auto handoff = std::move(prefetch);
+  std::unique_lock<std::mutex> guard(handoff->lock);
+  handoff->done.wait(guard, [&handoff]() {
+    return handoff->state != PrefetchHandoff::State::RUNNING;
+  });
+  bool ran = handoff->state == PrefetchHandoff::State::DONE;
+  handoff->state = PrefetchHandoff::State::ADOPTED;
+  guard.unlock();
+  fetch_in_progress = false;
+  if (!handoff->error.empty()) {
+    auto error = Napi::Error::New(env, handoff->error);
+    tagInterruptedError(error);
+    onFetchError(env, error);
+    error.ThrowAsJavaScriptException();
+    return false;
+  }
+  if (!ran) {
+    return true;
+  }
+  metrics.fetch_ms += handoff->fetch_ms;
+  metrics.chunks_fetched += handoff->chunks.size();
+  for (auto &chunk : handoff->chunks) {
+    prefetched.push_back(std::move(chunk));
+  }
+  exhausted = exhausted || handoff->is_exhausted;
+  if (exhausted) {
+    releaseConnection();
+  }
+  return true;
+}
 
-int64_t Epoch(int64_t date) {
-  return ((int64_t)date - EPOCH_DATE) * SECONDS_PER_DAY;
+bool ResultIterator::fetchNextChunk(Napi::Env env) {
+  if (fetch_in_progress && calls_js) {
+    Napi::Error::New(env, JS_FUNCTION_FETCH_ERROR)
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  if (fetch_in_progress && (!prefetch || !pending.empty())) {
+    Napi::Error::New(env, "Cannot fetch synchronously while an asynchronous "
+                          "fetch is in progress")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  if (fetch_in_progress && !adoptPrefetch(env)) {
+    return false;
+  }
+  if (!prefetched.empty()) {
+    setCurrentChunk(std::move(prefetched.front()));
+    prefetched.pop_front();
+    return true;
+  }
+  if (exhausted) {
+    setCurrentChunk(nullptr);
+    return true;
+  }
+  if (calls_js_off_thread) {
+    Napi::Error::New(env, JS_FUNCTION_FETCH_ERROR)
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  try {
+    auto start = std::chrono::steady_clock::now();
+    auto chunk = result->Fetch();
+    metrics.fetch_ms += elapsedMs(start);
+    if (chunk && chunk->size() > 0) {
+      metrics.chunks_fetched++;
+    }
+    setCurrentChunk(std::move(chunk));
+  } catch (const duckdb::InvalidInputException &e) {
+    if (isInactiveStreamError(e)) {
+      Napi::Error::New(env, INACTIVE_STREAM_ERROR)
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    throw e;
+  }
+  return true;
 }
 
 Napi::Value ResultIterator::FetchRow(const Napi::CallbackInfo &info) {
@@ -52,38 +296,293 @@ Napi::Value ResultIterator::FetchRow(const Napi::CallbackInfo &info) {
     Napi::RangeError::New(env, "Result closed").ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  if (!current_chunk || chunk_offset >= current_chunk->size()) {
-    try {
-      current_chunk = result->Fetch();
-    } catch (const duckdb::InvalidInputException &e) {
-      if (strncmp(e.what(),
-                  "Invalid Input Error: Attempting to fetch from an "
-                  "unsuccessful or closed streaming query result",
-                  50) == 0) {
-        Napi::Error::New(
-            env, "Attempting to fetch from an unsuccessful or closed streaming "
-                 "query result: only "
-                 "one stream can be active on one connection at a time)")
-            .ThrowAsJavaScriptException();
-        return env.Undefined();
-      }
-      throw e;
+  if (!hasRemainingRows()) {
+    if (!fetchNextChunk(env)) {
+      return env.Undefined();
     }
-    chunk_offset = 0;
   }
   if (!current_chunk || current_chunk->size() == 0) {
     return env.Null();
   }
+  auto start = std::chrono::steady_clock::now();
   Napi::Value row;
-  if (rowResultFormat == ResultFormat::OBJECT) {
+  if (options.rowResultFormat == ResultFormat::OBJECT) {
+    resolveColumnNames(env);
     row = getRowObject(env);
   } else {
     row = getRowArray(env);
   }
   chunk_offset++;
+  metrics.conversion_ms += elapsedMs(start);
+  metrics.rows_emitted++;
   return row;
 }
 
+// Converts up to `maxRows` rows into one array, reading as many chunks as
+// needed, so that rows cross into JS a batch at a time instead of one call
+// each. Returns null once no rows are left.
+Napi::Value ResultIterator::FetchRows(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!result) {
+    Napi::RangeError::New(env, "Result closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!info[0].IsNumber() || !(info[0].As<Napi::Number>().DoubleValue() >= 1)) {
+    Napi::TypeError::New(env,
+                         "Invalid argument: maxRows must be a positive number")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  // JS arrays hold at most 2^32 - 1 elements
+  idx_t max_rows = static_cast<idx_t>(
+      std::min(info[0].As<Napi::Number>().DoubleValue(), 4294967295.0));
+  Napi::Array rows = Napi::Array::New(env);
+  idx_t row_count = 0;
+  while (row_count < max_rows) {
+    if (!hasRemainingRows()) {
+      if (!fetchNextChunk(env)) {
+        return env.Undefined();
+      }
+      if (!current_chunk || current_chunk->size() == 0) {
+        break;
+      }
+    }
+    row_count += appendRows(env, rows, row_count, max_rows - row_count);
+  }
+  if (row_count == 0) {
+    return env.Null();
+  }
+  return rows;
+}
+
+// Returns the remaining rows of the current chunk (or the next chunk) in
+// columnar form: one typed array per numeric column plus a validity bitmap
+Napi::Value ResultIterator::FetchChunk(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!result) {
+    Napi::RangeError::New(env, "Result closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!hasRemainingRows()) {
+    if (!fetchNextChunk(env)) {
+      return env.Undefined();
+    }
+  }
+  if (!current_chunk || current_chunk->size() == 0) {
+    return env.Null();
+  }
+  return getColumns(env);
+}
+
+Napi::Value ResultIterator::FetchChunkAsync(const Napi::CallbackInfo &info) {
+  return queueFetch(info.Env(), true);
+}
+
+Napi::Value ResultIterator::FetchRowsAsync(const Napi::CallbackInfo &info) {
+  return queueFetch(info.Env(), false);
+}
+
+// Rejects batch fetches that would interleave with other reads
+bool ResultIterator::checkBatchFetch(Napi::Env env,
+                                     Napi::Promise::Deferred &deferred) {
+  if (!result) {
+    deferred.Reject(Napi::RangeError::New(env, "Result closed").Value());
+    return false;
+  }
+  if (fetch_in_progress) {
+    deferred.Reject(Napi::Error::New(env, "Cannot fetch while an asynchronous "
+                                          "fetch is in progress")
+                        .Value());
+    return false;
+  }
+  if (hasRemainingRows()) {
+    deferred.Reject(
+        Napi::Error::New(env,
+                         "Cannot fetch a batch from a partially read chunk")
+            .Value());
+    return false;
+  }
+  return true;
+}
+
+// Resolves with the next chunk encoded in the Arrow IPC stream format, the
+// first batch also carries the schema. Concatenated, the batches form a
+// complete stream.
+Napi::Value ResultIterator::FetchArrowBatch(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  if (!checkBatchFetch(env, deferred)) {
+    return deferred.Promise();
+  }
+  std::unique_ptr<duckdb::DataChunk> chunk;
+  if (!prefetched.empty()) {
+    chunk = std::move(prefetched.front());
+    prefetched.pop_front();
+  } else if (arrow_end_sent) {
+    deferred.Resolve(env.Null());
+    return deferred.Promise();
+  }
+  fetch_in_progress = true;
+  auto fetcher =
+      new ArrowBatchFetcher(env, pool, this, result, std::move(chunk),
+                            exhausted, !batch_header_sent, deferred);
+  fetcher->Queue();
+  batch_header_sent = true;
+  return deferred.Promise();
+}
+
+// Resolves with the next rows encoded as CSV (the first batch starts with the
+// header line) or NDJSON
+Napi::Value ResultIterator::FetchTextBatch(const Napi::CallbackInfo &info) {
+  return queueTextBatch(info, false);
+}
+
+// Writes the remaining rows encoded as CSV or NDJSON to a file
+Napi::Value ResultIterator::WriteTextFile(const Napi::CallbackInfo &info) {
+  return queueTextBatch(info, true);
+}
+
+Napi::Value ResultIterator::queueTextBatch(const Napi::CallbackInfo &info,
+                                           bool to_file) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  if (!checkBatchFetch(env, deferred)) {
+    return deferred.Promise();
+  }
+  std::string format = info[0].IsString() ? info[0].ToString() : "";
+  if (format != "csv" && format != "ndjson") {
+    deferred.Reject(
+        Napi::TypeError::New(env, "Invalid format: must be csv or ndjson")
+            .Value());
+    return deferred.Promise();
+  }
+  std::string path;
+  if (to_file) {
+    if (!info[1].IsString()) {
+      deferred.Reject(
+          Napi::TypeError::New(env, "Invalid path: must be a string").Value());
+      return deferred.Promise();
+    }
+    path = info[1].ToString();
+  } else if (exhausted && prefetched.empty() && batch_header_sent) {
+    deferred.Resolve(env.Null());
+    return deferred.Promise();
+  }
+  std::vector<std::unique_ptr<duckdb::DataChunk>> chunks;
+  while (!prefetched.empty()) {
+    chunks.push_back(std::move(prefetched.front()));
+    prefetched.pop_front();
+  }
+  fetch_in_progress = true;
+  auto fetcher = new TextBatchFetcher(
+      env, pool, this, result, std::move(chunks), exhausted,
+      format == "csv" ? TextFormat::CSV : TextFormat::NDJSON,
+      !batch_header_sent, path, deferred);
+  fetcher->Queue();
+  batch_header_sent = true;
+  return deferred.Promise();
+}
+
+void ResultIterator::onBatchFetched(Napi::Env env, bool is_exhausted,
+                                    uint64_t chunk_bytes) {
+  fetch_in_progress = false;
+  releaseChunkMemory(chunk_bytes);
+  exhausted = exhausted || is_exhausted;
+  if (!result || exhausted) {
+    releaseConnection();
+  }
+  if (result && !pending.empty()) {
+    servePending(env);
+  }
+}
+
+Napi::Value ResultIterator::queueFetch(Napi::Env env, bool columnar) {
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  if (!result) {
+    deferred.Reject(Napi::RangeError::New(env, "Result closed").Value());
+    return deferred.Promise();
+  }
+  pending.push_back({deferred, columnar});
+  servePending(env);
+  return deferred.Promise();
+}
+
+// Resolves queued async fetches from the current and prefetched chunks, then
+// keeps the prefetch queue topped up
+void ResultIterator::servePending(Napi::Env env) {
+  while (!pending.empty()) {
+    if (!hasRemainingRows()) {
+      if (!prefetched.empty()) {
+        setCurrentChunk(std::move(prefetched.front()));
+        prefetched.pop_front();
+      } else if (exhausted) {
+        setCurrentChunk(nullptr);
+      } else {
+        break;
+      }
+    }
+    auto request = pending.front();
+    pending.pop_front();
+    if (!current_chunk || current_chunk->size() == 0) {
+      request.deferred.Resolve(env.Null());
+      continue;
+    }
+    try {
+      request.deferred.Resolve(request.columnar ? getColumns(env)
+                                                : getRows(env));
+    } catch (const Napi::Error &e) {
+      request.deferred.Reject(e.Value());
+    } catch (std::exception &e) {
+      request.deferred.Reject(Napi::Error::New(env, e.what()).Value());
+    }
+  }
+  startPrefetch(env);
+}
+
+void ResultIterator::startPrefetch(Napi::Env env) {
+  if (!result || fetch_in_progress || exhausted ||
+      prefetched.size() >= options.prefetchChunkCount) {
+    return;
+  }
+  fetch_in_progress = true;
+  prefetch = std::make_shared<PrefetchHandoff>();
+  uint32_t chunk_count = options.prefetchChunkCount - prefetched.size();
+  auto fetcher =
+      new ChunkFetcher(env, pool, this, result, chunk_count, prefetch);
+  fetcher->Queue();
+}
+
+void ResultIterator::onChunksFetched(
+    Napi::Env env, std::vector<std::unique_ptr<duckdb::DataChunk>> &chunks,
+    bool is_exhausted) {
+  fetch_in_progress = false;
+  prefetch.reset();
+  if (!result) {
+    // closed while fetching
+    releaseConnection();
+    return;
+  }
+  for (auto &chunk : chunks) {
+    prefetched.push_back(std::move(chunk));
+  }
+  exhausted = exhausted || is_exhausted;
+  if (exhausted) {
+    releaseConnection();
+  }
+  servePending(env);
+}
+
+void ResultIterator::onFetchError(Napi::Env env, const Napi::Error &e) {
+  fetch_in_progress = false;
+  prefetch.reset();
+  // a failed stream can't be read any further
+  releaseConnection();
+  while (!pending.empty()) {
+    pending.front().deferred.Reject(e.Value());
+    pending.pop_front();
+  }
+}
+
 Napi::Value ResultIterator::Describe(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
   if (!result) {
@@ -118,6 +617,29 @@ Napi::Value ResultIterator::IsClosed(const Napi::CallbackInfo &info) {
   return Napi::Boolean::New(env, isClosed);
 }
 
+Napi::Value ResultIterator::GetMetrics(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  // single rows are accounted at the chunk boundary, count the ones so far
+  accountEmitted();
+  Napi::Object value = Napi::Object::New(env);
+  value.Set("queueWaitMs", Napi::Number::New(env, metrics.queue_wait_ms));
+  value.Set("executeMs", Napi::Number::New(env, metrics.execute_ms));
+  value.Set("fetchMs", Napi::Number::New(env, metrics.fetch_ms));
+  value.Set("chunksFetched", Napi::Number::New(env, metrics.chunks_fetched));
+  value.Set("conversionMs", Napi::Number::New(env, metrics.conversion_ms));
+  value.Set("rowsEmitted", Napi::Number::New(env, metrics.rows_emitted));
+  value.Set("bytesEmitted", Napi::Number::New(env, metrics.bytes_emitted));
+  return value;
+}
+
+Napi::Value ResultIterator::GetProfile(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (profile.empty()) {
+    return env.Null();
+  }
+  return Napi::String::New(env, profile);
+}
+
 Napi::Value ResultIterator::getRowArray(Napi::Env env) {
   idx_t col_count = result->types.size();
   Napi::Array row = Napi::Array::New(env, col_count);
@@ -129,119 +651,130 @@ Napi::Value ResultIterator::getRowArray(Napi::Env env) {
   return row;
 }
 
-Napi::Value ResultIterator::getRowObject(Napi::Env env) {
-  idx_t col_count = result->types.size();
-  Napi::Object row = Napi::Object::New(env);
-
-  for (idx_t col_idx = 0; col_idx < col_count; col_idx++) {
-    auto cellValue = getCellValue(env, col_idx);
-    row.Set(result->names[col_idx], cellValue);
+// Points the row property descriptors at the column name handles, which are
+// only valid in the current handle scope
+void ResultIterator::resolveColumnNames(Napi::Env env) {
+  if (column_names.empty()) {
+    for (auto &name : result->names) {
+      column_names.push_back(Napi::Persistent(Napi::String::New(env, name)));
+    }
+    row_properties.resize(column_names.size());
+    for (auto &property : row_properties) {
+      property = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                  static_cast<napi_property_attributes>(
+                      napi_writable | napi_enumerable | napi_configurable),
+                  nullptr};
+    }
+  }
+  for (idx_t col_idx = 0; col_idx < column_names.size(); col_idx++) {
+    row_properties[col_idx].name = column_names[col_idx].Value();
   }
-  return row;
 }
 
-Napi::Value ResultIterator::getCellValue(Napi::Env env, duckdb::idx_t col_idx) {
-  auto value = current_chunk->data[col_idx].GetValue(chunk_offset);
-  return getMappedValue(env, value);
+// Expects resolveColumnNames to have been called in the current handle scope
+Napi::Value ResultIterator::getRowObject(Napi::Env env) {
+  for (idx_t col_idx = 0; col_idx < row_properties.size(); col_idx++) {
+    row_properties[col_idx].value = getCellValue(env, col_idx);
+  }
+  napi_value row;
+  napi_status status = napi_create_object(env, &row);
+  NAPI_THROW_IF_FAILED(env, status, Napi::Value());
+  status = napi_define_properties(env, row, row_properties.size(),
+                                  row_properties.data());
+  NAPI_THROW_IF_FAILED(env, status, Napi::Value());
+  return Napi::Value(env, row);
 }
 
-Napi::Value ResultIterator::getMappedValue(Napi::Env env, duckdb::Value value) {
-  if (value.is_null) {
-    return env.Null();
-  }
+Napi::Value ResultIterator::getRows(Napi::Env env) {
+  idx_t count = current_chunk->size() - chunk_offset;
+  Napi::Array rows = Napi::Array::New(env, count);
+  appendRows(env, rows, 0, count);
+  return rows;
+}
 
-  switch (value.type().id()) {
-  case duckdb::LogicalTypeId::BOOLEAN:
-    return Napi::Boolean::New(env, value.GetValue<bool>());
-  case duckdb::LogicalTypeId::TINYINT:
-    return Napi::Number::New(env, value.GetValue<int8_t>());
-  case duckdb::LogicalTypeId::SMALLINT:
-    return Napi::Number::New(env, value.GetValue<int16_t>());
-  case duckdb::LogicalTypeId::INTEGER:
-    return Napi::Number::New(env, value.GetValue<int32_t>());
-  case duckdb::LogicalTypeId::BIGINT:
-    return Napi::BigInt::New(env, value.GetValue<int64_t>());
-  case duckdb::LogicalTypeId::HUGEINT: {
-    // hugeint_t represents a signed 128 bit integer in two's complement
-    // notation napi's BigInt is basically a regular signed integer (MSB) so we
-    // want to make sure we pass the absolute value of the huge int into napi
-    // plus the sign bit
-    auto huge_int = value.GetValue<duckdb::hugeint_t>();
-    int is_negative = huge_int.upper < 0;
-    duckdb::hugeint_t positive_huge_int =
-        is_negative ? huge_int * duckdb::hugeint_t(-1) : huge_int;
-    uint64_t arr[2]{positive_huge_int.lower, (uint64_t)positive_huge_int.upper};
-    return Napi::BigInt::New(env, is_negative, 2, &arr[0]);
-  }
-  case duckdb::LogicalTypeId::FLOAT:
-    return Napi::Number::New(env, value.GetValue<float>());
-  case duckdb::LogicalTypeId::DOUBLE:
-    return Napi::Number::New(env, value.GetValue<double>());
-  case duckdb::LogicalTypeId::DECIMAL:
-    return Napi::Number::New(
-        env, value.CastAs(duckdb::LogicalType::DOUBLE).GetValue<double>());
-  case duckdb::LogicalTypeId::VARCHAR:
-    return Napi::String::New(env, value.GetValue<string>());
-  case duckdb::LogicalTypeId::BLOB: {
-    int array_length = value.str_value.length();
-    char char_array[array_length + 1];
-    // TODO: multiple copies, improve
-    strcpy(char_array, value.str_value.c_str());
-    return Napi::Buffer<char>::Copy(env, char_array, array_length);
-  }
-  case duckdb::LogicalTypeId::TIMESTAMP: {
-    if (value.type().InternalType() != duckdb::PhysicalType::INT64) {
-      throw runtime_error("expected int64 for timestamp");
-    }
-    int64_t tval = value.GetValue<int64_t>();
-    return Napi::Number::New(env, tval / 1000);
+// Converts up to `max_count` remaining rows of the current chunk into
+// rows[start], rows[start + 1], ... and returns the number of rows converted
+idx_t ResultIterator::appendRows(Napi::Env env, Napi::Array &rows, idx_t start,
+                                 idx_t max_count) {
+  auto begin = std::chrono::steady_clock::now();
+  idx_t count = std::min(current_chunk->size() - chunk_offset, max_count);
+  bool as_object = options.rowResultFormat == ResultFormat::OBJECT;
+  if (as_object) {
+    resolveColumnNames(env);
   }
-  case duckdb::LogicalTypeId::TIME: {
-    if (value.type().InternalType() != duckdb::PhysicalType::INT64) {
-      throw runtime_error("expected int64 for time");
-    }
-    int64_t tval = value.GetValue<int64_t>();
-    return Napi::Number::New(env, GetTime(tval));
-  }
-  case duckdb::LogicalTypeId::INTERVAL: {
-    return Napi::String::New(env, value.ToString());
-  }
-  case duckdb::LogicalTypeId::UTINYINT:
-    return Napi::Number::New(env, value.GetValue<uint8_t>());
-  case duckdb::LogicalTypeId::USMALLINT:
-    return Napi::Number::New(env, value.GetValue<uint16_t>());
-  case duckdb::LogicalTypeId::UINTEGER:
-    // GetValue is not supported for uint32_t, so using the wider type
-    return Napi::Number::New(env, value.GetValue<int64_t>());
-  case duckdb::LogicalTypeId::LIST: {
-    auto array = Napi::Array::New(env);
-    for (size_t i = 0; i < value.list_value.size(); i++) {
-      auto &element = value.list_value[i];
-      auto mapped_value = getMappedValue(env, element);
-      array.Set(i, mapped_value);
-    }
-    return array;
-  }
-  case duckdb::LogicalTypeId::STRUCT: {
-    auto object = Napi::Object::New(env);
-    for (size_t i = 0; i < value.struct_value.size(); i++) {
-      auto &child_types = duckdb::StructType::GetChildTypes(value.type());
-      auto &key = child_types[i].first;
-      auto &element = value.struct_value[i];
-      auto child_value = getMappedValue(env, element);
-      object.Set(key, child_value);
-    }
-    return object;
+  for (idx_t row_idx = 0; row_idx < count; row_idx++) {
+    // the row stays reachable through the array, the handles of its values
+    // don't have to outlive it
+    Napi::HandleScope scope(env);
+    rows.Set(start + row_idx,
+             as_object ? getRowObject(env) : getRowArray(env));
+    chunk_offset++;
   }
-  default:
-    // default to getting string representation
-    return Napi::String::New(env, value.ToString());
+  accountEmitted();
+  metrics.conversion_ms += elapsedMs(begin);
+  metrics.rows_emitted += count;
+  return count;
+}
+
+Napi::Value ResultIterator::getColumns(Napi::Env env) {
+  auto start = std::chrono::steady_clock::now();
+  idx_t col_count = result->types.size();
+  idx_t count = current_chunk->size() - chunk_offset;
+  Napi::Array columns = Napi::Array::New(env, col_count);
+  for (idx_t col_idx = 0; col_idx < col_count; col_idx++) {
+    columns.Set(col_idx, getColumn(env, col_idx, count));
   }
+  Napi::Object chunk = Napi::Object::New(env);
+  chunk.Set("rowCount", Napi::Number::New(env, count));
+  chunk.Set("columns", columns);
+  chunk_offset = current_chunk->size();
+  accountEmitted();
+  metrics.conversion_ms += elapsedMs(start);
+  metrics.rows_emitted += count;
+  return chunk;
+}
+
+Napi::Value ResultIterator::getCellValue(Napi::Env env, duckdb::idx_t col_idx) {
+  return converters[col_idx]->Convert(env, chunk_offset);
+}
+
+Napi::Value ResultIterator::getColumn(Napi::Env env, duckdb::idx_t col_idx,
+                                      duckdb::idx_t count) {
+  auto &converter = converters[col_idx];
+  Napi::Object column = Napi::Object::New(env);
+  column.Set("name", Napi::String::New(env, result->names[col_idx]));
+  column.Set("type", Napi::String::New(env, result->types[col_idx].ToString()));
+  column.Set("data", converter->ConvertColumn(env, chunk_offset, count));
+  column.Set("validity", converter->GetValidity(env, chunk_offset, count));
+  return column;
 }
 
 Napi::Value ResultIterator::Close(const Napi::CallbackInfo &info) {
-  result.reset();
+  close();
   return info.Env().Undefined();
 }
-void ResultIterator::close() { result.reset(); }
+
+void ResultIterator::close() {
+  if (registry) {
+    registry->Remove(this);
+    registry.reset();
+  }
+  // an in flight ChunkFetcher holds its own reference to the result, so the
+  // native result is released once it completes
+  result.reset();
+  prefetched.clear();
+  accountEmitted();
+  current_chunk.reset();
+  chunk_offset = 0;
+  emitted_offset = 0;
+  converters.clear();
+  setExternalMemory(0);
+  releaseConnection();
+  while (!pending.empty()) {
+    auto &deferred = pending.front().deferred;
+    deferred.Reject(
+        Napi::RangeError::New(deferred.Env(), "Result closed").Value());
+    pending.pop_front();
+  }
+}
 } // namespace NodeDuckDB
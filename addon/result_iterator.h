@@ -1,34 +1,212 @@
 #ifndef RESULT_ITERATOR_H
 #define RESULT_ITERATOR_H
 
+#include "column_converter.h"
 #include "duckdb.hpp"
+#include "query_thread_pool.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <napi.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 namespace NodeDuckDB {
 enum class ResultFormat : uint8_t { OBJECT = 0, ARRAY = 1 };
 
+// Options of connection.execute that shape how a result is read
+struct ResultOptions {
+  ResultFormat rowResultFormat = ResultFormat::OBJECT;
+  // number of chunks the async fetch path keeps ready ahead of the consumer
+  uint32_t prefetchChunkCount = 2;
+  // collect DuckDB's query profile, see ResultIterator::profile
+  bool profile = false;
+  // serve and fill the database's result cache, if it has one
+  bool cache = true;
+  TemporalFormat temporalFormat = TemporalFormat::DEFAULT;
+  DecimalFormat decimalFormat = DecimalFormat::NUMBER;
+  // reuse the JS strings of repeated VARCHAR values, see CreateColumnConverter
+  bool internStrings = false;
+};
+
+// Timings and sizes of a query and the reading of its result
+struct QueryMetrics {
+  // waiting for a query thread
+  double queue_wait_ms = 0;
+  // running the query, for streaming results only until the first chunk can
+  // be fetched
+  double execute_ms = 0;
+  // pulling chunks from DuckDB, which runs the query pipeline of streaming
+  // results
+  double fetch_ms = 0;
+  uint64_t chunks_fetched = 0;
+  // turning DuckDB values into JS values or Arrow batches
+  double conversion_ms = 0;
+  uint64_t rows_emitted = 0;
+  // size of the values handed to JS as stored by DuckDB, or of the encoded
+  // Arrow batches
+  uint64_t bytes_emitted = 0;
+};
+
+extern const char *INACTIVE_STREAM_ERROR;
+bool isInactiveStreamError(const duckdb::InvalidInputException &e);
+// Sets the `code` property of errors caused by connection.interrupt() so that
+// cancellations can be told apart from failed queries
+extern const char *INTERRUPTED_ERROR;
+extern const char *INTERRUPTED_ERROR_CODE;
+void tagInterruptedError(const Napi::Error &e);
+
+// Size of `count` rows of the chunk from `offset` as stored by DuckDB,
+// strings and blobs count with their length
+uint64_t chunkByteSize(duckdb::DataChunk &chunk, duckdb::idx_t offset,
+                       duckdb::idx_t count);
+inline uint64_t chunkByteSize(duckdb::DataChunk &chunk) {
+  return chunkByteSize(chunk, 0, chunk.size());
+}
+
+class ResultIterator;
+
+// Chunks of a prefetch, shared by its ChunkFetcher and the iterator so that a
+// synchronous fetch can take over a prefetch still in flight: it waits for a
+// running fetch to finish or keeps a queued one from starting, and the
+// fetcher's completion is then ignored.
+struct PrefetchHandoff {
+  enum class State : uint8_t { QUEUED, RUNNING, DONE, ADOPTED };
+  std::mutex lock;
+  std::condition_variable done;
+  State state = State::QUEUED;
+  std::vector<std::unique_ptr<duckdb::DataChunk>> chunks;
+  bool is_exhausted = false;
+  std::string error;
+  double fetch_ms = 0;
+};
+
+// Open results of a connection. Results unlink themselves once closed or
+// garbage collected, so the registry only ever holds live results and doesn't
+// grow with the number of queries run. Only used on the JS thread.
+class ResultRegistry {
+public:
+  void Add(ResultIterator *result) { results.insert(result); }
+  void Remove(ResultIterator *result) { results.erase(result); }
+  void CloseAll();
+  size_t Size() const { return results.size(); }
+
+private:
+  std::unordered_set<ResultIterator *> results;
+};
+
 class ResultIterator : public Napi::ObjectWrap<ResultIterator> {
 public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
   ResultIterator(const Napi::CallbackInfo &info);
-  static Napi::Object Create();
-  duckdb::unique_ptr<duckdb::QueryResult> result;
-  ResultFormat rowResultFormat;
+  ~ResultIterator();
+  static Napi::Object Create(Napi::Env env);
+  std::shared_ptr<duckdb::QueryResult> result;
+  ResultOptions options;
+  std::shared_ptr<QueryThreadPool> pool;
+  // set for streaming results, hands the connection back to a ConnectionPool
+  // or ends the query's cancellation on a Connection once the result is
+  // exhausted or closed
+  std::function<void()> release;
+  // the registry of the connection the result belongs to
+  std::shared_ptr<ResultRegistry> registry;
+  QueryMetrics metrics;
+  // set while the profiler of a streaming query's connection is enabled, the
+  // profile is only complete once the result is exhausted
+  std::shared_ptr<duckdb::Connection> profiled_connection;
+  // the profiler's JSON output
+  std::string profile;
+  // the Arrow end-of-stream marker went out, set by ArrowBatchFetcher
+  bool arrow_end_sent = false;
+  // the chunks share their data with the result cache
+  bool shared_chunks = false;
+  // A streaming query calling a JS function. DuckDB calls it on the thread
+  // running the pipeline, which waits for the JS thread whenever that isn't
+  // the JS thread itself, so a synchronous fetch must not wait for a
+  // prefetch, nor run the pipeline when the database has several threads
+  // (calls_js_off_thread) that may call the function while the JS thread is
+  // blocked.
+  bool calls_js = false;
+  bool calls_js_off_thread = false;
   void close();
+  // Tells V8 how much native memory the result holds so that garbage
+  // collection accounts for it
+  void setExternalMemory(int64_t bytes);
+  void releaseChunkMemory(uint64_t bytes);
+  void onChunksFetched(Napi::Env env,
+                       std::vector<std::unique_ptr<duckdb::DataChunk>> &chunks,
+                       bool is_exhausted);
+  void onFetchError(Napi::Env env, const Napi::Error &e);
+  // completes a FetchArrowBatch, FetchTextBatch or WriteTextFile that
+  // consumed chunks of `chunk_bytes` in size
+  void onBatchFetched(Napi::Env env, bool is_exhausted, uint64_t chunk_bytes);
 
 private:
-  static Napi::FunctionReference constructor;
+  struct PendingFetch {
+    Napi::Promise::Deferred deferred;
+    bool columnar;
+  };
   Napi::Value FetchRow(const Napi::CallbackInfo &info);
+  Napi::Value FetchRows(const Napi::CallbackInfo &info);
+  Napi::Value FetchChunk(const Napi::CallbackInfo &info);
+  Napi::Value FetchChunkAsync(const Napi::CallbackInfo &info);
+  Napi::Value FetchRowsAsync(const Napi::CallbackInfo &info);
+  Napi::Value FetchArrowBatch(const Napi::CallbackInfo &info);
+  Napi::Value FetchTextBatch(const Napi::CallbackInfo &info);
+  Napi::Value WriteTextFile(const Napi::CallbackInfo &info);
   Napi::Value Describe(const Napi::CallbackInfo &info);
   Napi::Value GetType(const Napi::CallbackInfo &info);
   Napi::Value Close(const Napi::CallbackInfo &info);
   Napi::Value IsClosed(const Napi::CallbackInfo &info);
-  duckdb::unique_ptr<duckdb::DataChunk> current_chunk;
+  Napi::Value GetMetrics(const Napi::CallbackInfo &info);
+  Napi::Value GetProfile(const Napi::CallbackInfo &info);
+  // shared with the external buffers of large BLOB values
+  std::shared_ptr<duckdb::DataChunk> current_chunk;
   uint64_t chunk_offset = 0;
+  // the rows of the current chunk before this offset are in bytes_emitted
+  uint64_t emitted_offset = 0;
+  std::vector<std::unique_ptr<ColumnConverter>> converters;
+  // property keys of row objects, created once per result
+  std::vector<Napi::Reference<Napi::String>> column_names;
+  // reused for every row object so that its properties are defined in one
+  // call, in the same order, giving all rows the same hidden class
+  std::vector<napi_property_descriptor> row_properties;
+  // chunks fetched ahead by the async path, consumed before fetching again
+  std::deque<std::unique_ptr<duckdb::DataChunk>> prefetched;
+  std::deque<PendingFetch> pending;
+  bool fetch_in_progress = false;
+  // the prefetch in flight, if the fetch in progress is one
+  std::shared_ptr<PrefetchHandoff> prefetch;
+  bool exhausted = false;
+  // the Arrow schema or CSV header went out with the first batch
+  bool batch_header_sent = false;
+  int64_t external_memory = 0;
+  // part of external_memory released once the current chunk is replaced
+  uint64_t current_chunk_bytes = 0;
+  bool fetchNextChunk(Napi::Env env);
+  bool adoptPrefetch(Napi::Env env);
+  void setCurrentChunk(std::unique_ptr<duckdb::DataChunk> chunk);
+  bool hasRemainingRows();
+  void accountEmitted();
+  void releaseConnection(bool defer_dispatch = false);
+  Napi::Value queueFetch(Napi::Env env, bool columnar);
+  bool checkBatchFetch(Napi::Env env, Napi::Promise::Deferred &deferred);
+  Napi::Value queueTextBatch(const Napi::CallbackInfo &info, bool to_file);
+  void servePending(Napi::Env env);
+  void startPrefetch(Napi::Env env);
+  void resolveColumnNames(Napi::Env env);
   Napi::Value getCellValue(Napi::Env env, duckdb::idx_t col_idx);
-  Napi::Value getMappedValue(Napi::Env env, duckdb::Value duckdb_value);
   Napi::Value getRowArray(Napi::Env env);
   Napi::Value getRowObject(Napi::Env env);
+  Napi::Value getRows(Napi::Env env);
+  duckdb::idx_t appendRows(Napi::Env env, Napi::Array &rows,
+                           duckdb::idx_t start, duckdb::idx_t max_count);
+  Napi::Value getColumns(Napi::Env env);
+  Napi::Value getColumn(Napi::Env env, duckdb::idx_t col_idx,
+                        duckdb::idx_t count);
 };
 } // namespace NodeDuckDB
 
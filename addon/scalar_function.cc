@@ -0,0 +1,182 @@
+#include "scalar_function.h"
+#include "duckdb.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <napi.h>
+
+namespace NodeDuckDB {
+typedef uint64_t idx_t;
+
+// A chunk handed from a query thread to the JS thread
+struct JSScalarFunction::Call {
+  duckdb::DataChunk *args;
+  duckdb::Vector *result;
+  std::string error;
+  bool done = false;
+  std::mutex lock;
+  std::condition_variable finished;
+};
+
+JSScalarFunction::JSScalarFunction(
+    Napi::Env env, Napi::Function function, std::string name,
+    std::vector<duckdb::LogicalType> argument_types,
+    duckdb::LogicalType return_type)
+    : name(std::move(name)), argument_types(std::move(argument_types)),
+      return_type(std::move(return_type)), env(env),
+      context(new Context{Napi::Persistent(function)}),
+      js_thread(std::this_thread::get_id()) {
+  tsfn = Napi::ThreadSafeFunction::New(
+      env, function, "node-duckdb-function", 0, 1, context,
+      [](Napi::Env, Context *context) { delete context; });
+  // a registered function doesn't keep the process alive, running queries do
+  tsfn.Unref(env);
+  for (auto &type : this->argument_types) {
+    converters.push_back(CreateColumnConverter(type));
+  }
+}
+
+JSScalarFunction::~JSScalarFunction() { tsfn.Release(); }
+
+void JSScalarFunction::Invoke(duckdb::DataChunk &args,
+                              duckdb::Vector &result) {
+  std::string error;
+  if (std::this_thread::get_id() == js_thread) {
+    // streaming results fetched synchronously run the query on the JS thread
+    error = callFunction(env, args, result);
+  } else {
+    Call call;
+    call.args = &args;
+    call.result = &result;
+    auto status = tsfn.BlockingCall(
+        &call, [this](Napi::Env env, Napi::Function, Call *call) {
+          std::string error =
+              env == nullptr ? name + ": the environment is shutting down"
+                             : callFunction(env, *call->args, *call->result);
+          std::lock_guard<std::mutex> guard(call->lock);
+          call->error = error;
+          call->done = true;
+          call->finished.notify_one();
+        });
+    if (status != napi_ok) {
+      throw duckdb::Exception(name + ": the environment is shutting down");
+    }
+    std::unique_lock<std::mutex> guard(call.lock);
+    call.finished.wait(guard, [&call] { return call.done; });
+    error = call.error;
+  }
+  if (!error.empty()) {
+    throw duckdb::Exception(error);
+  }
+}
+
+// Returns the error thrown by the function or raised converting its result,
+// an empty string on success
+std::string JSScalarFunction::callFunction(Napi::Env env,
+                                           duckdb::DataChunk &args,
+                                           duckdb::Vector &result) {
+  Napi::HandleScope scope(env);
+  idx_t count = args.size();
+  try {
+    std::vector<napi_value> arguments;
+    for (idx_t col_idx = 0; col_idx < args.ColumnCount(); col_idx++) {
+      converters[col_idx]->SetVector(args.data[col_idx], count);
+      arguments.push_back(converters[col_idx]->ConvertColumn(env, 0, count));
+    }
+    writeResult(env, context->function.Call(arguments), count, result);
+  } catch (const Napi::Error &e) {
+    return name + ": " + e.Message();
+  } catch (std::exception &e) {
+    return name + ": " + e.what();
+  }
+  // rows with a NULL argument are NULL, whatever the function returned
+  for (auto &vector : args.data) {
+    duckdb::VectorData vdata;
+    vector.Orrify(count, vdata);
+    for (idx_t row = 0; row < count; row++) {
+      if (!vdata.validity.RowIsValid(vdata.sel->get_index(row))) {
+        duckdb::FlatVector::SetNull(result, row, true);
+      }
+    }
+  }
+  return "";
+}
+
+static const std::string RESULT_LABEL = "the result";
+
+void JSScalarFunction::writeResult(Napi::Env env, const Napi::Value &returned,
+                                   idx_t count, duckdb::Vector &result) {
+  if (returned.IsTypedArray()) {
+    auto array = returned.As<Napi::TypedArray>();
+    if (array.ElementLength() != count) {
+      throw Napi::TypeError::New(env, "must return one value per row");
+    }
+    if (!writer.WriteTypedArray(env, array, 0, result, 0, count,
+                                RESULT_LABEL)) {
+      throw Napi::TypeError::New(env, "typed arrays are not supported for " +
+                                          return_type.ToString() +
+                                          " results");
+    }
+    return;
+  }
+  if (!returned.IsArray()) {
+    throw Napi::TypeError::New(env, "must return an array or a typed array");
+  }
+  auto array = returned.As<Napi::Array>();
+  if (array.Length() != count) {
+    throw Napi::TypeError::New(env, "must return one value per row");
+  }
+  for (idx_t row = 0; row < count; row++) {
+    writer.WriteValue(env, array.Get(static_cast<uint32_t>(row)), result, row,
+                      RESULT_LABEL, row);
+  }
+}
+
+duckdb::LogicalType parseLogicalType(Napi::Env env, const Napi::Value &value) {
+  if (!value.IsString()) {
+    throw Napi::TypeError::New(env, "Invalid type: must be a string");
+  }
+  auto name = value.ToString().Utf8Value();
+  duckdb::LogicalType type;
+  try {
+    type = duckdb::TransformStringToLogicalType(name);
+  } catch (duckdb::Exception &) {
+    throw Napi::TypeError::New(env, "Invalid type: " + name);
+  }
+  if (type.id() == duckdb::LogicalTypeId::INVALID) {
+    throw Napi::TypeError::New(env, "Invalid type: " + name);
+  }
+  return type;
+}
+
+FunctionRegistrar::FunctionRegistrar(
+    Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+    std::shared_ptr<duckdb::Connection> connection,
+    std::shared_ptr<JSScalarFunction> function,
+    Napi::Promise::Deferred &deferred)
+    : QueryWorker(env, std::move(pool)), connection(std::move(connection)),
+      function(std::move(function)), deferred(deferred) {}
+
+void FunctionRegistrar::Execute() {
+  // DuckDB's catalog holds on to the function for as long as it is registered
+  auto registered = function;
+  try {
+    connection->CreateVectorizedFunction(
+        function->name, function->argument_types, function->return_type,
+        [registered](duckdb::DataChunk &args, duckdb::ExpressionState &,
+                     duckdb::Vector &result) {
+          registered->Invoke(args, result);
+        });
+    if (result_cache) {
+      result_cache->AddFunction(function->name);
+    }
+  } catch (std::exception &e) {
+    SetError(e.what());
+  }
+}
+
+void FunctionRegistrar::OnOK() { deferred.Resolve(Env().Undefined()); }
+
+void FunctionRegistrar::OnError(const Napi::Error &e) {
+  deferred.Reject(e.Value());
+}
+} // namespace NodeDuckDB
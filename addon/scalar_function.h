@@ -0,0 +1,78 @@
+#ifndef SCALAR_FUNCTION_H
+#define SCALAR_FUNCTION_H
+
+#include "column_converter.h"
+#include "duckdb.hpp"
+#include "query_thread_pool.h"
+#include "result_cache.h"
+#include "vector_writer.h"
+#include <memory>
+#include <napi.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NodeDuckDB {
+// A JS function DuckDB calls as a vectorized scalar function: once per chunk,
+// with one typed array (or plain array) per argument column, returning one
+// value per row. DuckDB invokes it on the thread running the query, which
+// hands the chunk to the JS thread through a ThreadSafeFunction and blocks
+// until the function has returned.
+class JSScalarFunction {
+public:
+  JSScalarFunction(Napi::Env env, Napi::Function function, std::string name,
+                   std::vector<duckdb::LogicalType> argument_types,
+                   duckdb::LogicalType return_type);
+  ~JSScalarFunction();
+  // called by DuckDB, on any thread
+  void Invoke(duckdb::DataChunk &args, duckdb::Vector &result);
+  const std::string name;
+  const std::vector<duckdb::LogicalType> argument_types;
+  const duckdb::LogicalType return_type;
+
+private:
+  struct Call;
+  // owned by the ThreadSafeFunction, which releases the reference on the JS
+  // thread however the function is dropped from DuckDB's catalog
+  struct Context {
+    Napi::FunctionReference function;
+  };
+  std::string callFunction(Napi::Env env, duckdb::DataChunk &args,
+                           duckdb::Vector &result);
+  void writeResult(Napi::Env env, const Napi::Value &returned,
+                   duckdb::idx_t count, duckdb::Vector &result);
+  Napi::Env env;
+  Napi::ThreadSafeFunction tsfn;
+  Context *context;
+  std::thread::id js_thread;
+  // only used on the JS thread
+  std::vector<std::unique_ptr<ColumnConverter>> converters;
+  VectorWriter writer;
+};
+
+// Parses a SQL type name such as INTEGER or VARCHAR
+duckdb::LogicalType parseLogicalType(Napi::Env env, const Napi::Value &value);
+
+// Adds a JS function to the catalog of a connection. Runs on a worker thread
+// as it waits for the queries running on the connection.
+class FunctionRegistrar : public QueryWorker {
+public:
+  FunctionRegistrar(Napi::Env &env, std::shared_ptr<QueryThreadPool> pool,
+                    std::shared_ptr<duckdb::Connection> connection,
+                    std::shared_ptr<JSScalarFunction> function,
+                    Napi::Promise::Deferred &deferred);
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &e) override;
+  // the database's result cache, which keeps queries calling the function
+  // out of the cache
+  std::shared_ptr<ResultCache> result_cache;
+
+private:
+  std::shared_ptr<duckdb::Connection> connection;
+  std::shared_ptr<JSScalarFunction> function;
+  Napi::Promise::Deferred deferred;
+};
+} // namespace NodeDuckDB
+
+#endif
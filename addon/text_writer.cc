@@ -0,0 +1,216 @@
+#include "text_writer.h"
+#include "duckdb.hpp"
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+namespace NodeDuckDB {
+typedef uint64_t idx_t;
+
+static void writeCsvString(const char *data, size_t size, std::string &out) {
+  bool needs_quotes = size == 0;
+  for (size_t i = 0; i < size && !needs_quotes; i++) {
+    char c = data[i];
+    needs_quotes = c == ',' || c == '"' || c == '\n' || c == '\r';
+  }
+  if (!needs_quotes) {
+    out.append(data, size);
+    return;
+  }
+  out.push_back('"');
+  for (size_t i = 0; i < size; i++) {
+    if (data[i] == '"') {
+      out.push_back('"');
+    }
+    out.push_back(data[i]);
+  }
+  out.push_back('"');
+}
+
+static void writeJsonString(const char *data, size_t size, std::string &out) {
+  static const char *hex = "0123456789abcdef";
+  out.push_back('"');
+  for (size_t i = 0; i < size; i++) {
+    unsigned char c = data[i];
+    switch (c) {
+    case '"':
+      out.append("\\\"");
+      break;
+    case '\\':
+      out.append("\\\\");
+      break;
+    case '\n':
+      out.append("\\n");
+      break;
+    case '\r':
+      out.append("\\r");
+      break;
+    case '\t':
+      out.append("\\t");
+      break;
+    default:
+      if (c < 0x20) {
+        out.append("\\u00");
+        out.push_back(hex[c >> 4]);
+        out.push_back(hex[c & 0xf]);
+      } else {
+        out.push_back(c);
+      }
+    }
+  }
+  out.push_back('"');
+}
+
+// Shortest of the usual precisions that reads back as the same double
+static void writeDouble(double value, std::string &out) {
+  char buffer[32];
+  int length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (strtod(buffer, nullptr) != value) {
+    length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+  }
+  out.append(buffer, length);
+}
+
+// Same for FLOAT, printed at float precision rather than widened to double
+static void writeFloat(float value, std::string &out) {
+  char buffer[32];
+  int length = snprintf(buffer, sizeof(buffer), "%.7g", value);
+  if (strtof(buffer, nullptr) != value) {
+    length = snprintf(buffer, sizeof(buffer), "%.9g", value);
+  }
+  out.append(buffer, length);
+}
+
+template <class T>
+static void writeInteger(const duckdb::VectorData &vdata, idx_t idx,
+                         std::string &out) {
+  out.append(std::to_string(reinterpret_cast<const T *>(vdata.data)[idx]));
+}
+
+TextWriter::TextWriter(const std::vector<std::string> &names,
+                       const std::vector<duckdb::LogicalType> &types,
+                       TextFormat format)
+    : names(names), types(types), format(format) {
+  if (format == TextFormat::NDJSON) {
+    for (auto &name : names) {
+      std::string key;
+      writeJsonString(name.data(), name.size(), key);
+      key.push_back(':');
+      json_keys.push_back(std::move(key));
+    }
+  }
+}
+
+void TextWriter::WriteHeader(std::string &out) {
+  if (format != TextFormat::CSV) {
+    return;
+  }
+  for (idx_t col_idx = 0; col_idx < names.size(); col_idx++) {
+    if (col_idx > 0) {
+      out.push_back(',');
+    }
+    writeCsvString(names[col_idx].data(), names[col_idx].size(), out);
+  }
+  out.push_back('\n');
+}
+
+void TextWriter::writeString(const char *data, size_t size, std::string &out) {
+  if (format == TextFormat::CSV) {
+    writeCsvString(data, size, out);
+  } else {
+    writeJsonString(data, size, out);
+  }
+}
+
+void TextWriter::WriteChunk(duckdb::DataChunk &chunk, std::string &out) {
+  idx_t count = chunk.size();
+  std::vector<duckdb::VectorData> columns(types.size());
+  for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+    chunk.data[col_idx].Orrify(count, columns[col_idx]);
+  }
+  bool csv = format == TextFormat::CSV;
+  for (idx_t row = 0; row < count; row++) {
+    if (!csv) {
+      out.push_back('{');
+    }
+    for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+      if (col_idx > 0) {
+        out.push_back(',');
+      }
+      if (!csv) {
+        out.append(json_keys[col_idx]);
+      }
+      auto &vdata = columns[col_idx];
+      if (!vdata.validity.RowIsValid(vdata.sel->get_index(row))) {
+        // an empty CSV field
+        if (!csv) {
+          out.append("null");
+        }
+        continue;
+      }
+      writeValue(chunk.data[col_idx], vdata, row, types[col_idx], out);
+    }
+    out.append(csv ? "\n" : "}\n");
+  }
+}
+
+void TextWriter::writeValue(duckdb::Vector &vector,
+                            const duckdb::VectorData &vdata, idx_t row,
+                            const duckdb::LogicalType &type,
+                            std::string &out) {
+  auto idx = vdata.sel->get_index(row);
+  switch (type.id()) {
+  case duckdb::LogicalTypeId::BOOLEAN:
+    out.append(reinterpret_cast<const bool *>(vdata.data)[idx] ? "true"
+                                                               : "false");
+    return;
+  case duckdb::LogicalTypeId::TINYINT:
+    return writeInteger<int8_t>(vdata, idx, out);
+  case duckdb::LogicalTypeId::SMALLINT:
+    return writeInteger<int16_t>(vdata, idx, out);
+  case duckdb::LogicalTypeId::INTEGER:
+    return writeInteger<int32_t>(vdata, idx, out);
+  case duckdb::LogicalTypeId::BIGINT:
+    return writeInteger<int64_t>(vdata, idx, out);
+  case duckdb::LogicalTypeId::UTINYINT:
+    return writeInteger<uint8_t>(vdata, idx, out);
+  case duckdb::LogicalTypeId::USMALLINT:
+    return writeInteger<uint16_t>(vdata, idx, out);
+  case duckdb::LogicalTypeId::UINTEGER:
+    return writeInteger<uint32_t>(vdata, idx, out);
+  case duckdb::LogicalTypeId::FLOAT:
+  case duckdb::LogicalTypeId::DOUBLE: {
+    double value =
+        type.id() == duckdb::LogicalTypeId::FLOAT
+            ? reinterpret_cast<const float *>(vdata.data)[idx]
+            : reinterpret_cast<const double *>(vdata.data)[idx];
+    if (!std::isfinite(value)) {
+      // JSON has no representation for NaN and infinity
+      if (format == TextFormat::NDJSON) {
+        out.append("null");
+      } else {
+        out.append(std::isnan(value) ? "nan" : value > 0 ? "inf" : "-inf");
+      }
+      return;
+    }
+    if (type.id() == duckdb::LogicalTypeId::FLOAT) {
+      return writeFloat(static_cast<float>(value), out);
+    }
+    return writeDouble(value, out);
+  }
+  case duckdb::LogicalTypeId::VARCHAR: {
+    auto &str = reinterpret_cast<const duckdb::string_t *>(vdata.data)[idx];
+    return writeString(str.GetDataUnsafe(), str.GetSize(), out);
+  }
+  case duckdb::LogicalTypeId::HUGEINT:
+  case duckdb::LogicalTypeId::DECIMAL:
+    out.append(vector.GetValue(row).ToString());
+    return;
+  default: {
+    auto value = vector.GetValue(row).ToString();
+    return writeString(value.data(), value.size(), out);
+  }
+  }
+}
+} // namespace NodeDuckDB
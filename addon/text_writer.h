@@ -0,0 +1,36 @@
+#ifndef TEXT_WRITER_H
+#define TEXT_WRITER_H
+
+#include "duckdb.hpp"
+#include <string>
+#include <vector>
+
+namespace NodeDuckDB {
+enum class TextFormat : uint8_t { CSV = 0, NDJSON = 1 };
+
+// Serializes the chunks of a query result as CSV (RFC 4180, with a header
+// line) or newline delimited JSON. Numbers, booleans and strings are written
+// straight from the vectors, other types as DuckDB's string representation
+// of the value.
+class TextWriter {
+public:
+  TextWriter(const std::vector<std::string> &names,
+             const std::vector<duckdb::LogicalType> &types, TextFormat format);
+  // Appends the CSV header line, nothing for NDJSON
+  void WriteHeader(std::string &out);
+  void WriteChunk(duckdb::DataChunk &chunk, std::string &out);
+
+private:
+  const std::vector<std::string> &names;
+  const std::vector<duckdb::LogicalType> &types;
+  TextFormat format;
+  // JSON keys of the columns including quotes and colon, built once
+  std::vector<std::string> json_keys;
+  void writeValue(duckdb::Vector &vector, const duckdb::VectorData &vdata,
+                  duckdb::idx_t row, const duckdb::LogicalType &type,
+                  std::string &out);
+  void writeString(const char *data, size_t size, std::string &out);
+};
+} // namespace NodeDuckDB
+
+#endif
@@ -1,6 +1,10 @@
 #include "type-converters.h"
 #include "duckdb.h"
 #include "duckdb.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <string>
 
 duckdb::string
 NodeDuckDB::TypeConverters::convertString(const Napi::Env &env,
@@ -24,6 +28,32 @@ NodeDuckDB::TypeConverters::convertNumber(const Napi::Env &env,
   return options.Get(propertyName).ToNumber().Int32Value();
 }
 
+uint64_t
+NodeDuckDB::TypeConverters::convertUInt64(const Napi::Env &env,
+                                          const Napi::Object &options,
+                                          const std::string propertyName) {
+  auto value = options.Get(propertyName);
+  const std::string errorMessage =
+      "Invalid " + propertyName + ": must be a number or a bigint";
+  if (value.IsBigInt()) {
+    bool lossless;
+    auto result = value.As<Napi::BigInt>().Uint64Value(&lossless);
+    if (!lossless) {
+      throw Napi::RangeError::New(env, errorMessage + " between 0 and 2^64");
+    }
+    return result;
+  }
+  if (!value.IsNumber()) {
+    throw Napi::TypeError::New(env, errorMessage);
+  }
+  double number = value.ToNumber().DoubleValue();
+  // 2^64 is exactly representable as a double, larger values are not
+  if (!(number >= 0) || number >= 18446744073709551616.0) {
+    throw Napi::RangeError::New(env, errorMessage + " between 0 and 2^64");
+  }
+  return static_cast<uint64_t>(number);
+}
+
 bool NodeDuckDB::TypeConverters::convertBoolean(
     const Napi::Env &env, const Napi::Object &options,
     const std::string propertyName) {
@@ -50,6 +80,153 @@ int32_t NodeDuckDB::TypeConverters::convertEnum(const Napi::Env &env,
   return value;
 }
 
+static Napi::TypeError invalidParameter(const Napi::Env &env, size_t index,
+                                        const std::string &reason) {
+  return Napi::TypeError::New(env, "Invalid parameter at index " +
+                                       std::to_string(index) + ": " + reason);
+}
+
+duckdb::Value NodeDuckDB::TypeConverters::convertParameter(
+    const Napi::Env &env, const Napi::Value &value, const size_t index) {
+  if (value.IsNull() || value.IsUndefined()) {
+    return duckdb::Value();
+  }
+  if (value.IsBoolean()) {
+    return duckdb::Value::BOOLEAN(value.ToBoolean().Value());
+  }
+  if (value.IsNumber()) {
+    double number = value.ToNumber().DoubleValue();
+    // integral numbers are bound as integers so that they compare and
+    // aggregate exactly, everything else as a double
+    if (std::trunc(number) == number && std::fabs(number) <= 9007199254740991) {
+      if (number >= INT32_MIN && number <= INT32_MAX) {
+        return duckdb::Value::INTEGER(static_cast<int32_t>(number));
+      }
+      return duckdb::Value::BIGINT(static_cast<int64_t>(number));
+    }
+    return duckdb::Value::DOUBLE(number);
+  }
+  if (value.IsBigInt()) {
+    auto bigint = value.As<Napi::BigInt>();
+    bool lossless;
+    int64_t int64_value = bigint.Int64Value(&lossless);
+    if (lossless) {
+      return duckdb::Value::BIGINT(int64_value);
+    }
+    int sign_bit;
+    size_t word_count = 2;
+    uint64_t words[2] = {0, 0};
+    if (bigint.WordCount() > 2) {
+      throw invalidParameter(env, index, "BigInt exceeds HUGEINT range");
+    }
+    bigint.ToWords(&sign_bit, &word_count, words);
+    duckdb::hugeint_t hugeint;
+    hugeint.lower = words[0];
+    if (words[1] > static_cast<uint64_t>(INT64_MAX)) {
+      // of the magnitudes of 2^127 and above only -2^127 fits
+      if (!sign_bit || words[1] != static_cast<uint64_t>(INT64_MIN) ||
+          words[0] != 0) {
+        throw invalidParameter(env, index, "BigInt exceeds HUGEINT range");
+      }
+      hugeint.upper = INT64_MIN;
+      return duckdb::Value::HUGEINT(hugeint);
+    }
+    hugeint.upper = static_cast<int64_t>(words[1]);
+    if (sign_bit) {
+      hugeint = hugeint * duckdb::hugeint_t(-1);
+    }
+    return duckdb::Value::HUGEINT(hugeint);
+  }
+  if (value.IsString()) {
+    return duckdb::Value(value.ToString().Utf8Value());
+  }
+  if (value.IsBuffer()) {
+    auto buffer = value.As<Napi::Buffer<uint8_t>>();
+    return duckdb::Value::BLOB(buffer.Data(), buffer.Length());
+  }
+  if (value.IsDate()) {
+    double epoch_ms = value.As<Napi::Date>().ValueOf();
+    if (!std::isfinite(epoch_ms)) {
+      throw invalidParameter(env, index, "invalid Date");
+    }
+    return duckdb::Value::TIMESTAMP(
+        duckdb::timestamp_t(static_cast<int64_t>(epoch_ms) * 1000));
+  }
+  throw invalidParameter(env, index, "unsupported type");
+}
+
+std::vector<duckdb::Value> NodeDuckDB::TypeConverters::convertParameters(
+    const Napi::Env &env, const Napi::Value &parameters) {
+  std::vector<duckdb::Value> values;
+  if (parameters.IsUndefined()) {
+    return values;
+  }
+  if (!parameters.IsArray()) {
+    throw Napi::TypeError::New(env, "Parameters must be an array");
+  }
+  auto array = parameters.As<Napi::Array>();
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    values.push_back(convertParameter(env, array.Get(i), i));
+  }
+  return values;
+}
+
+static bool isIdentifier(const std::string &name) {
+  if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+    return false;
+  }
+  for (auto c : name) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<std::string> NodeDuckDB::TypeConverters::convertPragmas(
+    const Napi::Env &env, const Napi::Object &options,
+    const std::string propertyName) {
+  if (!options.Get(propertyName).IsObject()) {
+    throw Napi::TypeError::New(env, "Invalid " + propertyName +
+                                        ": must be an object");
+  }
+  auto pragmas = options.Get(propertyName).ToObject();
+  auto names = pragmas.GetPropertyNames();
+  std::vector<std::string> statements;
+  for (uint32_t i = 0; i < names.Length(); i++) {
+    auto name = names.Get(i).ToString().Utf8Value();
+    if (!isIdentifier(name)) {
+      throw Napi::TypeError::New(env, "Invalid " + propertyName + ": " +
+                                          name + " is not a valid name");
+    }
+    auto value = pragmas.Get(name);
+    std::string rendered;
+    if (value.IsBoolean()) {
+      rendered = value.ToBoolean().Value() ? "true" : "false";
+    } else if (value.IsNumber()) {
+      double number = value.ToNumber().DoubleValue();
+      rendered = std::trunc(number) == number
+                     ? std::to_string(static_cast<int64_t>(number))
+                     : std::to_string(number);
+    } else if (value.IsString()) {
+      rendered = "'";
+      for (auto c : value.ToString().Utf8Value()) {
+        rendered += c;
+        if (c == '\'') {
+          rendered += c;
+        }
+      }
+      rendered += "'";
+    } else {
+      throw Napi::TypeError::New(env, "Invalid " + propertyName + ": " + name +
+                                          " must be a string, number or "
+                                          "boolean");
+    }
+    statements.push_back("PRAGMA " + name + "=" + rendered);
+  }
+  return statements;
+}
+
 void NodeDuckDB::TypeConverters::setDBConfig(const Napi::Env &env,
                                              const Napi::Object &config,
                                              duckdb::DBConfig &nativeConfig) {
@@ -67,12 +244,17 @@ void NodeDuckDB::TypeConverters::setDBConfig(const Napi::Env &env,
 
   if (!optionsObject.Get("checkPointWALSize").IsUndefined()) {
     nativeConfig.checkpoint_wal_size =
-        convertNumber(env, optionsObject, "checkPointWALSize");
+        convertUInt64(env, optionsObject, "checkPointWALSize");
+  }
+
+  if (!optionsObject.Get("useDirectIO").IsUndefined()) {
+    nativeConfig.use_direct_io =
+        convertBoolean(env, optionsObject, "useDirectIO");
   }
 
   if (!optionsObject.Get("maximumMemory").IsUndefined()) {
     nativeConfig.maximum_memory =
-        convertNumber(env, optionsObject, "maximumMemory");
+        convertUInt64(env, optionsObject, "maximumMemory");
   }
 
   if (!optionsObject.Get("useTemporaryDirectory").IsUndefined()) {
@@ -1,5 +1,6 @@
 #include "duckdb.h"
 #include "duckdb.hpp"
+#include <vector>
 
 namespace NodeDuckDB {
 namespace TypeConverters {
@@ -7,11 +8,22 @@ duckdb::string convertString(const Napi::Env &env, const Napi::Object &options,
                              const std::string propertyName);
 int32_t convertNumber(const Napi::Env &env, const Napi::Object &options,
                       const std::string propertyName);
+// Accepts a non-negative number or BigInt, for sizes that may exceed 32 bits
+uint64_t convertUInt64(const Napi::Env &env, const Napi::Object &options,
+                       const std::string propertyName);
 bool convertBoolean(const Napi::Env &env, const Napi::Object &options,
                     const std::string propertyName);
 int32_t convertEnum(const Napi::Env &env, const Napi::Object &options,
                     const std::string propertyName, const int min,
                     const int max);
+duckdb::Value convertParameter(const Napi::Env &env, const Napi::Value &value,
+                               const size_t index);
+std::vector<duckdb::Value> convertParameters(const Napi::Env &env,
+                                             const Napi::Value &parameters);
+// Turns an object of setting names and values into PRAGMA statements
+std::vector<std::string> convertPragmas(const Napi::Env &env,
+                                        const Napi::Object &options,
+                                        const std::string propertyName);
 void setDBConfig(const Napi::Env &env, const Napi::Object &config,
                  duckdb::DBConfig &nativeConfig);
 } // namespace TypeConverters
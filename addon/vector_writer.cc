@@ -0,0 +1,407 @@
+#include "vector_writer.h"
+#include "duckdb.hpp"
+#include "type-converters.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <napi.h>
+#include <sstream>
+#include <string.h>
+#include <type_traits>
+
+namespace NodeDuckDB {
+typedef uint64_t idx_t;
+
+static Napi::TypeError invalidValue(Napi::Env env, const std::string &column,
+                                    idx_t row, const std::string &reason) {
+  return Napi::TypeError::New(env, "Invalid value for " + column +
+                                       " at row " + std::to_string(row) +
+                                       ": " + reason);
+}
+
+template <class T> static std::string formatNumber(T number) {
+  std::ostringstream out;
+  out << number;
+  return out.str();
+}
+
+// Whether T holds the number unchanged: integral types only hold finite whole
+// numbers within their range, floating point types anything but finite
+// numbers beyond their range
+template <class T> static bool fitsNumber(double number, std::true_type) {
+  // the upper bound is exclusive as max() of 64 bit types rounds up to 2^63
+  // or 2^64 as a double
+  return std::trunc(number) == number &&
+         number >= static_cast<double>(std::numeric_limits<T>::lowest()) &&
+         number < static_cast<double>(std::numeric_limits<T>::max()) + 1.0;
+}
+
+template <class T> static bool fitsNumber(double number, std::false_type) {
+  return !std::isfinite(number) ||
+         std::fabs(number) <= std::numeric_limits<T>::max();
+}
+
+template <class T> static bool fits(double number) {
+  return fitsNumber<T>(number, std::is_integral<T>());
+}
+
+template <class T> static bool fitsInteger(int64_t number, std::true_type) {
+  if (number < 0) {
+    return std::is_signed<T>::value &&
+           number >= static_cast<int64_t>(std::numeric_limits<T>::lowest());
+  }
+  return static_cast<uint64_t>(number) <=
+         static_cast<uint64_t>(std::numeric_limits<T>::max());
+}
+
+template <class T> static bool fitsInteger(uint64_t number, std::true_type) {
+  return number <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+}
+
+// integers may lose precision as floating point numbers, like in JS
+template <class T, class N> static bool fitsInteger(N, std::false_type) {
+  return true;
+}
+
+template <class T> static bool fits(int64_t number) {
+  return fitsInteger<T>(number, std::is_integral<T>());
+}
+
+template <class T> static bool fits(uint64_t number) {
+  return fitsInteger<T>(number, std::is_integral<T>());
+}
+
+template <class T>
+static bool setNumber(Napi::Env env, const Napi::Value &value,
+                      duckdb::Vector &vector, idx_t row,
+                      const std::string &column, idx_t source_row) {
+  if (!value.IsNumber()) {
+    return false;
+  }
+  double number = value.As<Napi::Number>().DoubleValue();
+  if (!fits<T>(number)) {
+    throw invalidValue(env, column, source_row,
+                       formatNumber(number) + " doesn't fit " +
+                           vector.GetType().ToString());
+  }
+  duckdb::FlatVector::GetData<T>(vector)[row] = static_cast<T>(number);
+  return true;
+}
+
+// Epoch milliseconds as the microseconds of a TIMESTAMP
+static int64_t timestampMicros(Napi::Env env, double epoch_ms,
+                               const std::string &column, idx_t source_row) {
+  double micros = std::trunc(epoch_ms * 1000);
+  if (!fits<int64_t>(micros)) {
+    throw invalidValue(env, column, source_row,
+                       formatNumber(epoch_ms) +
+                           " is not a valid epoch time in milliseconds");
+  }
+  return static_cast<int64_t>(micros);
+}
+
+void VectorWriter::WriteValue(Napi::Env env, const Napi::Value &value,
+                              duckdb::Vector &vector, idx_t row,
+                              const std::string &column, idx_t source_row) {
+  if (value.IsNull() || value.IsUndefined()) {
+    duckdb::FlatVector::SetNull(vector, row, true);
+    return;
+  }
+  // a row that failed half way may have left a null behind
+  duckdb::FlatVector::SetNull(vector, row, false);
+
+  auto &type = vector.GetType();
+  switch (type.id()) {
+  case duckdb::LogicalTypeId::BOOLEAN:
+    if (value.IsBoolean()) {
+      duckdb::FlatVector::GetData<bool>(vector)[row] =
+          value.As<Napi::Boolean>().Value();
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::TINYINT:
+    if (setNumber<int8_t>(env, value, vector, row, column, source_row)) {
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::SMALLINT:
+    if (setNumber<int16_t>(env, value, vector, row, column, source_row)) {
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::INTEGER:
+    if (setNumber<int32_t>(env, value, vector, row, column, source_row)) {
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::UTINYINT:
+    if (setNumber<uint8_t>(env, value, vector, row, column, source_row)) {
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::USMALLINT:
+    if (setNumber<uint16_t>(env, value, vector, row, column, source_row)) {
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::UINTEGER:
+    if (setNumber<uint32_t>(env, value, vector, row, column, source_row)) {
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::FLOAT:
+    if (setNumber<float>(env, value, vector, row, column, source_row)) {
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::DOUBLE:
+    if (setNumber<double>(env, value, vector, row, column, source_row)) {
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::BIGINT:
+    if (value.IsBigInt()) {
+      bool lossless;
+      auto int64_value = value.As<Napi::BigInt>().Int64Value(&lossless);
+      if (lossless) {
+        duckdb::FlatVector::GetData<int64_t>(vector)[row] = int64_value;
+        return;
+      }
+    } else if (setNumber<int64_t>(env, value, vector, row, column,
+                                  source_row)) {
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::TIMESTAMP: {
+    // dates and numbers are epoch milliseconds, BigInts epoch microseconds
+    auto data = duckdb::FlatVector::GetData<int64_t>(vector);
+    if (value.IsDate()) {
+      double epoch_ms = value.As<Napi::Date>().ValueOf();
+      if (!std::isfinite(epoch_ms)) {
+        throw invalidValue(env, column, source_row, "invalid Date");
+      }
+      data[row] = static_cast<int64_t>(epoch_ms) * 1000;
+      return;
+    }
+    if (value.IsNumber()) {
+      data[row] = timestampMicros(env, value.As<Napi::Number>().DoubleValue(),
+                                  column, source_row);
+      return;
+    }
+    if (value.IsBigInt()) {
+      bool lossless;
+      auto micros = value.As<Napi::BigInt>().Int64Value(&lossless);
+      if (lossless) {
+        data[row] = micros;
+        return;
+      }
+    }
+    break;
+  }
+  case duckdb::LogicalTypeId::VARCHAR:
+    if (value.IsString()) {
+      size_t length;
+      napi_status status =
+          napi_get_value_string_utf8(env, value, nullptr, 0, &length);
+      if (status == napi_ok) {
+        if (string_buffer.size() < length + 1) {
+          string_buffer.resize(length + 1);
+        }
+        status = napi_get_value_string_utf8(env, value, &string_buffer[0],
+                                            length + 1, &length);
+      }
+      if (status != napi_ok) {
+        throw Napi::Error::New(env);
+      }
+      duckdb::FlatVector::GetData<duckdb::string_t>(vector)[row] =
+          duckdb::StringVector::AddString(vector, string_buffer.data(),
+                                          length);
+      return;
+    }
+    break;
+  case duckdb::LogicalTypeId::BLOB:
+    if (value.IsBuffer()) {
+      auto buffer = value.As<Napi::Buffer<char>>();
+      duckdb::FlatVector::GetData<duckdb::string_t>(vector)[row] =
+          duckdb::StringVector::AddStringOrBlob(
+              vector, duckdb::string_t(buffer.Data(), buffer.Length()));
+      return;
+    }
+    break;
+  default:
+    break;
+  }
+  // everything else goes through duckdb::Value and DuckDB's casts
+  vector.SetValue(row, TypeConverters::convertParameter(env, value, row)
+                           .CastAs(type));
+}
+
+// Typed array elements are checked as doubles, int64_t or uint64_t
+template <class SRC> struct Widened {
+  typedef typename std::conditional<
+      std::is_floating_point<SRC>::value, double,
+      typename std::conditional<std::is_signed<SRC>::value, int64_t,
+                                uint64_t>::type>::type type;
+};
+
+template <class SRC, class DST>
+static void copyValues(Napi::Env env, const SRC *source, duckdb::Vector &vector,
+                       idx_t target_offset, idx_t count,
+                       const std::string &column, size_t first_row) {
+  auto target = duckdb::FlatVector::GetData<DST>(vector) + target_offset;
+  if (std::is_same<SRC, DST>::value) {
+    memcpy(target, source, count * sizeof(DST));
+    return;
+  }
+  for (idx_t i = 0; i < count; i++) {
+    auto value = static_cast<typename Widened<SRC>::type>(source[i]);
+    // numbers are truthy or falsy for BOOLEAN columns
+    if (!std::is_same<DST, bool>::value && !fits<DST>(value)) {
+      throw invalidValue(env, column, first_row + i,
+                         formatNumber(value) + " doesn't fit " +
+                             vector.GetType().ToString());
+    }
+    target[i] = static_cast<DST>(source[i]);
+  }
+}
+
+template <class DST>
+static void copyTypedArray(Napi::Env env, const Napi::TypedArray &array,
+                           size_t offset, duckdb::Vector &vector,
+                           idx_t target_offset, idx_t count,
+                           const std::string &column) {
+  auto data = static_cast<const uint8_t *>(array.ArrayBuffer().Data()) +
+              array.ByteOffset();
+  switch (array.TypedArrayType()) {
+  case napi_int8_array:
+    copyValues<int8_t, DST>(env,
+                            reinterpret_cast<const int8_t *>(data) + offset,
+                            vector, target_offset, count, column, offset);
+    break;
+  case napi_uint8_array:
+  case napi_uint8_clamped_array:
+    copyValues<uint8_t, DST>(env, data + offset, vector, target_offset, count,
+                             column, offset);
+    break;
+  case napi_int16_array:
+    copyValues<int16_t, DST>(env,
+                             reinterpret_cast<const int16_t *>(data) + offset,
+                             vector, target_offset, count, column, offset);
+    break;
+  case napi_uint16_array:
+    copyValues<uint16_t, DST>(env,
+                              reinterpret_cast<const uint16_t *>(data) + offset,
+                              vector, target_offset, count, column, offset);
+    break;
+  case napi_int32_array:
+    copyValues<int32_t, DST>(env,
+                             reinterpret_cast<const int32_t *>(data) + offset,
+                             vector, target_offset, count, column, offset);
+    break;
+  case napi_uint32_array:
+    copyValues<uint32_t, DST>(env,
+                              reinterpret_cast<const uint32_t *>(data) + offset,
+                              vector, target_offset, count, column, offset);
+    break;
+  case napi_float32_array:
+    copyValues<float, DST>(env, reinterpret_cast<const float *>(data) + offset,
+                           vector, target_offset, count, column, offset);
+    break;
+  case napi_float64_array:
+    copyValues<double, DST>(env,
+                            reinterpret_cast<const double *>(data) + offset,
+                            vector, target_offset, count, column, offset);
+    break;
+  case napi_bigint64_array:
+    copyValues<int64_t, DST>(env,
+                             reinterpret_cast<const int64_t *>(data) + offset,
+                             vector, target_offset, count, column, offset);
+    break;
+  case napi_biguint64_array:
+    copyValues<uint64_t, DST>(env,
+                              reinterpret_cast<const uint64_t *>(data) + offset,
+                              vector, target_offset, count, column, offset);
+    break;
+  default:
+    throw Napi::TypeError::New(env, "Unsupported typed array");
+  }
+}
+
+bool VectorWriter::WriteTypedArray(Napi::Env env,
+                                   const Napi::TypedArray &array,
+                                   size_t source_offset,
+                                   duckdb::Vector &vector,
+                                   idx_t target_offset, idx_t count,
+                                   const std::string &column) {
+  // rows that failed half way may have left nulls behind
+  for (idx_t i = 0; i < count; i++) {
+    duckdb::FlatVector::SetNull(vector, target_offset + i, false);
+  }
+  auto &type = vector.GetType();
+  switch (type.id()) {
+  case duckdb::LogicalTypeId::BOOLEAN:
+    copyTypedArray<bool>(env, array, source_offset, vector, target_offset,
+                         count, column);
+    return true;
+  case duckdb::LogicalTypeId::TINYINT:
+    copyTypedArray<int8_t>(env, array, source_offset, vector, target_offset,
+                           count, column);
+    return true;
+  case duckdb::LogicalTypeId::SMALLINT:
+    copyTypedArray<int16_t>(env, array, source_offset, vector, target_offset,
+                            count, column);
+    return true;
+  case duckdb::LogicalTypeId::INTEGER:
+    copyTypedArray<int32_t>(env, array, source_offset, vector, target_offset,
+                            count, column);
+    return true;
+  case duckdb::LogicalTypeId::BIGINT:
+    copyTypedArray<int64_t>(env, array, source_offset, vector, target_offset,
+                            count, column);
+    return true;
+  case duckdb::LogicalTypeId::UTINYINT:
+    copyTypedArray<uint8_t>(env, array, source_offset, vector, target_offset,
+                            count, column);
+    return true;
+  case duckdb::LogicalTypeId::USMALLINT:
+    copyTypedArray<uint16_t>(env, array, source_offset, vector, target_offset,
+                             count, column);
+    return true;
+  case duckdb::LogicalTypeId::UINTEGER:
+    copyTypedArray<uint32_t>(env, array, source_offset, vector, target_offset,
+                             count, column);
+    return true;
+  case duckdb::LogicalTypeId::FLOAT:
+    copyTypedArray<float>(env, array, source_offset, vector, target_offset,
+                          count, column);
+    return true;
+  case duckdb::LogicalTypeId::DOUBLE:
+    copyTypedArray<double>(env, array, source_offset, vector, target_offset,
+                           count, column);
+    return true;
+  case duckdb::LogicalTypeId::TIMESTAMP: {
+    if (array.TypedArrayType() == napi_bigint64_array) {
+      // epoch microseconds
+      copyTypedArray<int64_t>(env, array, source_offset, vector, target_offset,
+                              count, column);
+      return true;
+    }
+    if (array.TypedArrayType() == napi_float64_array) {
+      // epoch milliseconds
+      auto target =
+          duckdb::FlatVector::GetData<int64_t>(vector) + target_offset;
+      auto source = array.As<Napi::Float64Array>().Data() + source_offset;
+      for (idx_t i = 0; i < count; i++) {
+        target[i] =
+            timestampMicros(env, source[i], column, source_offset + i);
+      }
+      return true;
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  return false;
+}
+} // namespace NodeDuckDB
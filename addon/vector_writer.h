@@ -0,0 +1,34 @@
+#ifndef VECTOR_WRITER_H
+#define VECTOR_WRITER_H
+
+#include "duckdb.hpp"
+#include <napi.h>
+#include <string>
+
+namespace NodeDuckDB {
+// Writes JS values into flat DuckDB vectors, the counterpart of
+// ColumnConverter. Used by the appender and for the results of JS functions.
+class VectorWriter {
+public:
+  // null and undefined become NULL, values that don't match the vector's type
+  // are cast by DuckDB. Numbers that the vector's type can't hold, such as
+  // fractions or NaN for integer types, throw a TypeError naming `column` and
+  // `source_row`.
+  void WriteValue(Napi::Env env, const Napi::Value &value,
+                  duckdb::Vector &vector, duckdb::idx_t row,
+                  const std::string &column, duckdb::idx_t source_row);
+  // Copies `count` elements starting at `source_offset`, returns false when
+  // typed arrays aren't supported for the vector's type. Elements are checked
+  // like the numbers of WriteValue, rows are named by their array index.
+  bool WriteTypedArray(Napi::Env env, const Napi::TypedArray &array,
+                       size_t source_offset, duckdb::Vector &vector,
+                       duckdb::idx_t target_offset, duckdb::idx_t count,
+                       const std::string &column);
+
+private:
+  // reused when reading JS strings so that writing doesn't allocate per value
+  std::string string_buffer;
+};
+} // namespace NodeDuckDB
+
+#endif
@@ -0,0 +1,137 @@
+// Microbenchmark of the conversions from DuckDB vectors to JS values. Built as
+// a separate addon (cmake-js ... --CDNODE_DUCKDB_BENCHMARKS=ON) and driven by
+// src/benchmarks, which merges its output into the benchmark report.
+//
+// Every case fills one vector and converts it repeatedly through
+// - ColumnConverter::Convert, the fetchRow path,
+// - ColumnConverter::ConvertColumn, the columnar fetchChunk path,
+// - Vector::GetValue + ConvertValue, the generic per value path.
+#include "column_converter.h"
+#include "duckdb.hpp"
+#include <chrono>
+#include <napi.h>
+#include <string>
+#include <vector>
+
+namespace {
+typedef uint64_t idx_t;
+typedef std::chrono::steady_clock Clock;
+
+struct BenchmarkCase {
+  std::string name;
+  duckdb::LogicalType type;
+};
+
+// every tenth value is null
+duckdb::Value makeValue(const duckdb::LogicalType &type, idx_t i) {
+  if (i % 10 == 9) {
+    return duckdb::Value(type);
+  }
+  switch (type.id()) {
+  case duckdb::LogicalTypeId::BOOLEAN:
+    return duckdb::Value::BOOLEAN(i % 2 == 0);
+  case duckdb::LogicalTypeId::VARCHAR:
+    return duckdb::Value("value " + std::to_string(i * 7919));
+  case duckdb::LogicalTypeId::TIMESTAMP:
+    return duckdb::Value::TIMESTAMP(
+        duckdb::timestamp_t(static_cast<int64_t>(i) * 1000000));
+  case duckdb::LogicalTypeId::DECIMAL:
+  case duckdb::LogicalTypeId::DOUBLE:
+    return duckdb::Value::DOUBLE(i / 8.0).CastAs(type);
+  default:
+    return duckdb::Value::BIGINT(i * 31).CastAs(type);
+  }
+}
+
+// Repeats `convert` until min_time_ms passed, returns nanoseconds per value
+template <class F>
+double measure(Napi::Env env, idx_t values_per_run, double min_time_ms,
+               F convert) {
+  idx_t runs = 0;
+  auto start = Clock::now();
+  double elapsed_ms = 0;
+  while (elapsed_ms < min_time_ms) {
+    for (int i = 0; i < 16; i++) {
+      Napi::HandleScope scope(env);
+      convert();
+    }
+    runs += 16;
+    elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() -
+                                                           start)
+                     .count();
+  }
+  return elapsed_ms * 1e6 / (runs * values_per_run);
+}
+
+Napi::Object result(Napi::Env env, const std::string &type,
+                    const std::string &method, double ns_per_value) {
+  auto object = Napi::Object::New(env);
+  object.Set("type", type);
+  object.Set("method", method);
+  object.Set("nsPerValue", ns_per_value);
+  object.Set("valuesPerSec", 1e9 / ns_per_value);
+  return object;
+}
+
+Napi::Value Run(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  double min_time_ms = 200;
+  if (info[0].IsObject() &&
+      info[0].ToObject().Get("minTimeMs").IsNumber()) {
+    min_time_ms =
+        info[0].ToObject().Get("minTimeMs").ToNumber().DoubleValue();
+  }
+
+  std::vector<BenchmarkCase> cases = {
+      {"BOOLEAN", duckdb::LogicalType::BOOLEAN},
+      {"INTEGER", duckdb::LogicalType::INTEGER},
+      {"BIGINT", duckdb::LogicalType::BIGINT},
+      {"DOUBLE", duckdb::LogicalType::DOUBLE},
+      {"VARCHAR", duckdb::LogicalType::VARCHAR},
+      {"TIMESTAMP", duckdb::LogicalType::TIMESTAMP},
+      {"DECIMAL(18,3)", duckdb::LogicalType::DECIMAL(18, 3)},
+  };
+  const idx_t count = STANDARD_VECTOR_SIZE;
+
+  auto results = Napi::Array::New(env);
+  uint32_t result_idx = 0;
+  for (auto &benchmark_case : cases) {
+    duckdb::Vector vector(benchmark_case.type);
+    for (idx_t i = 0; i < count; i++) {
+      vector.SetValue(i, makeValue(benchmark_case.type, i));
+    }
+    auto converter = NodeDuckDB::CreateColumnConverter(benchmark_case.type);
+    converter->SetVector(vector, count);
+
+    auto convert_ns = measure(env, count, min_time_ms, [&]() {
+      for (idx_t i = 0; i < count; i++) {
+        converter->Convert(env, i);
+      }
+    });
+    results.Set(result_idx++,
+                result(env, benchmark_case.name, "convert", convert_ns));
+
+    auto column_ns = measure(env, count, min_time_ms, [&]() {
+      converter->ConvertColumn(env, 0, count);
+    });
+    results.Set(result_idx++, result(env, benchmark_case.name,
+                                     "convertColumn", column_ns));
+
+    auto value_ns = measure(env, count, min_time_ms, [&]() {
+      for (idx_t i = 0; i < count; i++) {
+        NodeDuckDB::ConvertValue(env, vector.GetValue(i));
+      }
+    });
+    results.Set(result_idx++,
+                result(env, benchmark_case.name, "convertValue", value_ns));
+  }
+  return results;
+}
+
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("run", Napi::Function::New(env, Run));
+  return exports;
+}
+} // namespace
+
+NODE_API_MODULE(benchmarks, Init)
@@ -0,0 +1,22 @@
+import { AppenderColumn } from "@addon-types";
+
+import { ConnectionClass } from "./connection-binding";
+
+// lambda doesn't work with npm module bindings
+// eslint-disable-next-line node/no-unpublished-require, @typescript-eslint/no-var-requires
+const { Appender } = require("../../build/Release/node-duckdb-addon.node");
+/**
+ * Bindings should not be used directly, only through the addon wrappers
+ */
+
+export declare class AppenderClass {
+  public static open(connection: ConnectionClass, table: string, schema?: string): Promise<AppenderClass>;
+  public appendRows(rows: unknown[][]): void;
+  public appendColumns(columns: AppenderColumn[]): void;
+  public flush(): Promise<void>;
+  public close(): Promise<void>;
+  public isClosed: boolean;
+  public pendingRowCount: number;
+}
+
+export const AppenderBinding: typeof AppenderClass = Appender;
@@ -1,10 +1,11 @@
-import { IExecuteOptions } from "@addon-types";
+import { IExecuteBatchOptions, IExecuteOptions, ScalarFunction } from "@addon-types";
 
 /**
  * Bindings should not be used directly, only through the addon wrappers
  */
 
 import { DuckDBBinding } from "./duckdb-binding";
+import { PreparedStatementClass } from "./prepared-statement-binding";
 import { ResultIteratorClass } from "./result-iterator-binding";
 
 // lambda doesn't work with npm module bindings
@@ -13,7 +14,20 @@ const { Connection } = require("../../build/Release/node-duckdb-addon.node");
 
 export declare class ConnectionClass {
   constructor(db: InstanceType<typeof DuckDBBinding>);
-  public execute<T>(command: string, options?: IExecuteOptions): Promise<ResultIteratorClass<T>>;
+  public execute<T>(command: string, options?: IExecuteOptions, requestId?: number): Promise<ResultIteratorClass<T>>;
+  public executeBatch<T>(
+    statements: string | string[],
+    options?: IExecuteBatchOptions,
+    requestId?: number,
+  ): Promise<{ rowCounts: number[]; result: ResultIteratorClass<T> }>;
+  public prepare(command: string): Promise<PreparedStatementClass>;
+  public registerFunction(
+    name: string,
+    argumentTypes: string[],
+    returnType: string,
+    fn: ScalarFunction,
+  ): Promise<void>;
+  public interrupt(requestId?: number): void;
   public close(): void;
   public isClosed: boolean;
 }
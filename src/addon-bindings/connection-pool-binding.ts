@@ -0,0 +1,25 @@
+import { IConnectionPoolOptions, IExecuteOptions } from "@addon-types";
+
+import { DuckDBBinding } from "./duckdb-binding";
+import { ResultIteratorClass } from "./result-iterator-binding";
+
+// lambda doesn't work with npm module bindings
+// eslint-disable-next-line node/no-unpublished-require, @typescript-eslint/no-var-requires
+const { ConnectionPool } = require("../../build/Release/node-duckdb-addon.node");
+
+/**
+ * Bindings should not be used directly, only through the addon wrappers
+ */
+
+export declare class ConnectionPoolClass {
+  constructor(db: InstanceType<typeof DuckDBBinding>, options?: IConnectionPoolOptions);
+  public execute<T>(command: string, options?: IExecuteOptions, requestId?: number): Promise<ResultIteratorClass<T>>;
+  public interrupt(requestId: number): void;
+  public close(): void;
+  public isClosed: boolean;
+  public size: number;
+  public idleCount: number;
+  public waitingCount: number;
+}
+
+export const ConnectionPoolBinding: typeof ConnectionPoolClass = ConnectionPool;
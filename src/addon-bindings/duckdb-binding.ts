@@ -1,4 +1,4 @@
-import { AccessMode, IDuckDBConfig, OrderByNullType, OrderType } from "@addon-types";
+import { AccessMode, IDuckDBConfig, IResultCacheStats, OrderByNullType, OrderType } from "@addon-types";
 
 // lambda doesn't work with npm module bindings
 // eslint-disable-next-line node/no-unpublished-require, @typescript-eslint/no-var-requires
@@ -9,8 +9,13 @@ const { DuckDB } = require("../../build/Release/node-duckdb-addon.node");
  */
 
 export declare class DuckDBClass {
+  public static open(config: IDuckDBConfig): Promise<DuckDBClass>;
   constructor(config: IDuckDBConfig);
   public close(): void;
+  public closeAsync(): Promise<void>;
+  public checkpoint(): Promise<void>;
+  public exportHandle(): string;
+  public clearResultCache(): void;
   public isClosed: boolean;
   public accessMode: AccessMode;
   public checkPointWALSize: number;
@@ -20,6 +25,9 @@ export declare class DuckDBClass {
   public collation: string;
   public defaultOrderType: OrderType;
   public defaultNullOrder: OrderByNullType;
+  public queryThreadPoolSize: number;
+  public threads: number;
+  public resultCacheStats: IResultCacheStats | null;
 }
 
 export const DuckDBBinding: typeof DuckDBClass = DuckDB;
@@ -1,3 +1,6 @@
 export * from "./connection-binding";
+export * from "./connection-pool-binding";
 export * from "./duckdb-binding";
 export * from "./result-iterator-binding";
+export * from "./prepared-statement-binding";
+export * from "./appender-binding";
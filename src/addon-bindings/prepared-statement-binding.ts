@@ -0,0 +1,23 @@
+import { IExecuteOptions, QueryParameter } from "@addon-types";
+
+import { ResultIteratorClass } from "./result-iterator-binding";
+
+// lambda doesn't work with npm module bindings
+// eslint-disable-next-line node/no-unpublished-require, @typescript-eslint/no-var-requires
+const { PreparedStatement } = require("../../build/Release/node-duckdb-addon.node");
+/**
+ * Bindings should not be used directly, only through the addon wrappers
+ */
+
+export declare class PreparedStatementClass {
+  public execute<T>(
+    parameters?: QueryParameter[],
+    options?: IExecuteOptions,
+    requestId?: number,
+  ): Promise<ResultIteratorClass<T>>;
+  public close(): void;
+  public isClosed: boolean;
+  public parameterCount: number;
+}
+
+export const PreparedStatementBinding: typeof PreparedStatementClass = PreparedStatement;
@@ -1,4 +1,4 @@
-import { ResultType } from "@addon-types";
+import { IColumnarChunk, IQueryMetrics, ResultType } from "@addon-types";
 
 // lambda doesn't work with npm module bindings
 // eslint-disable-next-line node/no-unpublished-require, @typescript-eslint/no-var-requires
@@ -9,10 +9,19 @@ const { ResultIterator } = require("../../build/Release/node-duckdb-addon.node")
 
 export declare class ResultIteratorClass<T> {
   public fetchRow(): T;
+  public fetchRows(maxRows: number): T[] | null;
+  public fetchChunk(): IColumnarChunk | null;
+  public fetchChunkAsync(): Promise<IColumnarChunk | null>;
+  public fetchRowsAsync(): Promise<T[] | null>;
+  public fetchArrowBatch(): Promise<Buffer | null>;
+  public fetchTextBatch(format: "csv" | "ndjson"): Promise<Buffer | null>;
+  public writeTextFile(format: "csv" | "ndjson", path: string): Promise<null>;
   public describe(): string[][];
   public close(): void;
   public type: ResultType;
   public isClosed: boolean;
+  public metrics: IQueryMetrics;
+  public profile: string | null;
 }
 
 export const ResultIteratorBinding: typeof ResultIteratorClass = ResultIterator;
@@ -0,0 +1,22 @@
+import { QueryParameter } from "./query-parameter";
+
+/**
+ * Values of a single column passed to {@link Appender.appendColumns | Appender.appendColumns}
+ *
+ * @remarks
+ * Typed arrays are copied into numeric, boolean and TIMESTAMP columns without creating a JS value per cell
+ * (TIMESTAMP takes epoch milliseconds as `Float64Array` or epoch microseconds as `BigInt64Array`).
+ * Plain arrays may contain `null` and any {@link QueryParameter | QueryParameter} value, e.g. strings for VARCHAR and Buffers for BLOB columns.
+ * @public
+ */
+export type AppenderColumn =
+  | Int8Array
+  | Uint8Array
+  | Int16Array
+  | Uint16Array
+  | Int32Array
+  | Uint32Array
+  | Float32Array
+  | Float64Array
+  | BigInt64Array
+  | QueryParameter[];
@@ -0,0 +1,108 @@
+/**
+ * Values of a LIST column in a {@link IColumnarChunk | columnar chunk}, laid out like Arrow lists: the elements of all lists
+ * follow each other in `values`, the list of row `i` holds the elements from `offsets[i]` up to (excluding) `offsets[i + 1]`.
+ *
+ * @example
+ * Rows `[1, 2]`, `null` and `[3]` of a `LIST(INTEGER)` column:
+ * ```ts
+ * { length: 3, offsets: Int32Array [0, 2, 2, 3], values: Int32Array [1, 2, 3] }
+ * ```
+ * @public
+ */
+export interface IListColumnData {
+  /**
+   * Number of lists (rows), one less than the number of offsets
+   */
+  length: number;
+  offsets: Int32Array;
+  /**
+   * Elements of the lists in the column form of the element type
+   */
+  values: ColumnData;
+}
+/**
+ * Values of a VARCHAR column in a {@link IColumnarChunk | columnar chunk} read with
+ * {@link IExecuteOptions.internStrings | internStrings}: the value of row `i` is `dictionary[codes[i]]`.
+ *
+ * @example
+ * Rows `"text/html"`, `null`, `"image/png"` and `"text/html"`:
+ * ```ts
+ * { length: 4, dictionary: ["text/html", "image/png"], codes: Uint32Array [0, 0, 1, 0] }
+ * ```
+ * @public
+ */
+export interface IDictionaryColumnData {
+  /**
+   * Number of rows
+   */
+  length: number;
+  /**
+   * Distinct values of the chunk's rows
+   */
+  dictionary: string[];
+  /**
+   * Index into the dictionary for each row, 0 for nulls
+   */
+  codes: Uint32Array;
+}
+/**
+ * Column values of a {@link IColumnarChunk | columnar chunk}
+ *
+ * @remarks
+ * Numeric and boolean columns are returned as typed arrays (booleans as `Uint8Array` of 0/1, BIGINT as `BigInt64Array`),
+ * as are temporal and DECIMAL columns, see {@link IExecuteOptions.temporalFormat | temporalFormat} and
+ * {@link IExecuteOptions.decimalFormat | decimalFormat}. LIST columns are returned as {@link IListColumnData | IListColumnData},
+ * VARCHAR columns as {@link IDictionaryColumnData | IDictionaryColumnData} with {@link IExecuteOptions.internStrings | internStrings},
+ * other types as plain arrays of the same values {@link ResultIterator.fetchRow | fetchRow} would return.
+ * Values at null positions of typed arrays are unspecified, use the validity bitmap to tell nulls apart.
+ * @public
+ */
+export type ColumnData =
+  | Int8Array
+  | Uint8Array
+  | Int16Array
+  | Uint16Array
+  | Int32Array
+  | Uint32Array
+  | Float32Array
+  | Float64Array
+  | BigInt64Array
+  | IListColumnData
+  | IDictionaryColumnData
+  | unknown[];
+/**
+ * Single column of a {@link IColumnarChunk | columnar chunk}
+ * @public
+ */
+export interface IColumn {
+  /**
+   * Column name
+   */
+  name: string;
+  /**
+   * DuckDB type of the column, e.g. INTEGER
+   */
+  type: string;
+  /**
+   * Column values
+   */
+  data: ColumnData;
+  /**
+   * Validity bitmap, bit `i` (least significant bit first) is set when row `i` is not null
+   */
+  validity: Uint8Array;
+}
+/**
+ * A batch of rows returned in columnar form
+ * @public
+ */
+export interface IColumnarChunk {
+  /**
+   * Number of rows in the chunk
+   */
+  rowCount: number;
+  /**
+   * Columns in the order of the result set schema
+   */
+  columns: IColumn[];
+}
@@ -42,6 +42,42 @@ export enum RowResultFormat {
    */
   Array = 1,
 }
+/**
+ * Format of DATE and TIMESTAMP values in rows, see {@link IExecuteOptions.temporalFormat | temporalFormat}
+ * @public
+ */
+export enum TemporalFormat {
+  /**
+   * DATEs as strings, e.g. "2021-05-05", TIMESTAMPs as milliseconds since the epoch
+   */
+  Default = 0,
+  /**
+   * DATEs and TIMESTAMPs as JS `Date` objects
+   */
+  Date = 1,
+  /**
+   * DATEs (at midnight UTC) and TIMESTAMPs as milliseconds since the epoch
+   */
+  Epoch = 2,
+}
+/**
+ * Format of DECIMAL values, see {@link IExecuteOptions.decimalFormat | decimalFormat}
+ * @public
+ */
+export enum DecimalFormat {
+  /**
+   * The nearest double, which may lose precision
+   */
+  Number = 0,
+  /**
+   * BigInt of the unscaled value, i.e. the decimal times 10 to the power of its scale, e.g. 12345n for DECIMAL(5,2) 123.45
+   */
+  BigInt = 1,
+  /**
+   * Exact string with all digits of the scale, e.g. "123.45"
+   */
+  String = 2,
+}
 /**
  * Options object type for the DuckDB class
  * @public
@@ -54,15 +90,19 @@ export interface IDuckDBOptionsConfig {
   /**
    * Checkpoint Write Ahead Log Size (in bytes)
    */
-  checkPointWALSize?: number;
+  checkPointWALSize?: number | bigint;
   /**
    * Whether to use Direct IO
    */
   useDirectIO?: boolean;
   /**
-   * Maximum memory limit for the databse (in bytes)
+   * Maximum memory limit for the databse (in bytes), use a bigint for limits beyond `Number.MAX_SAFE_INTEGER`
+   */
+  maximumMemory?: number | bigint;
+  /**
+   * Number of threads DuckDB uses to execute a single query, equivalent to `PRAGMA threads` but applied before the first query runs
    */
-  maximumMemory?: number;
+  threads?: number;
   /**
    * Whether to use temporary directory to store data that doesn't fit in memory
    */
@@ -83,6 +123,34 @@ export interface IDuckDBOptionsConfig {
    * Default order for Null values
    */
   defaultNullOrder?: OrderByNullType;
+  /**
+   * Number of native threads that run queries and fetch their results, 4 by default.
+   * These are separate from the libuv threadpool, so long running queries don't delay `fs` or `dns` work.
+   * With 0 queries run on the libuv threadpool instead, to compare against, see `yarn benchmark --suites=mixed-io`.
+   */
+  queryThreadPoolSize?: number;
+  /**
+   * Settings applied to every new connection, as if `PRAGMA name=value` was executed on it
+   *
+   * @example
+   * ```ts
+   * new DuckDB({ options: { connectionPragmas: { explain_output: "all" } } });
+   * ```
+   */
+  connectionPragmas?: Record<string, string | number | boolean>;
+  /**
+   * Size in bytes of the cache of query results, disabled by default.
+   * Materialized results of single `SELECT` queries (and prepared statements with the same parameters) are kept in native memory and repeated
+   * queries are answered from them without running again. Least recently used results are dropped once the size is exceeded.
+   *
+   * @remarks
+   * Any other statement, including ones run by an {@link Appender | Appender} or {@link Connection.executeBatch | executeBatch}, empties the cache
+   * once it ran, so results never outlive a change to the data. Queries in an explicit transaction and profiled queries bypass the cache,
+   * as do queries calling functions whose result may change between runs (`random()`, `now()` and the like, or JS functions registered
+   * with {@link Connection.registerFunction | registerFunction}) and all queries of a connection once it created a temporary object.
+   * Databases opened by {@link IDuckDBConfig.handle | handle} share the cache of the exported database. See {@link DuckDB.resultCacheStats | resultCacheStats}.
+   */
+  resultCacheSize?: number | bigint;
 }
 /**
  * Configuration object for DuckDB
@@ -93,8 +161,35 @@ export interface IDuckDBConfig {
    * Path to the database file. If undefined, in-memory database is created
    */
   path?: string;
+  /**
+   * Handle of a database returned by {@link DuckDB.exportHandle | exportHandle}, e.g. in another worker thread, to use instead of opening one.
+   * Can't be combined with `path`, and of the `options` only `queryThreadPoolSize` and `connectionPragmas` apply. The result cache and
+   * the number of {@link IDuckDBOptionsConfig.threads | threads} are those of the exported database.
+   * The `connectionPragmas` of the exported database are used unless given.
+   */
+  handle?: string;
   options?: IDuckDBOptionsConfig;
 }
+/**
+ * Options object type for the ConnectionPool class
+ * @public
+ */
+export interface IConnectionPoolOptions {
+  /**
+   * Number of connections to keep open, defaults to the database's {@link IDuckDBOptionsConfig.queryThreadPoolSize | queryThreadPoolSize}
+   */
+  size?: number;
+}
+/**
+ * Minimal interface of an {@link https://developer.mozilla.org/en-US/docs/Web/API/AbortSignal | AbortSignal},
+ * e.g. from an `AbortController` (global since Node.js 15) or the `abort-controller` package
+ * @public
+ */
+export interface IAbortSignal {
+  readonly aborted: boolean;
+  addEventListener(type: "abort", listener: () => void): void;
+  removeEventListener(type: "abort", listener: () => void): void;
+}
 /**
  * Options for connection.execute
  * @public
@@ -109,4 +204,86 @@ export interface IExecuteOptions {
    * Row format
    */
   rowResultFormat?: RowResultFormat;
+  /**
+   * Number of chunks (of up to 1024 rows each) fetched ahead on a worker thread when the result is read asynchronously,
+   * e.g. via {@link Connection.execute | Connection.execute} streams or `for await`. Defaults to 2.
+   */
+  prefetchChunkCount?: number;
+  /**
+   * Collect DuckDB's query profile (operator tree with per-operator timings and cardinalities), see {@link ResultIterator.profile | ResultIterator.profile}.
+   * Profiling adds some overhead to the query.
+   */
+  profile?: boolean;
+  /**
+   * Set to false to neither answer the query from nor add its result to the database's result cache,
+   * see {@link IDuckDBOptionsConfig.resultCacheSize | resultCacheSize}. Defaults to true.
+   */
+  cache?: boolean;
+  /**
+   * Format of DATE and TIMESTAMP values in rows, defaults to {@link TemporalFormat.Default | TemporalFormat.Default}.
+   * TIME values are microseconds since midnight and INTERVAL values {@link IInterval | IInterval} objects regardless.
+   * Columnar chunks hold DATE and TIMESTAMP columns as `Float64Array`s of milliseconds since the epoch and TIME columns as `Float64Array`s of microseconds.
+   */
+  temporalFormat?: TemporalFormat;
+  /**
+   * Format of DECIMAL values, defaults to {@link DecimalFormat.Number | DecimalFormat.Number}.
+   * Columnar chunks hold numbers in a `Float64Array` and BigInts of decimals of up to 18 digits in a `BigInt64Array`.
+   */
+  decimalFormat?: DecimalFormat;
+  /**
+   * Create the JS string of each distinct VARCHAR value once per result and reuse it for all rows holding the value,
+   * which saves allocations and heap for columns repeating a few values such as content types or host names.
+   * Columnar chunks then hold VARCHAR columns as {@link IDictionaryColumnData | IDictionaryColumnData}.
+   * Up to 65536 distinct values and 16 MiB of string data are interned per column, strings nested in LIST and STRUCT values are not interned.
+   */
+  internStrings?: boolean;
+  /**
+   * Cancel the query if it has not finished after this many milliseconds. For streaming results the time until the result is fully read or closed counts.
+   * A cancelled query rejects with a {@link QueryCancelledError | QueryCancelledError}, other queries on the connection are not affected.
+   */
+  timeoutMs?: number;
+  /**
+   * Cancel the query when the signal is aborted, see {@link IExecuteOptions.timeoutMs | timeoutMs}
+   */
+  signal?: IAbortSignal;
+}
+/**
+ * Options for connection.executeBatch
+ * @public
+ */
+export interface IExecuteBatchOptions
+  extends Pick<
+    IExecuteOptions,
+    "rowResultFormat" | "temporalFormat" | "decimalFormat" | "internStrings" | "timeoutMs" | "signal"
+  > {
+  /**
+   * Run all statements in a single transaction that is committed once the last statement succeeded and rolled back when one fails.
+   * Otherwise every statement commits on its own and the statements that ran before a failing one stay committed.
+   * Queries issued on the connection while the batch runs wait for it, so they never run inside its transaction.
+   */
+  transaction?: boolean;
+}
+/**
+ * Output format of {@link Connection.exportTo | Connection.exportTo}
+ * @public
+ */
+export type ExportFormat = "csv" | "ndjson" | "parquet";
+/**
+ * Options for connection.exportTo
+ * @public
+ */
+export interface IExportOptions extends Pick<IExecuteOptions, "timeoutMs" | "signal"> {
+  /**
+   * `csv` writes a header line followed by the rows as RFC 4180 CSV, `ndjson` one JSON object per row.
+   * `parquet` is written by DuckDB's parquet extension and requires a `path`.
+   */
+  format: ExportFormat;
+  /**
+   * File to write to, it is created or truncated
+   */
+  path?: string;
+  /**
+   * Stream the encoded bytes are piped to, it is ended once the export completes
+   */
+  writable?: NodeJS.WritableStream;
 }
@@ -1,2 +1,9 @@
 export * from "./result-type";
 export * from "./duckdb-config";
+export * from "./columnar-chunk";
+export * from "./query-parameter";
+export * from "./appender-column";
+export * from "./query-metrics";
+export * from "./scalar-function";
+export * from "./result-cache-stats";
+export * from "./interval";
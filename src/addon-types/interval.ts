@@ -0,0 +1,10 @@
+/**
+ * Value of an INTERVAL column. DuckDB keeps the three parts apart, as the number of days in a month depends on the date
+ * the interval is added to.
+ * @public
+ */
+export interface IInterval {
+  months: number;
+  days: number;
+  micros: number;
+}
@@ -0,0 +1,78 @@
+/**
+ * Timings and sizes of a query and the reading of its result, see {@link ResultIterator.metrics | ResultIterator.metrics}
+ *
+ * @remarks
+ * Counters grow as the result is read, timings are in milliseconds.
+ * @public
+ */
+export interface IQueryMetrics {
+  /**
+   * Time the query waited for a query thread, see {@link IDuckDBOptionsConfig.queryThreadPoolSize | queryThreadPoolSize}
+   */
+  queueWaitMs: number;
+  /**
+   * Time spent executing the query. For streaming results only until the first rows can be fetched, the rest of the work happens while fetching.
+   */
+  executeMs: number;
+  /**
+   * Time spent pulling chunks from DuckDB
+   */
+  fetchMs: number;
+  /**
+   * Number of chunks pulled from DuckDB, `fetchMs / chunksFetched` is the average fetch time per chunk
+   */
+  chunksFetched: number;
+  /**
+   * Time spent turning DuckDB values into JS values or Arrow batches
+   */
+  conversionMs: number;
+  /**
+   * Number of rows handed to JS
+   */
+  rowsEmitted: number;
+  /**
+   * Size in bytes of the values handed to JS as stored by DuckDB (strings and blobs count with their length), or of the encoded Arrow batches
+   */
+  bytesEmitted: number;
+}
+/**
+ * Operator of a {@link IQueryProfile | query profile}, as reported by DuckDB's profiler
+ * @public
+ */
+export interface IQueryProfileNode {
+  /**
+   * Physical operator, e.g. `HASH_GROUP_BY`
+   */
+  name: string;
+  /**
+   * Time spent in the operator in seconds
+   */
+  timing: number;
+  /**
+   * Number of rows the operator produced
+   */
+  cardinality: number;
+  /**
+   * Operator details, e.g. the scanned table or the filters applied
+   */
+  extra_info: string;
+  children: IQueryProfileNode[];
+}
+/**
+ * DuckDB's profiler output of a query run with the {@link IExecuteOptions.profile | profile} option
+ * @public
+ */
+export interface IQueryProfile {
+  /**
+   * Total time of the query in seconds
+   */
+  result: number;
+  /**
+   * Time spent in the phases of query planning (e.g. optimizers) in seconds
+   */
+  timings: Record<string, number>;
+  /**
+   * Physical operator tree
+   */
+  tree: IQueryProfileNode;
+}
@@ -0,0 +1,9 @@
+/**
+ * Value that can be bound to a parameter (`?`) of a {@link PreparedStatement | prepared statement}
+ *
+ * @remarks
+ * Integral numbers are bound as INTEGER or BIGINT, other numbers as DOUBLE, BigInts as BIGINT or HUGEINT,
+ * Buffers as BLOB, Dates as TIMESTAMP and `null`/`undefined` as NULL.
+ * @public
+ */
+export type QueryParameter = null | undefined | boolean | number | bigint | string | Buffer | Date;
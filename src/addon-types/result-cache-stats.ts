@@ -0,0 +1,33 @@
+/**
+ * Counters of a database's result cache, see {@link IDuckDBOptionsConfig.resultCacheSize | resultCacheSize}
+ *
+ * @remarks
+ * The counters grow over the lifetime of the database, `entries` and `bytes` describe the cache's current content.
+ * @public
+ */
+export interface IResultCacheStats {
+  /**
+   * Queries served from the cache
+   */
+  hits: number;
+  /**
+   * Queries looked up but not found, which ran and may have been added to the cache
+   */
+  misses: number;
+  /**
+   * Results dropped to make room for newer ones
+   */
+  evictions: number;
+  /**
+   * Times a statement that may have changed data emptied the cache
+   */
+  invalidations: number;
+  /**
+   * Number of cached results
+   */
+  entries: number;
+  /**
+   * Size of the cached results
+   */
+  bytes: number;
+}
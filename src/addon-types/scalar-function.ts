@@ -0,0 +1,24 @@
+import { AppenderColumn } from "./appender-column";
+import { ColumnData } from "./columnar-chunk";
+
+/**
+ * JS function registered with {@link Connection.registerFunction | Connection.registerFunction}
+ *
+ * @remarks
+ * It is called once per DuckDB data chunk (up to 1024 rows) with one {@link ColumnData | column} per argument, numeric and boolean
+ * arguments as typed arrays. It returns one value per row, as an array or a typed array. Rows where an argument is `NULL` are
+ * `NULL` whatever the function returns for them.
+ * @public
+ */
+export type ScalarFunction = (...columns: ColumnData[]) => AppenderColumn;
+/**
+ * Column of a table registered with {@link Connection.registerTable | Connection.registerTable}
+ * @public
+ */
+export interface ITableColumn {
+  name: string;
+  /**
+   * DuckDB type, e.g. INTEGER or VARCHAR
+   */
+  type: string;
+}
@@ -0,0 +1,76 @@
+import { AppenderBinding, AppenderClass } from "@addon-bindings";
+import { AppenderColumn, QueryParameter } from "@addon-types";
+
+import { Connection } from "./connection";
+
+/**
+ * Bulk loads data into an existing table, much faster than `INSERT` statements.
+ *
+ * @remarks
+ * Appended rows are collected in DuckDB's native format and written to the table on a worker thread by {@link Appender.flush | flush} and {@link Appender.close | close}.
+ * Rows that were appended but not flushed are lost unless `close()` is called.
+ *
+ * @public
+ */
+export class Appender {
+  /**
+   * Opens an appender for a table.
+   * @param connection - {@link Connection | Connection} to append through
+   * @param table - name of the table to append to
+   * @param schema - schema of the table, defaults to `main`
+   *
+   * @remarks
+   * The table is looked up on a native thread once the queries issued on the connection before are done, so opening an appender
+   * doesn't block the event loop while the connection is busy.
+   *
+   * @example
+   * Loading columns:
+   * ```ts
+   * await connection.executeIterator("CREATE TABLE people(id INTEGER, name VARCHAR);");
+   * const appender = await Appender.open(connection, "people");
+   * appender.appendColumns([new Int32Array([1, 2, 3]), ["Mark", "Hannes", "Bob"]]);
+   * appender.appendRows([[4, "Alice"]]);
+   * await appender.close();
+   * ```
+   */
+  public static async open(connection: Connection, table: string, schema?: string): Promise<Appender> {
+    return new Appender(await AppenderBinding.open(connection.binding, table, schema));
+  }
+  private constructor(private appenderBinding: AppenderClass) {}
+  /**
+   * Append rows, each an array with one value per table column
+   */
+  public appendRows(rows: QueryParameter[][]): void {
+    return this.appenderBinding.appendRows(rows);
+  }
+  /**
+   * Append a batch of rows given as one array per table column, all of the same length
+   */
+  public appendColumns(columns: AppenderColumn[]): void {
+    return this.appenderBinding.appendColumns(columns);
+  }
+  /**
+   * Write all appended rows to the table
+   */
+  public flush(): Promise<void> {
+    return this.appenderBinding.flush();
+  }
+  /**
+   * Write all appended rows to the table and release the appender
+   */
+  public close(): Promise<void> {
+    return this.appenderBinding.close();
+  }
+  /**
+   * Number of appended rows that have not been flushed yet
+   */
+  public get pendingRowCount(): number {
+    return this.appenderBinding.pendingRowCount;
+  }
+  /**
+   * If the appender is closed returns true, otherwise false.
+   */
+  public get isClosed(): boolean {
+    return this.appenderBinding.isClosed;
+  }
+}
@@ -0,0 +1,120 @@
+import { Readable } from "stream";
+
+import { ConnectionPoolBinding, ConnectionPoolClass } from "@addon-bindings";
+import { IConnectionPoolOptions, IExecuteOptions, IExportOptions } from "@addon-types";
+
+import { DuckDB } from "./duckdb";
+import { exportResult } from "./export";
+import { executeCancellable, nextRequestId } from "./query-cancellation";
+import { ResultIterator } from "./result-iterator";
+import { getArrowStream, getChunkStream, getResultStream } from "./result-stream";
+
+/**
+ * Keeps a number of {@link Connection | connections} to a database open and runs each query on an idle one.
+ *
+ * @remarks
+ * A single connection can only stream one result at a time, a pool serves as many concurrent queries as it has connections and queues the rest.
+ * A connection returns to the pool once its query fails or its result is materialized, fully read or closed, so remember to close results that are not read to the end.
+ *
+ * @public
+ */
+export class ConnectionPool {
+  private connectionPoolBinding: ConnectionPoolClass;
+  /**
+   * ConnectionPool constructor.
+   * @param duckdb - {@link DuckDB | DuckDB} instance to connect to.
+   * @param options - optional options object of type {@link IConnectionPoolOptions | IConnectionPoolOptions}
+   *
+   * @example
+   * Streaming concurrent queries:
+   * ```ts
+   * const db = new DuckDB();
+   * const pool = new ConnectionPool(db, { size: 8 });
+   * const [people, sales] = await Promise.all([
+   *   pool.execute("SELECT * FROM people;"),
+   *   pool.execute("SELECT * FROM sales;"),
+   * ]);
+   * ```
+   */
+  constructor(duckdb: DuckDB, options?: IConnectionPoolOptions) {
+    this.connectionPoolBinding = new ConnectionPoolBinding(duckdb.db, options);
+  }
+  /**
+   * Asynchronously executes the query on an idle connection and returns a {@link https://nodejs.org/api/stream.html#stream_class_stream_readable | Readable stream} that wraps the result set.
+   * @param command - SQL command to execute
+   * @param options - optional options object of type {@link IExecuteOptions | IExecuteOptions}
+   */
+  public async execute<T>(command: string, options?: IExecuteOptions): Promise<Readable> {
+    return getResultStream(await this.executeIterator<T>(command, options));
+  }
+  /**
+   * Like {@link ConnectionPool.execute | execute}, but returns a stream of {@link IColumnarChunk | columnar chunks}.
+   * @param command - SQL command to execute
+   * @param options - optional options object of type {@link IExecuteOptions | IExecuteOptions}, `rowResultFormat` is ignored
+   */
+  public async executeColumnar(command: string, options?: IExecuteOptions): Promise<Readable> {
+    return getChunkStream(await this.executeIterator(command, options));
+  }
+  /**
+   * Like {@link ConnectionPool.execute | execute}, but returns a stream of the result in the Arrow IPC streaming format.
+   * @param command - SQL command to execute
+   * @param options - optional options object of type {@link IExecuteOptions | IExecuteOptions}, `rowResultFormat` is ignored
+   */
+  public async executeArrow(command: string, options?: IExecuteOptions): Promise<Readable> {
+    return getArrowStream(await this.executeIterator(command, options));
+  }
+  /**
+   * Asynchronously executes the query on an idle connection and returns an iterator that points to the first result in the result set.
+   * @param command - SQL command to execute
+   * @param options - optional options object of type {@link IExecuteOptions | IExecuteOptions}
+   *
+   * @remarks
+   * When all connections are busy the query waits for one to be returned, {@link IExecuteOptions.timeoutMs | timeoutMs} includes that time.
+   */
+  public async executeIterator<T>(command: string, options?: IExecuteOptions): Promise<ResultIterator<T>> {
+    const requestId = nextRequestId();
+    return executeCancellable(
+      () => this.connectionPoolBinding.execute<T>(command, options, requestId),
+      () => this.connectionPoolBinding.interrupt(requestId),
+      options,
+    );
+  }
+  /**
+   * Like {@link Connection.exportTo | Connection.exportTo}, on an idle connection.
+   * @param command - SQL command to execute
+   * @param options - options object of type {@link IExportOptions | IExportOptions}
+   */
+  public async exportTo(command: string, options: IExportOptions): Promise<number> {
+    return exportResult((query, executeOptions) => this.executeIterator(query, executeOptions), command, options);
+  }
+  /**
+   * Closes the idle connections and rejects the queries waiting for one. Connections in use are closed once their results are read or closed.
+   */
+  public close(): void {
+    return this.connectionPoolBinding.close();
+  }
+  /**
+   * If the pool is closed returns true, otherwise false.
+   */
+  public get isClosed(): boolean {
+    return this.connectionPoolBinding.isClosed;
+  }
+  /**
+   * Number of connections in the pool.
+   */
+  public get size(): number {
+    return this.connectionPoolBinding.size;
+  }
+  /**
+   * Number of connections that are not running a query or streaming a result.
+   */
+  public get idleCount(): number {
+    return this.connectionPoolBinding.idleCount;
+  }
+  /**
+   * Number of queries waiting for a connection.
+   */
+  public get waitingCount(): number {
+    return this.connectionPoolBinding.waitingCount;
+  }
+}
@@ -1,11 +1,40 @@
 import { Readable } from "stream";
 
-import { ConnectionBinding } from "@addon-bindings";
-import { IExecuteOptions } from "@addon-types";
+import { ConnectionBinding, ConnectionClass } from "@addon-bindings";
+import {
+  IExecuteBatchOptions,
+  IExecuteOptions,
+  IExportOptions,
+  ITableColumn,
+  QueryParameter,
+  ScalarFunction,
+} from "@addon-types";
 
+import { Appender } from "./appender";
 import { DuckDB } from "./duckdb";
+import { exportResult } from "./export";
+import { PreparedStatement } from "./prepared-statement";
+import { executeCancellable, nextRequestId } from "./query-cancellation";
 import { ResultIterator } from "./result-iterator";
-import { getResultStream } from "./result-stream";
+import { getArrowStream, getChunkStream, getResultStream } from "./result-stream";
+
+// rows appended by registerTable before they are handed to the appender at once
+const tableBatchSize = 1024;
+
+/**
+ * Outcome of {@link Connection.executeBatch | Connection.executeBatch}
+ * @public
+ */
+export interface IBatchResult<T> {
+  /**
+   * Per statement, the number of rows changed by `INSERT`, `UPDATE`, `DELETE` and `COPY` or the number of rows returned by any other statement
+   */
+  rowCounts: number[];
+  /**
+   * Materialized result of the last statement
+   */
+  result: ResultIterator<T>;
+}
 
 /**
  * Represents a DuckDB connection.
@@ -68,8 +97,46 @@ export class Connection {
    * ```
    */
   public async execute<T>(command: string, options?: IExecuteOptions): Promise<Readable> {
-    const resultIteratorBinding = await this.connectionBinding.execute<T>(command, options);
-    return getResultStream(new ResultIterator(resultIteratorBinding));
+    return getResultStream(await this.executeIterator<T>(command, options));
+  }
+  /**
+   * Asynchronously executes the query and returns a {@link https://nodejs.org/api/stream.html#stream_class_stream_readable | Readable stream} of {@link IColumnarChunk | columnar chunks}.
+   * @param command - SQL command to execute
+   * @param options - optional options object of type {@link IExecuteOptions | IExecuteOptions}, `rowResultFormat` is ignored
+   *
+   * @example
+   * Summing up a column without creating a JS object per row:
+   * ```ts
+   * const chunkStream = await connection.executeColumnar("SELECT price FROM sales;");
+   * let total = 0;
+   * for await (const chunk of chunkStream) {
+   *   chunk.columns[0].data.forEach(price => (total += price));
+   * }
+   * ```
+   */
+  public async executeColumnar(command: string, options?: IExecuteOptions): Promise<Readable> {
+    return getChunkStream(await this.executeIterator(command, options));
+  }
+  /**
+   * Asynchronously executes the query and returns a {@link https://nodejs.org/api/stream.html#stream_class_stream_readable | Readable stream} of the result encoded in the {@link https://arrow.apache.org/docs/format/Columnar.html#ipc-streaming-format | Arrow IPC streaming format}.
+   * @param command - SQL command to execute
+   * @param options - optional options object of type {@link IExecuteOptions | IExecuteOptions}, `rowResultFormat` is ignored
+   *
+   * @remarks
+   * See {@link ResultIterator.fetchArrowBatch | ResultIterator.fetchArrowBatch} for how DuckDB types are encoded.
+   *
+   * @example
+   * Reading a result with `apache-arrow`:
+   * ```ts
+   * import { RecordBatchReader } from "apache-arrow";
+   * const arrowStream = await connection.executeArrow("SELECT * FROM people;");
+   * for await (const batch of await RecordBatchReader.from(arrowStream)) {
+   *   console.log(batch.numRows);
+   * }
+   * ```
+   */
+  public async executeArrow(command: string, options?: IExecuteOptions): Promise<Readable> {
+    return getArrowStream(await this.executeIterator(command, options));
   }
   /**
    * Asynchronously executes the query and returns an iterator that points to the first result in the result set.
@@ -108,16 +175,194 @@ export class Connection {
    * ```
    */
   public async executeIterator<T>(command: string, options?: IExecuteOptions): Promise<ResultIterator<T>> {
-    return new ResultIterator(await this.connectionBinding.execute<T>(command, options));
+    const requestId = nextRequestId();
+    return executeCancellable(
+      () => this.connectionBinding.execute<T>(command, options, requestId),
+      () => this.connectionBinding.interrupt(requestId),
+      options,
+    );
+  }
+  /**
+   * Asynchronously executes several statements back to back on one worker thread and returns their row counts and the result of the last one.
+   * @param statements - a script of semicolon separated SQL statements or an array of them
+   * @param options - optional options object of type {@link IExecuteBatchOptions | IExecuteBatchOptions}
+   *
+   * @remarks
+   * The batch costs a single round trip to the worker thread instead of one per statement. It stops at the first failing statement,
+   * the error it is rejected with has a `statementIndex` property pointing at that statement.
+   *
+   * @example
+   * Loading a table in one transaction:
+   * ```ts
+   * const { rowCounts } = await connection.executeBatch(
+   *   ["CREATE TABLE people(id INTEGER, name VARCHAR);", "INSERT INTO people VALUES (1, 'Mark'), (2, 'Hannes');"],
+   *   { transaction: true },
+   * );
+   * // rowCounts: [0, 2]
+   * ```
+   */
+  public async executeBatch<T>(
+    statements: string | string[],
+    options?: IExecuteBatchOptions,
+  ): Promise<IBatchResult<T>> {
+    let rowCounts: number[] = [];
+    const requestId = nextRequestId();
+    const result = await executeCancellable(
+      async () => {
+        const batch = await this.connectionBinding.executeBatch<T>(statements, options, requestId);
+        rowCounts = batch.rowCounts;
+        return batch.result;
+      },
+      () => this.connectionBinding.interrupt(requestId),
+      options,
+    );
+    return { rowCounts, result };
+  }
+  /**
+   * Asynchronously executes the query and writes its result to a file or stream, resolving with the number of rows written.
+   * @param command - SQL command to execute
+   * @param options - options object of type {@link IExportOptions | IExportOptions}
+   *
+   * @remarks
+   * Rows are encoded on a worker thread, chunk by chunk, without creating JS values for them. When exporting to a `path` the bytes
+   * are written to the file on the worker thread as well, a `writable` receives them in batches of about 1MB.
+   *
+   * @example
+   * Exporting a table:
+   * ```ts
+   * await connection.exportTo("SELECT * FROM people;", { format: "csv", path: "people.csv" });
+   * await connection.exportTo("SELECT * FROM people;", { format: "ndjson", writable: createGzip().pipe(createWriteStream("people.ndjson.gz")) });
+   * ```
+   */
+  public async exportTo(command: string, options: IExportOptions): Promise<number> {
+    return exportResult((query, executeOptions) => this.executeIterator(query, executeOptions), command, options);
+  }
+  /**
+   * Asynchronously parses, binds and plans the query once and returns a {@link PreparedStatement | PreparedStatement} that can be executed many times.
+   * @param command - SQL command to prepare, parameters are marked with `?`
+   *
+   * @example
+   * Inserting rows without building SQL strings:
+   * ```ts
+   * const insert = await connection.prepare("INSERT INTO people VALUES (?, ?);");
+   * await insert.executeIterator([1, "Mark"]);
+   * await insert.executeIterator([2, "Hannes"]);
+   * insert.close();
+   * ```
+   */
+  public async prepare(command: string): Promise<PreparedStatement> {
+    const preparedStatementBinding = await this.connectionBinding.prepare(command);
+    return new PreparedStatement(preparedStatementBinding, requestId => this.connectionBinding.interrupt(requestId));
+  }
+  /**
+   * Asynchronously registers a JS function that SQL run on this connection can call like a built-in scalar function.
+   * @param name - name to call the function by
+   * @param argumentTypes - DuckDB types of the arguments, e.g. `["VARCHAR", "INTEGER"]`
+   * @param returnType - DuckDB type of the result
+   * @param fn - the {@link ScalarFunction | function}, called with whole columns rather than row by row
+   *
+   * @remarks
+   * DuckDB calls the function from the thread running the query, the call is forwarded to the JS thread, which the query waits for.
+   * A synchronous fetch would block the JS thread the query needs, so streaming results of queries calling a JS function can't be
+   * fetched synchronously while an asynchronous fetch is in progress, nor at all when the database runs queries on several
+   * {@link IDuckDBOptionsConfig.threads | threads}: read them asynchronously (streams, `for await` or
+   * {@link ResultIterator.fetchChunkAsync | fetchChunkAsync}) or with `forceMaterialized`.
+   *
+   * @example
+   * ```ts
+   * await connection.registerFunction("host_of", ["VARCHAR"], "VARCHAR", (urls: unknown[]) =>
+   *   urls.map(url => (url === null ? null : new URL(<string>url).host)),
+   * );
+   * const result = await connection.executeIterator("SELECT host_of(url) AS host FROM pages;");
+   * ```
+   */
+  public registerFunction(
+    name: string,
+    argumentTypes: string[],
+    returnType: string,
+    fn: ScalarFunction,
+  ): Promise<void> {
+    return this.connectionBinding.registerFunction(name, argumentTypes, returnType, fn);
+  }
+  /**
+   * Asynchronously loads rows from a JS iterable or async iterable into a temporary table that SQL run on this connection can query,
+   * resolving with the number of rows loaded.
+   * @param name - name of the temporary table, it must not exist yet
+   * @param columns - {@link ITableColumn | columns} of the table
+   * @param rows - rows, each an array with one value per column
+   *
+   * @remarks
+   * This is not a table function: the rows are copied into the table with an {@link Appender | Appender} as they are produced,
+   * reading the source once. Only the current batch of rows is held in JS, while the table keeps all rows until it is dropped or
+   * the connection is closed. When the source throws the table is dropped and the promise rejects with that error.
+   *
+   * @example
+   * ```ts
+   * await connection.registerTable("crawled", [{ name: "url", type: "VARCHAR" }], crawler.pages());
+   * const result = await connection.executeIterator("SELECT count(*) FROM crawled;");
+   * ```
+   */
+  public async registerTable(
+    name: string,
+    columns: ITableColumn[],
+    rows: Iterable<QueryParameter[]> | AsyncIterable<QueryParameter[]>,
+  ): Promise<number> {
+    const quote = (identifier: string) => `"${identifier.replace(/"/g, '""')}"`;
+    const columnDefinitions = columns.map(column => `${quote(column.name)} ${column.type}`).join(", ");
+    await this.executeIterator(`CREATE TEMPORARY TABLE ${quote(name)} (${columnDefinitions})`);
+    let batch: QueryParameter[][] = [];
+    let rowCount = 0;
+    try {
+      const appender = await Appender.open(this, name, "temp");
+      try {
+        // eslint-disable-next-line no-loops/no-loops
+        for await (const row of rows) {
+          batch.push(row);
+          if (batch.length === tableBatchSize) {
+            appender.appendRows(batch);
+            rowCount += batch.length;
+            batch = [];
+          }
+        }
+        appender.appendRows(batch);
+        rowCount += batch.length;
+      } finally {
+        await appender.close();
+      }
+    } catch (error) {
+      // a partially loaded table is not left behind
+      await this.executeIterator(`DROP TABLE IF EXISTS temp.${quote(name)}`);
+      throw error;
+    }
+    return rowCount;
+  }
+  /**
+   * Cancels the query that is running on this connection and the ones that were issued on it before and are waiting to run.
+   * They are rejected with a {@link QueryCancelledError | QueryCancelledError}.
+   *
+   * @remarks
+   * To cancel a specific query use the {@link IExecuteOptions.timeoutMs | timeoutMs} or {@link IExecuteOptions.signal | signal} options.
+   */
+  public interrupt(): void {
+    return this.connectionBinding.interrupt();
   }
   /**
    * Close the connection (also closes all {@link https://nodejs.org/api/stream.html#stream_class_stream_readable | Readable} or {@link ResultIterator | ResultIterator} objects associated with this connection).
    * @remarks
+   * Closing the results frees their native memory right away, even when their JS objects are still referenced.
+   *
    * Even though GC will automatically destroy the Connection object at some point, DuckDB data is stored in the native address space, not the V8 heap, meaning you can easily have a Node.js process taking gigabytes of memory (more than the default heap size for Node.js) with V8 not triggering GC. So, definitely think about manually calling `close()`.
    */
   public close(): void {
     return this.connectionBinding.close();
   }
+  /**
+   * Returns underlying binding instance.
+   * @internal
+   */
+  public get binding(): ConnectionClass {
+    return this.connectionBinding;
+  }
   /**
    * If the connection is closed returns true, otherwise false.
    */
@@ -2,7 +2,7 @@ import { promises as fs } from "fs";
 import { join } from "path";
 
 import { DuckDBBinding, DuckDBClass } from "@addon-bindings";
-import { IDuckDBConfig, AccessMode, OrderType, OrderByNullType } from "@addon-types";
+import { IDuckDBConfig, AccessMode, OrderType, OrderByNullType, IResultCacheStats } from "@addon-types";
 
 /**
  * The DuckDB class represents a DuckDB database instance.
@@ -20,6 +20,25 @@ export class DuckDB {
   public static async getBindingsVersion(): Promise<string> {
     return JSON.parse(await fs.readFile(join(__dirname, "../../package.json"), { encoding: "utf-8" })).version;
   }
+  /**
+   * Opens a database like the {@link DuckDB.constructor | constructor}, but on a native thread rather than the event loop.
+   *
+   * @remarks
+   * Opening a large database file replays its write ahead log first, which may take seconds.
+   *
+   * @example
+   * ```ts
+   * import { DuckDB } from "node-duckdb";
+   * const db = await DuckDB.open({ path: join(__dirname, "./mydb") });
+   * ```
+   * @public
+   */
+  public static async open(config: IDuckDBConfig = {}): Promise<DuckDB> {
+    // skips the constructor, which would open the database synchronously
+    const db: DuckDB = Object.create(DuckDB.prototype);
+    db.duckdb = await DuckDBBinding.open(config);
+    return db;
+  }
   private duckdb: DuckDBClass;
   /**
    * Represents a native instance of DuckDB.
@@ -61,6 +80,58 @@ export class DuckDB {
   public close(): void {
     return this.duckdb.close();
   }
+  /**
+   * Closes the database like {@link DuckDB.close | close}, but shuts it down on a native thread rather than the event loop.
+   * The promise resolves once the database is shut down, unless connections or databases opened by handle still keep it open.
+   * @public
+   */
+  public closeAsync(): Promise<void> {
+    return this.duckdb.closeAsync();
+  }
+  /**
+   * Asynchronously writes the changes in the write ahead log to the database file and truncates the log,
+   * so that it doesn't have to be replayed when the database is opened next.
+   *
+   * @remarks
+   * Fails while other connections have transactions open.
+   * @public
+   */
+  public checkpoint(): Promise<void> {
+    return this.duckdb.checkpoint();
+  }
+  /**
+   * Returns a handle other worker threads can open this database with, see {@link IDuckDBConfig.handle | IDuckDBConfig.handle}.
+   *
+   * @remarks
+   * All threads then share one database instance (including its in-memory tables and memory limit), while each runs its queries on its own
+   * {@link IDuckDBOptionsConfig.queryThreadPoolSize | query threads}. The handle doesn't keep the database open: it can be opened by handle as long
+   * as a `DuckDB` object using it in any thread is not closed. Connections that are still open keep working once all `DuckDB` objects
+   * are closed, but don't keep the handle valid.
+   *
+   * @example
+   * Reading a table from a worker thread:
+   * ```ts
+   * import { Worker } from "worker_threads";
+   * const db = new DuckDB();
+   * const worker = new Worker("./worker.js", { workerData: { handle: db.exportHandle() } });
+   * // worker.js
+   * const { workerData } = require("worker_threads");
+   * const db = new DuckDB({ handle: workerData.handle });
+   * const connection = new Connection(db);
+   * ```
+   * @public
+   */
+  public exportHandle(): string {
+    return this.duckdb.exportHandle();
+  }
+  /**
+   * Empties the result cache, see {@link IDuckDBOptionsConfig.resultCacheSize | resultCacheSize}.
+   * Only needed when the data changed outside of this process, changes made through the database empty the cache already.
+   * @public
+   */
+  public clearResultCache(): void {
+    return this.duckdb.clearResultCache();
+  }
   /**
    * Returns underlying binding instance.
    * @internal
@@ -131,4 +202,26 @@ export class DuckDB {
   public get defaultNullOrder(): OrderByNullType {
     return this.duckdb.defaultNullOrder;
   }
+  /**
+   * Returns the number of threads DuckDB uses to execute a single query.
+   * @public
+   */
+  public get threads(): number {
+    return this.duckdb.threads;
+  }
+  /**
+   * Returns the number of native threads that run the queries of this database.
+   * @public
+   */
+  public get queryThreadPoolSize(): number {
+    return this.duckdb.queryThreadPoolSize;
+  }
+  /**
+   * Returns the hit, miss and eviction counters of the result cache, or null if the database has none,
+   * see {@link IDuckDBOptionsConfig.resultCacheSize | resultCacheSize}.
+   * @public
+   */
+  public get resultCacheStats(): IResultCacheStats | null {
+    return this.duckdb.resultCacheStats;
+  }
 }
@@ -0,0 +1,60 @@
+import { pipeline } from "stream";
+import { promisify } from "util";
+
+import { IExecuteOptions, IExportOptions, RowResultFormat } from "@addon-types";
+
+import { ResultIterator } from "./result-iterator";
+import { getTextStream } from "./result-stream";
+
+const pipelineAsync = promisify(pipeline);
+
+type Execute = (command: string, options: IExecuteOptions) => Promise<ResultIterator<unknown>>;
+
+function escapeString(value: string): string {
+  return `'${value.replace(/'/g, "''")}'`;
+}
+
+/**
+ * Runs the export of {@link Connection.exportTo | Connection.exportTo} and {@link ConnectionPool.exportTo | ConnectionPool.exportTo}
+ * and resolves with the number of rows written.
+ * @internal
+ */
+export async function exportResult(execute: Execute, command: string, options: IExportOptions): Promise<number> {
+  const { format, path, writable, timeoutMs, signal } = options;
+  if (format !== "csv" && format !== "ndjson" && format !== "parquet") {
+    throw new TypeError("Invalid format: must be csv, ndjson or parquet");
+  }
+  if ((path === undefined) === (writable === undefined)) {
+    throw new TypeError("Exactly one of path and writable must be given");
+  }
+  if (format === "parquet") {
+    if (path === undefined) {
+      throw new TypeError("Parquet can only be exported to a path");
+    }
+    // the query becomes a subquery, so it must not end with a semicolon
+    const query = command.trim().replace(/;+$/, "");
+    const result = await execute(`COPY (${query}) TO ${escapeString(path)} (FORMAT PARQUET)`, {
+      forceMaterialized: true,
+      rowResultFormat: RowResultFormat.Array,
+      timeoutMs,
+      signal,
+    });
+    try {
+      return Number((<bigint[]>result.fetchRow())[0]);
+    } finally {
+      result.close();
+    }
+  }
+  const result = await execute(command, { timeoutMs, signal });
+  // closing disarms the timeout and hands a pooled connection back even if writing fails
+  try {
+    if (path !== undefined) {
+      await result.writeTextFile(format, path);
+    } else {
+      await pipelineAsync(getTextStream(result, format), <NodeJS.WritableStream>writable);
+    }
+    return result.metrics.rowsEmitted;
+  } finally {
+    result.close();
+  }
+}
@@ -1,3 +1,7 @@
 export { DuckDB } from "./duckdb";
 export { ResultIterator } from "./result-iterator";
-export { Connection } from "./connection";
+export { Connection, IBatchResult } from "./connection";
+export { ConnectionPool } from "./connection-pool";
+export { PreparedStatement } from "./prepared-statement";
+export { Appender } from "./appender";
+export { QueryCancelledError, CancellationReason } from "./query-cancellation";
@@ -0,0 +1,78 @@
+import { Readable } from "stream";
+
+import { PreparedStatementClass } from "@addon-bindings";
+import { IExecuteOptions, QueryParameter } from "@addon-types";
+
+import { executeCancellable, nextRequestId } from "./query-cancellation";
+import { ResultIterator } from "./result-iterator";
+import { getResultStream } from "./result-stream";
+
+/**
+ * Represents a statement that was parsed, bound and planned once and can be executed many times with different parameters.
+ * Instances of this class are returned by {@link Connection.prepare | Connection.prepare}.
+ *
+ * @remarks
+ * Parameters are passed to DuckDB as values, so there is no need to (and you must not) escape them into the SQL string.
+ *
+ * @public
+ */
+export class PreparedStatement {
+  /**
+   *
+   * @internal
+   */
+  constructor(
+    private preparedStatementBinding: PreparedStatementClass,
+    private interrupt: (requestId: number) => void,
+  ) {}
+  /**
+   * Asynchronously executes the statement and returns a {@link https://nodejs.org/api/stream.html#stream_class_stream_readable | Readable stream} that wraps the result set.
+   * @param parameters - values of the statement's parameters, in order, see {@link QueryParameter | QueryParameter}
+   * @param options - optional options object of type {@link IExecuteOptions | IExecuteOptions}
+   */
+  public async execute<T>(parameters?: QueryParameter[], options?: IExecuteOptions): Promise<Readable> {
+    return getResultStream(await this.executeIterator<T>(parameters, options));
+  }
+  /**
+   * Asynchronously executes the statement and returns an iterator that points to the first result in the result set.
+   * @param parameters - values of the statement's parameters, in order, see {@link QueryParameter | QueryParameter}
+   * @param options - optional options object of type {@link IExecuteOptions | IExecuteOptions}
+   *
+   * @example
+   * Looking up rows by id:
+   * ```ts
+   * const statement = await connection.prepare("SELECT * FROM people WHERE id = ?;");
+   * for (const id of [1, 2, 3]) {
+   *   const result = await statement.executeIterator([id]);
+   *   console.log(result.fetchAllRows());
+   * }
+   * statement.close();
+   * ```
+   */
+  public async executeIterator<T>(parameters?: QueryParameter[], options?: IExecuteOptions): Promise<ResultIterator<T>> {
+    const requestId = nextRequestId();
+    return executeCancellable(
+      () => this.preparedStatementBinding.execute<T>(parameters, options, requestId),
+      () => this.interrupt(requestId),
+      options,
+    );
+  }
+  /**
+   * Number of parameters the statement expects
+   */
+  public get parameterCount(): number {
+    return this.preparedStatementBinding.parameterCount;
+  }
+  /**
+   * Release the native statement
+   */
+  public close(): void {
+    return this.preparedStatementBinding.close();
+  }
+  /**
+   * If the statement is closed returns true, otherwise false.
+   */
+  public get isClosed(): boolean {
+    return this.preparedStatementBinding.isClosed;
+  }
+}
@@ -0,0 +1,134 @@
+import { ResultIteratorClass } from "@addon-bindings";
+import { IExecuteOptions, ResultType } from "@addon-types";
+
+import { ResultIterator } from "./result-iterator";
+
+// set natively on errors of queries stopped by an interrupt
+const interruptedErrorCode = "ERR_DUCKDB_INTERRUPTED";
+
+// request ids are 32 bit unsigned natively, 0 is never used
+const maxRequestId = 0xffffffff;
+let lastRequestId = 0;
+
+/**
+ * Id that the native side knows a query by, so that the query can be cancelled on its own
+ * @internal
+ */
+export function nextRequestId(): number {
+  lastRequestId = (lastRequestId % maxRequestId) + 1;
+  return lastRequestId;
+}
+
+/**
+ * Why a query was cancelled
+ * @public
+ */
+export type CancellationReason = "timeout" | "abort" | "interrupt";
+
+/**
+ * Error a query is rejected with when it is cancelled by {@link IExecuteOptions.timeoutMs | timeoutMs}, {@link IExecuteOptions.signal | signal}
+ * or {@link Connection.interrupt | Connection.interrupt}
+ * @public
+ */
+export class QueryCancelledError extends Error {
+  public readonly code = "ERR_DUCKDB_QUERY_CANCELLED";
+  constructor(public readonly reason: CancellationReason) {
+    super(`Query cancelled: ${reason}`);
+    this.name = "QueryCancelledError";
+  }
+}
+
+/**
+ * Tracks the timeout and abort signal of a single query, cancelling only that query when either fires.
+ * It stays active until a streaming result is fully read or closed, and ends with the query for a materialized result.
+ * @internal
+ */
+export class QueryCancellation {
+  private cancelReason?: CancellationReason;
+  private timer?: NodeJS.Timeout;
+  private cancelListeners: (() => void)[] = [];
+  private readonly onAbort = () => this.cancel("abort");
+
+  constructor(private interrupt: () => void, private options?: IExecuteOptions) {
+    if (options?.signal?.aborted) {
+      this.cancelReason = "abort";
+      return;
+    }
+    options?.signal?.addEventListener("abort", this.onAbort);
+    if (options?.timeoutMs !== undefined) {
+      this.timer = setTimeout(() => this.cancel("timeout"), options.timeoutMs);
+    }
+  }
+
+  public get isCancelled(): boolean {
+    return this.cancelReason !== undefined;
+  }
+
+  public onCancel(listener: () => void): void {
+    this.cancelListeners.push(listener);
+  }
+
+  public throwIfCancelled(): void {
+    if (this.cancelReason !== undefined) {
+      throw new QueryCancelledError(this.cancelReason);
+    }
+  }
+
+  /**
+   * Maps errors caused by the cancellation (or by a manual interrupt) to a {@link QueryCancelledError | QueryCancelledError}
+   */
+  public toError(error: Error & { code?: string }): Error {
+    if (this.cancelReason !== undefined) {
+      return new QueryCancelledError(this.cancelReason);
+    }
+    if (error.code === interruptedErrorCode) {
+      return new QueryCancelledError("interrupt");
+    }
+    return error;
+  }
+
+  public dispose(): void {
+    if (this.timer !== undefined) {
+      clearTimeout(this.timer);
+      this.timer = undefined;
+    }
+    this.options?.signal?.removeEventListener("abort", this.onAbort);
+    this.cancelListeners = [];
+  }
+
+  private cancel(reason: CancellationReason): void {
+    if (this.cancelReason !== undefined) {
+      return;
+    }
+    this.cancelReason = reason;
+    this.interrupt();
+    this.cancelListeners.forEach(listener => listener());
+    this.dispose();
+  }
+}
+
+/**
+ * Runs the native execute with the timeout and abort signal of the options applied
+ * @internal
+ */
+export async function executeCancellable<T>(
+  execute: () => Promise<ResultIteratorClass<T>>,
+  interrupt: () => void,
+  options?: IExecuteOptions,
+): Promise<ResultIterator<T>> {
+  const cancellation = new QueryCancellation(interrupt, options);
+  try {
+    cancellation.throwIfCancelled();
+    const resultIterator = new ResultIterator(await execute(), cancellation);
+    // cancelled after the query finished but before the promise was resolved
+    cancellation.throwIfCancelled();
+    // nothing is left to cancel once a result is materialized
+    if (resultIterator.type === ResultType.Materialized) {
+      cancellation.dispose();
+    }
+    return resultIterator;
+  } catch (error) {
+    cancellation.dispose();
+    throw cancellation.toError(error);
+  }
+}
@@ -1,17 +1,58 @@
 import { ResultIteratorClass } from "@addon-bindings";
-import { ResultType } from "@addon-types";
+import { IColumnarChunk, IQueryMetrics, IQueryProfile, ResultType } from "@addon-types";
+
+import type { QueryCancellation } from "./query-cancellation";
+
+// the rows of a DuckDB data chunk, rows are converted this many at a time when iterating
+const rowsPerBatch = 1024;
+
+function batchesToAsyncIterator<E>(
+  fetchBatch: () => Promise<E[] | null>,
+  close: () => void,
+): AsyncIterableIterator<E> {
+  let batch: E[] = [];
+  let index = 0;
+  const iterator: AsyncIterableIterator<E> = {
+    next: async () => {
+      if (index < batch.length) {
+        const value = batch[index];
+        index += 1;
+        return { value, done: false };
+      }
+      const nextBatch = await fetchBatch();
+      if (nextBatch === null) {
+        return <IteratorReturnResult<E>>{ done: true };
+      }
+      batch = nextBatch;
+      index = 0;
+      return iterator.next();
+    },
+    // called when the consumer stops early, e.g. `break` in `for await` or a destroyed stream
+    return: async () => {
+      close();
+      return <IteratorReturnResult<E>>{ done: true };
+    },
+    [Symbol.asyncIterator]: () => iterator,
+  };
+  return iterator;
+}
 
 /**
  * ResultIterator represents the result set of a DuckDB query. Instances of this class are returned by the {@link Connection.executeIterator | Connection.executeIterator}.
  *
  * @public
  */
-export class ResultIterator<T> implements IterableIterator<T> {
+export class ResultIterator<T> implements IterableIterator<T>, AsyncIterable<T> {
+  // rows converted by a batch fetch that the iterator protocol has not returned yet
+  private bufferedRows: T[] = [];
+  private bufferedIndex = 0;
   /**
    *
    * @internal
    */
-  constructor(private resultInterator: ResultIteratorClass<T>) {}
+  constructor(private resultInterator: ResultIteratorClass<T>, private cancellation?: QueryCancellation) {
+    cancellation?.onCancel(() => resultInterator.close());
+  }
   /**
    * Fetch the next row
    *
@@ -19,7 +60,134 @@ export class ResultIterator<T> implements IterableIterator<T> {
    * First call returns the first row, when no more rows left `null` is returned.
    */
   public fetchRow(): T {
-    return this.resultInterator.fetchRow();
+    if (this.bufferedIndex < this.bufferedRows.length) {
+      return this.takeBufferedRows(1)[0];
+    }
+    try {
+      return this.settleIfDone(this.resultInterator.fetchRow());
+    } catch (error) {
+      throw this.toError(error);
+    }
+  }
+  /**
+   * Fetch up to `maxRows` rows at once
+   *
+   * @remarks
+   * Rows are converted natively across as many DuckDB data chunks as needed and returned in a single array, which avoids the
+   * per row call overhead of {@link ResultIterator.fetchRow | fetchRow}. Fewer rows are only returned at the end of the result set,
+   * after which `null` is returned.
+   */
+  public fetchRows(maxRows: number = rowsPerBatch): T[] | null {
+    if (this.bufferedIndex < this.bufferedRows.length) {
+      return this.takeBufferedRows(maxRows);
+    }
+    try {
+      return this.settleIfDone(this.resultInterator.fetchRows(maxRows));
+    } catch (error) {
+      throw this.toError(error);
+    }
+  }
+  /**
+   * Fetch the next batch of rows in columnar form
+   *
+   * @remarks
+   * Returns the rows of the current DuckDB data chunk that have not been read yet (by {@link ResultIterator.fetchRow | fetchRow} or a previous call), or the whole next chunk.
+   * Numeric columns are copied into typed arrays once per chunk instead of creating a JS value per cell. When no more rows left `null` is returned.
+   */
+  public fetchChunk(): IColumnarChunk | null {
+    try {
+      this.checkNoBufferedRows();
+      return this.settleIfDone(this.resultInterator.fetchChunk());
+    } catch (error) {
+      throw this.toError(error);
+    }
+  }
+  /**
+   * Returns an iterable over the remaining {@link IColumnarChunk | chunks} of the result set.
+   */
+  public chunks(): IterableIterator<IColumnarChunk> {
+    const chunkIterator: IterableIterator<IColumnarChunk> = {
+      next: () => {
+        const chunk = this.fetchChunk();
+        if (chunk === null) {
+          return <IteratorReturnResult<IColumnarChunk>>{ done: true };
+        }
+        return { value: chunk, done: false };
+      },
+      [Symbol.iterator]: () => chunkIterator,
+    };
+    return chunkIterator;
+  }
+  /**
+   * Asynchronously fetch the next batch of rows in columnar form
+   *
+   * @remarks
+   * Same as {@link ResultIterator.fetchChunk | fetchChunk}, except that chunks are pulled from DuckDB on a worker thread, so the event loop is not blocked while a streaming query produces them.
+   * Up to {@link IExecuteOptions.prefetchChunkCount | prefetchChunkCount} chunks are fetched ahead while the current one is being consumed.
+   */
+  public async fetchChunkAsync(): Promise<IColumnarChunk | null> {
+    this.checkNoBufferedRows();
+    return this.resultInterator.fetchChunkAsync().then(this.settleIfDone, this.rejectWithError);
+  }
+  /**
+   * Returns an async iterable over the remaining {@link IColumnarChunk | chunks} of the result set, fetched with {@link ResultIterator.fetchChunkAsync | fetchChunkAsync}.
+   */
+  public chunksAsync(): AsyncIterableIterator<IColumnarChunk> {
+    return batchesToAsyncIterator(
+      async () => {
+        const chunk = await this.fetchChunkAsync();
+        return chunk === null ? null : [chunk];
+      },
+      () => this.close(),
+    );
+  }
+  /**
+   * Asynchronously fetch the next chunk of the result set encoded as an {@link https://arrow.apache.org/docs/format/Columnar.html#ipc-streaming-format | Arrow IPC stream} record batch
+   *
+   * @remarks
+   * The first batch is preceded by the schema message, so the batches concatenated in order form a complete IPC stream.
+   * Encoding runs on a worker thread and the returned Buffer points to the natively encoded bytes, there is no further copy.
+   * When no more rows left `null` is returned. Columns without an Arrow counterpart (e.g. INTERVAL, LIST) are encoded as strings.
+   *
+   * @example
+   * Reading a result into an `apache-arrow` table:
+   * ```ts
+   * import { Table } from "apache-arrow";
+   * const result = await connection.executeIterator("SELECT * FROM people;");
+   * const table = await Table.from(result.arrowBatches());
+   * ```
+   */
+  public async fetchArrowBatch(): Promise<Buffer | null> {
+    this.checkNoBufferedRows();
+    return this.resultInterator.fetchArrowBatch().then(this.settleIfDone, this.rejectWithError);
+  }
+  /**
+   * Asynchronously fetch the next rows encoded as CSV (the first batch starts with the header line) or NDJSON, `null` when no more rows left
+   * @internal
+   */
+  public async fetchTextBatch(format: "csv" | "ndjson"): Promise<Buffer | null> {
+    this.checkNoBufferedRows();
+    return this.resultInterator.fetchTextBatch(format).then(this.settleIfDone, this.rejectWithError);
+  }
+  /**
+   * Asynchronously write the remaining rows encoded as CSV or NDJSON to a file
+   * @internal
+   */
+  public async writeTextFile(format: "csv" | "ndjson", path: string): Promise<void> {
+    this.checkNoBufferedRows();
+    await this.resultInterator.writeTextFile(format, path).then(this.settleIfDone, this.rejectWithError);
+  }
+  /**
+   * Returns an async iterable over the remaining result set as Arrow IPC stream batches, see {@link ResultIterator.fetchArrowBatch | fetchArrowBatch}.
+   */
+  public arrowBatches(): AsyncIterableIterator<Buffer> {
+    return batchesToAsyncIterator(
+      async () => {
+        const batch = await this.fetchArrowBatch();
+        return batch === null ? null : [batch];
+      },
+      () => this.close(),
+    );
   }
   /**
    * Fetch all rows
@@ -28,7 +196,9 @@ export class ResultIterator<T> implements IterableIterator<T> {
    * Note, this may produce a `heap out of bounds` error in case when there is too much data. Either use the {@link ResultIterator.fetchRow | fetchRow} or the  {@link Connection.execute | Connection.execute} method when there is a lot of data.
    */
   public fetchAllRows(): T[] {
-    return <T[]>[...this];
+    const buffered = this.takeBufferedRows(Infinity);
+    const rows = this.fetchRows(Infinity);
+    return rows === null ? buffered : buffered.concat(rows);
   }
   /**
    * Describe the result set schema.
@@ -42,6 +212,7 @@ export class ResultIterator<T> implements IterableIterator<T> {
    * {@link Connection.close | Connection.close} automatically closes all associated ResultIterators.
    */
   public close(): void {
+    this.cancellation?.dispose();
     return this.resultInterator.close();
   }
   /**
@@ -56,13 +227,45 @@ export class ResultIterator<T> implements IterableIterator<T> {
   public get isClosed(): boolean {
     return this.resultInterator.isClosed;
   }
+  /**
+   * Timings and sizes of the query and of reading its result so far, see {@link IQueryMetrics | IQueryMetrics}.
+   */
+  public get metrics(): IQueryMetrics {
+    return this.resultInterator.metrics;
+  }
+  /**
+   * DuckDB's profile of the query when executed with the {@link IExecuteOptions.profile | profile} option, `null` otherwise.
+   *
+   * @remarks
+   * The profile of a streaming result is available once the result is fully read.
+   *
+   * @example
+   * ```ts
+   * const result = await connection.executeIterator("SELECT count(*) FROM people;", { profile: true });
+   * result.fetchAllRows();
+   * console.log(result.profile?.tree);
+   * ```
+   */
+  public get profile(): IQueryProfile | null {
+    const profile = this.resultInterator.profile;
+    return profile === null ? null : JSON.parse(profile);
+  }
 
+  /**
+   * Returns the next row, rows are fetched from DuckDB {@link ResultIterator.fetchRows | in batches} and handed out one by one
+   */
   public next(): IteratorResult<T> {
-    const row = this.fetchRow();
-    if (row === null) {
-      // TS interface is incorrect: when `done` is true, there should be no `value`
-      return <IteratorReturnResult<T>>{ done: true };
+    if (this.bufferedIndex === this.bufferedRows.length) {
+      const rows = this.fetchRows(rowsPerBatch);
+      if (rows === null) {
+        // TS interface is incorrect: when `done` is true, there should be no `value`
+        return <IteratorReturnResult<T>>{ done: true };
+      }
+      this.bufferedRows = rows;
+      this.bufferedIndex = 0;
     }
+    const row = this.bufferedRows[this.bufferedIndex];
+    this.bufferedIndex += 1;
     return {
       value: row,
       done: false,
@@ -71,4 +274,57 @@ export class ResultIterator<T> implements IterableIterator<T> {
   public [Symbol.iterator](): this {
     return this;
   }
+  /**
+   * Iterates over the remaining rows, fetching them from DuckDB on a worker thread chunk by chunk.
+   * Breaking out of the loop early closes the ResultIterator.
+   *
+   * @example
+   * ```ts
+   * const result = await connection.executeIterator("SELECT * FROM people;");
+   * for await (const row of result) {
+   *   console.log(row);
+   * }
+   * ```
+   */
+  public [Symbol.asyncIterator](): AsyncIterableIterator<T> {
+    return batchesToAsyncIterator(
+      () => this.fetchRowsAsync(),
+      () => this.close(),
+    );
+  }
+  /**
+   * Asynchronously fetch the remaining rows of the current DuckDB data chunk, or of the next one, `null` when no more rows left
+   * @internal
+   */
+  public fetchRowsAsync(): Promise<T[] | null> {
+    if (this.bufferedIndex < this.bufferedRows.length) {
+      return Promise.resolve(this.takeBufferedRows(Infinity));
+    }
+    return this.resultInterator.fetchRowsAsync().then(this.settleIfDone, this.rejectWithError);
+  }
+  private takeBufferedRows(maxRows: number): T[] {
+    const end = Math.min(this.bufferedIndex + maxRows, this.bufferedRows.length);
+    const rows = this.bufferedRows.slice(this.bufferedIndex, end);
+    this.bufferedIndex = end;
+    return rows;
+  }
+  // rows the iterator has read ahead would otherwise be skipped by the columnar and batch fetches
+  private checkNoBufferedRows(): void {
+    if (this.bufferedIndex < this.bufferedRows.length) {
+      throw new Error("Cannot fetch a chunk or batch before the rows already read by the iterator");
+    }
+  }
+  // the timeout and abort signal of the query apply until the result is fully read
+  private settleIfDone = <R>(result: R): R => {
+    if (result === null) {
+      this.cancellation?.dispose();
+    }
+    return result;
+  };
+  private toError(error: Error): Error {
+    return this.cancellation ? this.cancellation.toError(error) : error;
+  }
+  private rejectWithError = (error: Error): never => {
+    throw this.toError(error);
+  };
 }
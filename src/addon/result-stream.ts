@@ -2,10 +2,79 @@ import { Readable } from "stream";
 
 import { ResultIterator } from "./result-iterator";
 
+/**
+ * Rows are fetched a DuckDB data chunk at a time and all rows of a chunk are pushed at once, so a batch costs one native
+ * call and one promise rather than one per row. A chunk is only fetched when the stream is read, so a slow consumer
+ * applies backpressure all the way down to DuckDB (at most `highWaterMark` rows plus a chunk and the prefetched chunks
+ * are buffered).
+ */
 export function getResultStream<T>(iterator: ResultIterator<T>): Readable {
-  return Readable.from(iterator, {
-    destroy() {
+  let reading = false;
+  return new Readable({
+    objectMode: true,
+    read() {
+      if (reading) {
+        return;
+      }
+      reading = true;
+      iterator.fetchRowsAsync().then(
+        rows => {
+          reading = false;
+          if (rows === null) {
+            this.push(null);
+            return;
+          }
+          rows.forEach(row => this.push(row));
+        },
+        error => this.destroy(error),
+      );
+    },
+    destroy(error, callback) {
+      iterator.close();
+      callback(error);
+    },
+  });
+}
+
+export function getChunkStream<T>(iterator: ResultIterator<T>): Readable {
+  return Readable.from(iterator.chunksAsync(), {
+    destroy(error, callback) {
+      iterator.close();
+      callback(error);
+    },
+  });
+}
+
+/**
+ * Byte stream (not in object mode) of the result encoded in the Arrow IPC streaming format
+ */
+export function getArrowStream<T>(iterator: ResultIterator<T>): Readable {
+  return Readable.from(iterator.arrowBatches(), {
+    objectMode: false,
+    destroy(error, callback) {
+      iterator.close();
+      callback(error);
+    },
+  });
+}
+
+/**
+ * Byte stream of the result encoded as CSV or NDJSON, in batches of about 1MB
+ */
+export function getTextStream<T>(iterator: ResultIterator<T>, format: "csv" | "ndjson"): Readable {
+  async function* batches() {
+    let batch = await iterator.fetchTextBatch(format);
+    // eslint-disable-next-line no-loops/no-loops
+    while (batch !== null) {
+      yield batch;
+      batch = await iterator.fetchTextBatch(format);
+    }
+  }
+  return Readable.from(batches(), {
+    objectMode: false,
+    destroy(error, callback) {
       iterator.close();
+      callback(error);
     },
   });
 }
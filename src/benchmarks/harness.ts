@@ -0,0 +1,64 @@
+/**
+ * One measurement of the benchmark report. `metrics` holds the numbers to compare between commits, `params` describe
+ * what was measured.
+ */
+export interface IBenchmarkResult {
+  suite: string;
+  name: string;
+  params: Record<string, string | number | boolean>;
+  metrics: Record<string, number>;
+}
+
+export interface IBenchmarkOptions {
+  // rows written to the synthetic parquet file
+  rows: number;
+  // the synthetic rows are repeated this many times in the benchmark table
+  scale: number;
+  // executions timed by the latency suite
+  latencyIterations: number;
+  // minimum run time of every native conversion case
+  nativeMinTimeMs: number;
+}
+
+export const elapsedMs = (start: bigint): number => Number(process.hrtime.bigint() - start) / 1e6;
+
+export async function time<T>(run: () => Promise<T> | T): Promise<{ value: T; ms: number }> {
+  const start = process.hrtime.bigint();
+  const value = await run();
+  return { value, ms: elapsedMs(start) };
+}
+
+export function percentiles(samples: number[]): Record<string, number> {
+  const sorted = [...samples].sort((a, b) => a - b);
+  const at = (p: number) => sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+  return {
+    p50Ms: at(0.5),
+    p90Ms: at(0.9),
+    p99Ms: at(0.99),
+    maxMs: sorted[sorted.length - 1],
+    meanMs: sorted.reduce((sum, sample) => sum + sample, 0) / sorted.length,
+  };
+}
+
+// Approximate size of the data a value carries, used for bytes/sec
+export function valueBytes(value: unknown): number {
+  switch (typeof value) {
+    case "number":
+    case "bigint":
+      return 8;
+    case "boolean":
+      return 1;
+    case "string":
+      return Buffer.byteLength(value);
+    case "object":
+      if (value === null) {
+        return 0;
+      }
+      if (Buffer.isBuffer(value)) {
+        return value.length;
+      }
+      return Object.values(<Record<string, unknown>>value).reduce<number>((sum, field) => sum + valueBytes(field), 0);
+    default:
+      return 0;
+  }
+}
@@ -0,0 +1,114 @@
+/* eslint-disable no-console */
+import { execSync } from "child_process";
+import { promises as fs } from "fs";
+import { cpus } from "os";
+import { join } from "path";
+
+import { Connection, DuckDB } from "@addon";
+
+import { writeSyntheticParquetFile } from "../tests/synthetic-test-data-generator";
+
+import { IBenchmarkOptions, IBenchmarkResult } from "./harness";
+import { nativeConversionSuite } from "./native";
+import {
+  benchmarkTable,
+  concurrencySuite,
+  fetchRowSuite,
+  latencySuite,
+  mixedIoSuite,
+  preparedSuite,
+  resultTypeSuite,
+} from "./query-suites";
+
+/**
+ * Benchmarks of the result conversion and query dispatch paths, run with `yarn benchmark`.
+ *
+ * Options (all optional): --rows=N --scale=N --latency-iterations=N --native-min-time-ms=N --suites=a,b
+ * --output=path. The report is written as JSON to --output (benchmark-results.json by default) so that runs on
+ * different commits can be compared.
+ */
+
+const defaultOptions: IBenchmarkOptions = { rows: 2000, scale: 50, latencyIterations: 200, nativeMinTimeMs: 200 };
+
+function parseArgs(argv: string[]): Record<string, string> {
+  return Object.fromEntries(
+    argv
+      .filter(arg => arg.startsWith("--"))
+      .map(arg => {
+        const [name, ...value] = arg.slice(2).split("=");
+        return [name, value.join("=")];
+      }),
+  );
+}
+
+function gitCommit(): string | undefined {
+  try {
+    return execSync("git rev-parse HEAD", { stdio: ["ignore", "pipe", "ignore"] }).toString().trim();
+  } catch (e) {
+    return undefined;
+  }
+}
+
+async function createDatabase(options: IBenchmarkOptions): Promise<DuckDB> {
+  const parquetPath = join(__dirname, `../../benchmark-synth-${options.rows}.parquet`);
+  await writeSyntheticParquetFile(parquetPath, options.rows, false);
+  const db = new DuckDB({ options: { threads: 4, queryThreadPoolSize: 8 } });
+  const connection = new Connection(db);
+  // loaded once so that parquet decoding is not part of the measurements
+  await connection.executeIterator(
+    `CREATE TABLE ${benchmarkTable} AS SELECT s.* FROM parquet_scan('${parquetPath}') s, range(0, ${options.scale})`,
+  );
+  connection.close();
+  return db;
+}
+
+async function main(): Promise<void> {
+  const args = parseArgs(process.argv.slice(2));
+  const options: IBenchmarkOptions = {
+    rows: Number(args.rows ?? defaultOptions.rows),
+    scale: Number(args.scale ?? defaultOptions.scale),
+    latencyIterations: Number(args["latency-iterations"] ?? defaultOptions.latencyIterations),
+    nativeMinTimeMs: Number(args["native-min-time-ms"] ?? defaultOptions.nativeMinTimeMs),
+  };
+  const output = args.output ?? "benchmark-results.json";
+
+  const db = await createDatabase(options);
+  const suites: Record<string, () => Promise<IBenchmarkResult[]> | IBenchmarkResult[]> = {
+    "fetch-row": () => fetchRowSuite(db),
+    "result-type": () => resultTypeSuite(db),
+    concurrency: () => concurrencySuite(db),
+    "execute-latency": () => latencySuite(db, options),
+    prepared: () => preparedSuite(db, options),
+    "mixed-io": () => mixedIoSuite(),
+    "native-conversion": () => nativeConversionSuite(options),
+  };
+  const selected = args.suites ? args.suites.split(",") : Object.keys(suites);
+
+  const results: IBenchmarkResult[] = [];
+  // eslint-disable-next-line no-loops/no-loops
+  for (const name of selected) {
+    if (!suites[name]) {
+      throw new Error(`Unknown suite ${name}, expected one of ${Object.keys(suites).join(", ")}`);
+    }
+    console.error(`running ${name}`);
+    results.push(...(await suites[name]()));
+  }
+  db.close();
+
+  const report = {
+    commit: gitCommit(),
+    date: new Date().toISOString(),
+    node: process.version,
+    platform: `${process.platform} ${process.arch}`,
+    cpus: cpus().length,
+    options,
+    results,
+  };
+  await fs.writeFile(output, JSON.stringify(report, null, 2));
+  console.error(`wrote ${results.length} results to ${output}`);
+}
+
+main().catch(error => {
+  console.error(error);
+  process.exitCode = 1;
+});
@@ -0,0 +1,33 @@
+/* eslint-disable no-console */
+import { join } from "path";
+
+import { IBenchmarkOptions, IBenchmarkResult } from "./harness";
+
+interface INativeResult {
+  type: string;
+  method: string;
+  nsPerValue: number;
+  valuesPerSec: number;
+}
+
+const nativeBenchmarkPath = join(__dirname, "../../build/Release/node-duckdb-benchmarks.node");
+
+/**
+ * Runs the C++ conversion microbenchmark when it was built (yarn build:benchmarks)
+ */
+export function nativeConversionSuite(options: IBenchmarkOptions): IBenchmarkResult[] {
+  let nativeBenchmark: { run(options: { minTimeMs: number }): INativeResult[] };
+  try {
+    // eslint-disable-next-line node/no-unpublished-require, @typescript-eslint/no-var-requires
+    nativeBenchmark = require(nativeBenchmarkPath);
+  } catch (e) {
+    console.error(`skipping native conversion benchmark, ${nativeBenchmarkPath} is not built`);
+    return [];
+  }
+  return nativeBenchmark.run({ minTimeMs: options.nativeMinTimeMs }).map(result => ({
+    suite: "native-conversion",
+    name: `${result.method} ${result.type}`,
+    params: { type: result.type, method: result.method },
+    metrics: { nsPerValue: result.nsPerValue, valuesPerSec: result.valuesPerSec },
+  }));
+}
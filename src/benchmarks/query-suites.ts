@@ -0,0 +1,251 @@
+import { promises as fs } from "fs";
+
+import { Connection, ConnectionPool, DuckDB } from "@addon";
+import { RowResultFormat } from "@addon-types";
+
+import { IBenchmarkOptions, IBenchmarkResult, percentiles, time, valueBytes } from "./harness";
+
+export const benchmarkTable = "synthetic";
+
+// the first columns of the synthetic data set have fixed types
+const columnsByType: Record<string, string> = {
+  INT32: "col0",
+  INT64: "col1",
+  DOUBLE: "col2",
+  UTF8: "col3",
+  BOOLEAN: "col4",
+};
+const mixedColumns = Array.from({ length: 15 }, (_, i) => `col${i}`).join(", ");
+
+// Reads all rows with fetchRow, returns the number of rows read
+function drainRows(result: { fetchRow(): unknown }): number {
+  let rows = 0;
+  // eslint-disable-next-line no-loops/no-loops
+  while (result.fetchRow() !== null) {
+    rows += 1;
+  }
+  return rows;
+}
+
+async function resultBytes(connection: Connection, query: string): Promise<number> {
+  const result = await connection.executeIterator(query, { forceMaterialized: true });
+  return result.fetchAllRows().reduce<number>((sum, row) => sum + valueBytes(row), 0);
+}
+
+/**
+ * fetchRow throughput per column type, with rows as objects and as arrays
+ */
+export async function fetchRowSuite(db: DuckDB): Promise<IBenchmarkResult[]> {
+  const connection = new Connection(db);
+  const results: IBenchmarkResult[] = [];
+  const cases = [...Object.entries(columnsByType), ["MIXED", mixedColumns]];
+  // eslint-disable-next-line no-loops/no-loops
+  for (const [type, columns] of cases) {
+    const query = `SELECT ${columns} FROM ${benchmarkTable}`;
+    const bytes = await resultBytes(connection, query);
+    // eslint-disable-next-line no-loops/no-loops
+    for (const format of [RowResultFormat.Object, RowResultFormat.Array]) {
+      const result = await connection.executeIterator(query, { forceMaterialized: true, rowResultFormat: format });
+      const { value: rows, ms } = await time(() => drainRows(result));
+      results.push({
+        suite: "fetch-row",
+        name: `${type} ${RowResultFormat[format]}`,
+        params: { type, format: RowResultFormat[format] },
+        metrics: { rows, ms, rowsPerSec: (rows * 1000) / ms, bytesPerSec: (bytes * 1000) / ms },
+      });
+    }
+  }
+  connection.close();
+  return results;
+}
+
+/**
+ * Time to first row and to the last row for streaming and materialized results
+ */
+export async function resultTypeSuite(db: DuckDB): Promise<IBenchmarkResult[]> {
+  const connection = new Connection(db);
+  const query = `SELECT ${mixedColumns} FROM ${benchmarkTable}`;
+  const results: IBenchmarkResult[] = [];
+  // eslint-disable-next-line no-loops/no-loops
+  for (const forceMaterialized of [true, false]) {
+    const start = process.hrtime.bigint();
+    const { value: result, ms: executeMs } = await time(() =>
+      connection.executeIterator(query, { forceMaterialized, rowResultFormat: RowResultFormat.Array }),
+    );
+    const { ms: firstRowMs } = await time(() => result.fetchRow());
+    const rows = drainRows(result) + 1;
+    const totalMs = Number(process.hrtime.bigint() - start) / 1e6;
+    results.push({
+      suite: "result-type",
+      name: forceMaterialized ? "materialized" : "streaming",
+      params: { forceMaterialized },
+      metrics: {
+        rows,
+        executeMs,
+        timeToFirstRowMs: executeMs + firstRowMs,
+        totalMs,
+        rowsPerSec: (rows * 1000) / totalMs,
+      },
+    });
+  }
+  connection.close();
+  return results;
+}
+
+/**
+ * Aggregation throughput with an increasing number of concurrent queries
+ */
+export async function concurrencySuite(db: DuckDB): Promise<IBenchmarkResult[]> {
+  const query = `SELECT SUM(col0), AVG(col2), COUNT(DISTINCT col3) FROM ${benchmarkTable}`;
+  const queriesPerConnection = 4;
+  const results: IBenchmarkResult[] = [];
+  // eslint-disable-next-line no-loops/no-loops
+  for (const concurrency of [1, 2, 4, 8]) {
+    const pool = new ConnectionPool(db, { size: concurrency });
+    const { ms } = await time(() =>
+      Promise.all(
+        Array.from({ length: concurrency }, async () => {
+          // eslint-disable-next-line no-loops/no-loops
+          for (let i = 0; i < queriesPerConnection; i++) {
+            const result = await pool.executeIterator(query, { forceMaterialized: true });
+            result.fetchAllRows();
+          }
+        }),
+      ),
+    );
+    const queries = concurrency * queriesPerConnection;
+    results.push({
+      suite: "concurrency",
+      name: `${concurrency} connections`,
+      params: { concurrency },
+      metrics: { queries, ms, queriesPerSec: (queries * 1000) / ms },
+    });
+    pool.close();
+  }
+  return results;
+}
+
+// Latencies of sequential fs operations, in milliseconds
+async function fsLatencies(operations: number): Promise<number[]> {
+  const latencies: number[] = [];
+  // eslint-disable-next-line no-loops/no-loops
+  for (let i = 0; i < operations; i++) {
+    const start = process.hrtime.bigint();
+    await fs.stat(__filename);
+    await fs.readFile(__filename);
+    latencies.push(Number(process.hrtime.bigint() - start) / 1e6);
+  }
+  return latencies;
+}
+
+/**
+ * Latency of fs operations while long queries run, with the queries on the query thread pool and on the libuv
+ * threadpool (queryThreadPoolSize 0). The libuv threadpool has 4 threads unless UV_THREADPOOL_SIZE is set, so with more
+ * long queries than that fs operations wait for a query to finish.
+ */
+export async function mixedIoSuite(): Promise<IBenchmarkResult[]> {
+  const longQuery = "SELECT COUNT(*) FROM range(0, 100000000000) t1";
+  const queryMs = 2000;
+  const fsOperations = 200;
+  const results: IBenchmarkResult[] = [
+    {
+      suite: "mixed-io",
+      name: "idle",
+      params: { executor: "none", queries: 0 },
+      metrics: percentiles(await fsLatencies(fsOperations)),
+    },
+  ];
+  // eslint-disable-next-line no-loops/no-loops
+  for (const [executor, queryThreadPoolSize] of [
+    ["query-thread-pool", 8],
+    ["libuv", 0],
+  ] as const) {
+    const db = new DuckDB({ options: { queryThreadPoolSize } });
+    const connections = Array.from({ length: 8 }, () => new Connection(db));
+    const queries = connections.map(connection =>
+      connection.executeIterator(longQuery, { forceMaterialized: true, timeoutMs: queryMs }).catch(() => null),
+    );
+    results.push({
+      suite: "mixed-io",
+      name: `${executor}, ${connections.length} long queries`,
+      params: { executor, queries: connections.length },
+      metrics: percentiles(await fsLatencies(fsOperations)),
+    });
+    await Promise.all(queries);
+    connections.forEach(connection => connection.close());
+    db.close();
+  }
+  return results;
+}
+
+/**
+ * Round trip latency of small queries, from execute to the last row
+ */
+export async function latencySuite(db: DuckDB, options: IBenchmarkOptions): Promise<IBenchmarkResult[]> {
+  const connection = new Connection(db);
+  const results: IBenchmarkResult[] = [];
+  const queries: Record<string, string> = {
+    "select constant": "SELECT 1",
+    "point lookup": `SELECT * FROM ${benchmarkTable} LIMIT 1`,
+    aggregate: `SELECT COUNT(*) FROM ${benchmarkTable}`,
+  };
+  // eslint-disable-next-line no-loops/no-loops
+  for (const [name, query] of Object.entries(queries)) {
+    const samples: number[] = [];
+    // eslint-disable-next-line no-loops/no-loops
+    for (let i = 0; i < options.latencyIterations + 10; i++) {
+      const { ms } = await time(async () => (await connection.executeIterator(query)).fetchAllRows());
+      // the first executions warm up caches
+      if (i >= 10) {
+        samples.push(ms);
+      }
+    }
+    results.push({
+      suite: "execute-latency",
+      name,
+      params: { query, iterations: options.latencyIterations },
+      metrics: percentiles(samples),
+    });
+  }
+  connection.close();
+  return results;
+}
+
+/**
+ * Latency of point lookups built by string concatenation against the same lookups through a prepared statement
+ */
+export async function preparedSuite(db: DuckDB, options: IBenchmarkOptions): Promise<IBenchmarkResult[]> {
+  const connection = new Connection(db);
+  const lookupCount = 100000;
+  await connection.executeIterator(
+    `CREATE TEMP TABLE lookup AS SELECT range AS id, range * 2 AS value FROM range(0, ${lookupCount})`,
+  );
+  const statement = await connection.prepare("SELECT value FROM lookup WHERE id = ?");
+  const lookups: Record<string, (id: number) => Promise<unknown>> = {
+    concatenated: async id =>
+      (await connection.executeIterator(`SELECT value FROM lookup WHERE id = ${id}`)).fetchRow(),
+    prepared: async id => (await statement.executeIterator([id])).fetchRow(),
+  };
+  const results: IBenchmarkResult[] = [];
+  // eslint-disable-next-line no-loops/no-loops
+  for (const [name, lookup] of Object.entries(lookups)) {
+    const samples: number[] = [];
+    // eslint-disable-next-line no-loops/no-loops
+    for (let i = 0; i < options.latencyIterations + 10; i++) {
+      const { ms } = await time(() => lookup((i * 7919) % lookupCount));
+      // the first executions warm up caches
+      if (i >= 10) {
+        samples.push(ms);
+      }
+    }
+    results.push({
+      suite: "prepared",
+      name,
+      params: { iterations: options.latencyIterations },
+      metrics: percentiles(samples),
+    });
+  }
+  statement.close();
+  connection.close();
+  return results;
+}
@@ -39,5 +39,15 @@
  * ```
  * For more examples see {@link https://github.com/deepcrawl/node-duckdb/tree/feature/ODIN-423-welcome-page/examples | here}.
  */
-export { DuckDB, Connection, ResultIterator } from "./addon";
+export {
+  Appender,
+  CancellationReason,
+  DuckDB,
+  Connection,
+  ConnectionPool,
+  IBatchResult,
+  PreparedStatement,
+  QueryCancelledError,
+  ResultIterator,
+} from "./addon";
 export * from "./addon-types";
@@ -0,0 +1,165 @@
+import { Appender, Connection, DuckDB } from "@addon";
+import { RowResultFormat } from "@addon-types";
+
+describe("Appender", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(async () => {
+    db = new DuckDB();
+    connection = new Connection(db);
+    await connection.executeIterator(
+      "CREATE TABLE crawl(id INTEGER, depth SMALLINT, rank DOUBLE, links BIGINT, url VARCHAR, body BLOB, fetched TIMESTAMP, ok BOOLEAN);",
+    );
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  const fetchAll = async (query: string) =>
+    (await connection.executeIterator(query, { rowResultFormat: RowResultFormat.Array })).fetchAllRows();
+
+  it("appends rows", async () => {
+    const appender = await Appender.open(connection, "crawl");
+    appender.appendRows([
+      [1, 2, 0.5, 10n, "https://a.com", Buffer.from("a"), new Date(Date.UTC(2021, 0, 1)), true],
+      [2, null, null, null, null, null, null, null],
+    ]);
+    expect(appender.pendingRowCount).toBe(2);
+    await appender.close();
+    expect(appender.isClosed).toBe(true);
+    expect(await fetchAll("SELECT * FROM crawl ORDER BY id")).toEqual([
+      [1, 2, 0.5, 10n, "https://a.com", Buffer.from("a"), Date.UTC(2021, 0, 1), true],
+      [2, null, null, null, null, null, null, null],
+    ]);
+  });
+
+  it("appends columns spanning multiple chunks", async () => {
+    const rowCount = 5000;
+    const ids = new Int32Array(rowCount).map((_, i) => i);
+    const ranks = new Float64Array(rowCount).map((_, i) => i / 2);
+    const links = new BigInt64Array(rowCount).map((_, i) => BigInt(i * 10));
+    const fetched = new Float64Array(rowCount).fill(Date.UTC(2021, 0, 1));
+    const urls = Array.from(ids, i => `https://example.com/${i}`);
+    const bodies = Array.from(ids, i => (i % 2 === 0 ? Buffer.from(String(i)) : null));
+    const ok = new Uint8Array(rowCount).map((_, i) => i % 3);
+
+    const appender = await Appender.open(connection, "crawl");
+    appender.appendColumns([ids, new Int16Array(rowCount), ranks, links, urls, bodies, fetched, ok]);
+    await appender.flush();
+    expect(appender.pendingRowCount).toBe(0);
+    await appender.close();
+
+    expect(await fetchAll("SELECT COUNT(*), SUM(id), SUM(rank), SUM(links), COUNT(body), SUM(ok::INTEGER) FROM crawl")).toEqual([
+      [5000n, 12497500n, 6248750, 124975000n, 2500n, 3333n],
+    ]);
+    expect(await fetchAll("SELECT url, body, fetched FROM crawl WHERE id = 4998")).toEqual([
+      ["https://example.com/4998", Buffer.from("4998"), Date.UTC(2021, 0, 1)],
+    ]);
+  });
+
+  it("opens once the queries issued before on the connection are done", async () => {
+    const created = connection.executeIterator("CREATE TABLE later(i INTEGER)");
+    const appender = await Appender.open(connection, "later");
+    await created;
+    appender.appendRows([[1]]);
+    await appender.close();
+    expect(await fetchAll("SELECT * FROM later")).toEqual([[1]]);
+  });
+
+  it("makes appended rows visible only after flush", async () => {
+    const appender = await Appender.open(connection, "crawl");
+    appender.appendColumns([[1, 2], [1, 1], [0, 0], [0, 0], ["a", "b"], [null, null], [null, null], [true, false]]);
+    expect(await fetchAll("SELECT COUNT(*) FROM crawl")).toEqual([[0n]]);
+    await appender.flush();
+    expect(await fetchAll("SELECT COUNT(*) FROM crawl")).toEqual([[2n]]);
+    await appender.close();
+  });
+
+  it("clears nulls left by a failed row when appending typed arrays", async () => {
+    const appender = await Appender.open(connection, "crawl");
+    expect(() => appender.appendRows([[null, null, null, null, <any>{}, null, null, null]])).toThrow();
+    appender.appendColumns([
+      new Int32Array([7]),
+      new Int16Array([1]),
+      new Float64Array([0.5]),
+      new BigInt64Array([3n]),
+      ["https://a.com"],
+      [null],
+      new Float64Array([Date.UTC(2021, 0, 1)]),
+      new Uint8Array([1]),
+    ]);
+    await appender.close();
+    expect(await fetchAll("SELECT id, depth, rank, links FROM crawl")).toEqual([[7, 1, 0.5, 3n]]);
+  });
+
+  it("rejects TIMESTAMP BigInts out of range", async () => {
+    const appender = await Appender.open(connection, "crawl");
+    expect(() => appender.appendRows([[1, 1, 0, 0n, "a", null, 2n ** 64n, true]])).toThrow();
+    expect(appender.pendingRowCount).toBe(0);
+    await appender.close();
+  });
+
+  it("rejects numbers that don't fit the column", async () => {
+    const appender = await Appender.open(connection, "crawl");
+    const row = (id: number, depth: number, links: number, fetched: Date | null) => [
+      [id, depth, 0, links, "a", null, fetched, true],
+    ];
+    expect(() => appender.appendRows(row(1, 40000, 0, null))).toThrow(
+      'Invalid value for column "depth" at row 0: 40000 doesn\'t fit SMALLINT',
+    );
+    expect(() => appender.appendRows(row(1.5, 1, 0, null))).toThrow('Invalid value for column "id" at row 0');
+    expect(() => appender.appendRows(row(NaN, 1, 0, null))).toThrow('Invalid value for column "id" at row 0');
+    expect(() => appender.appendRows(row(1, 1, 1e30, null))).toThrow('Invalid value for column "links" at row 0');
+    expect(() => appender.appendRows(row(1, 1, 0, new Date("x")))).toThrow(
+      'Invalid value for column "fetched" at row 0: invalid Date',
+    );
+    const columns = (ids: Float64Array, links: Float64Array) => [
+      ids,
+      new Int16Array(ids.length),
+      ids,
+      links,
+      Array(ids.length).fill("a"),
+      Array(ids.length).fill(null),
+      Array(ids.length).fill(null),
+      new Uint8Array(ids.length),
+    ];
+    expect(() => appender.appendColumns(columns(new Float64Array([1, 2.5]), new Float64Array(2)))).toThrow(
+      'Invalid value for column "id" at row 1: 2.5 doesn\'t fit INTEGER',
+    );
+    expect(() => appender.appendColumns(columns(new Float64Array(1), new Float64Array([Infinity])))).toThrow(
+      'Invalid value for column "links" at row 0',
+    );
+    expect(() =>
+      appender.appendColumns([
+        new Int32Array([300]),
+        new Int32Array([40000]),
+        [0],
+        [0],
+        ["a"],
+        [null],
+        [null],
+        [true],
+      ]),
+    ).toThrow('Invalid value for column "depth" at row 0: 40000 doesn\'t fit SMALLINT');
+    expect(appender.pendingRowCount).toBe(0);
+    await appender.close();
+    expect(await fetchAll("SELECT COUNT(*) FROM crawl")).toEqual([[0n]]);
+  });
+
+  it("validates input", async () => {
+    await expect(Appender.open(connection, "missing")).rejects.toThrow("Table main.missing does not exist");
+    const appender = await Appender.open(connection, "crawl");
+    expect(() => appender.appendRows([[1]])).toThrow("Row at index 0 must be an array of 8 values");
+    expect(() => appender.appendColumns([[1]])).toThrow("First argument must be an array of 8 columns");
+    expect(() =>
+      appender.appendColumns([[1], [1, 2], [1], [1], ["a"], [null], [null], [true]]),
+    ).toThrow("All columns must have the same length");
+    expect(() =>
+      appender.appendColumns([[1], [1], [1], [1], new Int32Array(1), [null], [null], [true]]),
+    ).toThrow("Column at index 4: typed arrays are not supported for VARCHAR columns");
+    await appender.close();
+    expect(() => appender.appendRows([])).toThrow("Appender is closed");
+  });
+});
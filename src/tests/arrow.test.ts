@@ -0,0 +1,75 @@
+import { Table } from "apache-arrow";
+
+import { Connection, DuckDB, ResultIterator } from "@addon";
+
+// the end-of-stream marker: a continuation marker followed by a zero metadata length
+const endOfStream = Buffer.from([0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0]);
+
+async function readStream(result: ResultIterator<unknown>): Promise<Buffer> {
+  const buffers: Buffer[] = [];
+  let batch = await result.fetchArrowBatch();
+  // eslint-disable-next-line no-loops/no-loops
+  while (batch !== null) {
+    buffers.push(batch);
+    batch = await result.fetchArrowBatch();
+  }
+  return Buffer.concat(buffers);
+}
+
+describe("Arrow IPC export", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("returns the schema with the first batch and ends the stream", async () => {
+    const result = await connection.executeIterator("SELECT CAST(range AS INTEGER) AS i FROM range(0, 10)");
+    const stream = await readStream(result);
+    expect(stream.slice(-8)).toEqual(endOfStream);
+    const table = Table.from(stream);
+    expect(table.schema.fields.map(field => field.name)).toEqual(["i"]);
+    expect(Array.from(table.getColumn("i").toArray())).toEqual([0, 1, 2, 3, 4, 5, 6, 7, 8, 9]);
+    expect(await result.fetchArrowBatch()).toBeNull();
+  });
+
+  it("returns the schema and the end of the stream for an empty result", async () => {
+    const result = await connection.executeIterator("SELECT 1 AS a WHERE 1 = 0");
+    const stream = await readStream(result);
+    expect(stream.slice(-8)).toEqual(endOfStream);
+    const table = Table.from(stream);
+    expect(table.schema.fields.map(field => field.name)).toEqual(["a"]);
+    expect(table.length).toBe(0);
+  });
+
+  it("streams a complete IPC stream of all supported types", async () => {
+    const stream = await connection.executeArrow(
+      `SELECT range AS big, CAST(range AS DOUBLE) AS d, range % 2 = 0 AS b, 'row ' || range AS s,
+         CASE WHEN range % 3 = 0 THEN NULL ELSE range END AS n, CAST(range AS DECIMAL(10, 2)) AS dec,
+         DATE '2021-01-01' AS dt, TIMESTAMP '2021-01-01 10:00:00' AS ts, INTERVAL 1 DAY AS iv FROM range(0, 3000)`,
+    );
+    const buffers: Buffer[] = [];
+    // eslint-disable-next-line no-loops/no-loops
+    for await (const buffer of stream) {
+      buffers.push(buffer);
+    }
+    const bytes = Buffer.concat(buffers);
+    expect(bytes.slice(-8)).toEqual(endOfStream);
+    const table = Table.from(bytes);
+    // one record batch per 1024 row chunk
+    expect(table.chunks).toHaveLength(3);
+    expect(table.length).toBe(3000);
+    expect(table.schema.fields.map(field => field.name)).toEqual(["big", "d", "b", "s", "n", "dec", "dt", "ts", "iv"]);
+    expect(table.getColumn("d").get(2999)).toBe(2999);
+    expect(table.getColumn("b").get(1)).toBe(false);
+    expect(table.getColumn("s").get(1024)).toBe("row 1024");
+    expect(table.getColumn("n").isValid(3)).toBe(false);
+    expect(table.getColumn("n").isValid(4)).toBe(true);
+  });
+});
@@ -0,0 +1,93 @@
+import { Connection, DuckDB } from "@addon";
+import { IColumnarChunk, IExecuteOptions, RowResultFormat } from "@addon-types";
+
+const query = "SELECT * FROM range(0, 5000) t(i)";
+
+const executeOptions: IExecuteOptions = { rowResultFormat: RowResultFormat.Array };
+
+describe("Asynchronous fetch", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("iterates over all rows with for await", async () => {
+    const result = await connection.executeIterator<bigint[]>(query, executeOptions);
+    const rows: bigint[][] = [];
+    // eslint-disable-next-line no-loops/no-loops
+    for await (const row of result) {
+      rows.push(row);
+    }
+    expect(rows.length).toBe(5000);
+    expect(rows[0]).toEqual([0n]);
+    expect(rows[4999]).toEqual([4999n]);
+  });
+
+  it("fetches chunks asynchronously", async () => {
+    const result = await connection.executeIterator(query, { prefetchChunkCount: 1 });
+    const chunk = <IColumnarChunk>await result.fetchChunkAsync();
+    expect(chunk.columns[0].data[0]).toBe(0n);
+    let rowCount = chunk.rowCount;
+    // eslint-disable-next-line no-loops/no-loops
+    for await (const nextChunk of result.chunksAsync()) {
+      rowCount += nextChunk.rowCount;
+    }
+    expect(rowCount).toBe(5000);
+    expect(await result.fetchChunkAsync()).toBeNull();
+  });
+
+  it("continues asynchronously after synchronous fetch", async () => {
+    const result = await connection.executeIterator<bigint[]>(query, executeOptions);
+    expect(result.fetchRow()).toEqual([0n]);
+    const chunk = <IColumnarChunk>await result.fetchChunkAsync();
+    expect(chunk.columns[0].data[0]).toBe(1n);
+  });
+
+  it("continues synchronously after asynchronous fetch", async () => {
+    const result = await connection.executeIterator<bigint[]>(query, executeOptions);
+    const chunk = <IColumnarChunk>await result.fetchChunkAsync();
+    expect(chunk.columns[0].data[0]).toBe(0n);
+    const rows = result.fetchAllRows();
+    expect(rows[0]).toEqual([BigInt(chunk.rowCount)]);
+    expect(chunk.rowCount + rows.length).toBe(5000);
+    expect(result.fetchRow()).toBeNull();
+  });
+
+  it("takes over a prefetch that hasn't completed yet", async () => {
+    const result = await connection.executeIterator<bigint[]>(query, { ...executeOptions, prefetchChunkCount: 1 });
+    expect(await result.fetchRowsAsync()).toHaveLength(1024);
+    // the prefetch started by the async fetch is still in flight
+    expect(result.fetchRow()).toEqual([1024n]);
+    expect(result.fetchRows(5000)).toHaveLength(5000 - 1025);
+    expect(await result.fetchRowsAsync()).toBeNull();
+  });
+
+  it("does not allow synchronous fetch while asynchronous one is in progress", async () => {
+    const result = await connection.executeIterator(query, executeOptions);
+    const chunkPromise = result.fetchChunkAsync();
+    expect(() => result.fetchRow()).toThrow(
+      "Cannot fetch synchronously while an asynchronous fetch is in progress",
+    );
+    await chunkPromise;
+  });
+
+  it("rejects pending fetches when closed", async () => {
+    const result = await connection.executeIterator(query, executeOptions);
+    const chunkPromise = result.fetchChunkAsync();
+    result.close();
+    await expect(chunkPromise).rejects.toMatchObject({ message: "Result closed" });
+  });
+
+  it("does not allow invalid prefetch chunk count", async () => {
+    await expect(connection.executeIterator(query, { prefetchChunkCount: 0 })).rejects.toMatchObject({
+      message: "Invalid prefetchChunkCount: must be a positive number",
+    });
+  });
+});
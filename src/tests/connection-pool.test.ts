@@ -0,0 +1,117 @@
+import { ConnectionPool, DuckDB, QueryCancelledError } from "@addon";
+import { IExecuteOptions, ResultType, RowResultFormat } from "@addon-types";
+
+const query = "SELECT * FROM range(0, 5000)";
+const longQuery = "SELECT COUNT(*) FROM range(0, 100000000000) t1";
+const executeOptions: IExecuteOptions = { rowResultFormat: RowResultFormat.Array, forceMaterialized: false };
+
+describe("Connection pool", () => {
+  let db: DuckDB;
+  let pool: ConnectionPool;
+  beforeEach(() => {
+    db = new DuckDB();
+    pool = new ConnectionPool(db, { size: 2 });
+  });
+
+  afterEach(() => {
+    pool.close();
+    db.close();
+  });
+
+  it("defaults to one connection per query thread", () => {
+    const defaultPool = new ConnectionPool(db);
+    expect(defaultPool.size).toBe(db.queryThreadPoolSize);
+    defaultPool.close();
+  });
+
+  it("does not allow to specify invalid size", () => {
+    expect(() => new ConnectionPool(db, <any>{ size: "invalid" })).toThrow("Invalid size: must be a number");
+    expect(() => new ConnectionPool(db, { size: 0 })).toThrow("Invalid size: must be a positive number");
+  });
+
+  it("streams concurrent results", async () => {
+    const [result1, result2] = await Promise.all([
+      pool.executeIterator<bigint[]>(query, executeOptions),
+      pool.executeIterator<bigint[]>(query, executeOptions),
+    ]);
+    expect(result1.type).toBe(ResultType.Streaming);
+    expect(result2.type).toBe(ResultType.Streaming);
+    expect(result1.fetchRow()).toEqual([0n]);
+    expect(result2.fetchRow()).toEqual([0n]);
+    expect(result1.fetchAllRows()).toHaveLength(4999);
+    expect(result2.fetchAllRows()).toHaveLength(4999);
+  });
+
+  it("queues queries while all connections are busy", async () => {
+    const result1 = await pool.executeIterator(query, executeOptions);
+    const result2 = await pool.executeIterator(query, executeOptions);
+    expect(pool.idleCount).toBe(0);
+    const result3Promise = pool.executeIterator<bigint[]>(query, executeOptions);
+    expect(pool.waitingCount).toBe(1);
+    result1.close();
+    const result3 = await result3Promise;
+    expect(pool.waitingCount).toBe(0);
+    expect(result3.fetchAllRows()).toHaveLength(5000);
+    result2.close();
+  });
+
+  it("returns the connection once the result is exhausted", async () => {
+    const result = await pool.executeIterator(query, executeOptions);
+    expect(pool.idleCount).toBe(1);
+    result.fetchAllRows();
+    expect(pool.idleCount).toBe(2);
+  });
+
+  it("returns the connection once the result is exhausted asynchronously", async () => {
+    const result = await pool.executeIterator(query, executeOptions);
+    const rows = [];
+    // eslint-disable-next-line no-loops/no-loops
+    for await (const row of result) {
+      rows.push(row);
+    }
+    expect(rows).toHaveLength(5000);
+    expect(pool.idleCount).toBe(2);
+  });
+
+  it("returns the connection right away for materialized results", async () => {
+    const result = await pool.executeIterator(query, { forceMaterialized: true });
+    expect(pool.idleCount).toBe(2);
+    expect(result.fetchAllRows()).toHaveLength(5000);
+  });
+
+  it("returns the connection when the query fails", async () => {
+    await expect(pool.executeIterator("SELECT * FROM missing_table")).rejects.toThrow("missing_table");
+    expect(pool.idleCount).toBe(2);
+  });
+
+  it("cancels a query waiting for a connection", async () => {
+    const result1 = await pool.executeIterator(query, executeOptions);
+    const result2 = await pool.executeIterator(query, executeOptions);
+    await expect(pool.executeIterator(query, { ...executeOptions, timeoutMs: 10 })).rejects.toEqual(
+      new QueryCancelledError("timeout"),
+    );
+    expect(pool.waitingCount).toBe(0);
+    result1.close();
+    result2.close();
+    expect(pool.idleCount).toBe(2);
+  });
+
+  it("cancels a running query", async () => {
+    await expect(pool.executeIterator(longQuery, { forceMaterialized: true, timeoutMs: 100 })).rejects.toEqual(
+      new QueryCancelledError("timeout"),
+    );
+    expect(pool.idleCount).toBe(2);
+  });
+
+  it("rejects waiting queries when closed", async () => {
+    const result1 = await pool.executeIterator(query, executeOptions);
+    const result2 = await pool.executeIterator(query, executeOptions);
+    const result3Promise = pool.executeIterator(query, executeOptions);
+    pool.close();
+    await expect(result3Promise).rejects.toThrow("Connection pool is closed");
+    await expect(pool.executeIterator(query)).rejects.toThrow("Connection pool is closed");
+    expect(pool.isClosed).toBe(true);
+    expect(result1.fetchAllRows()).toHaveLength(5000);
+    result2.close();
+  });
+});
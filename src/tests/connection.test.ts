@@ -57,4 +57,37 @@ describe("Connection class", () => {
     connection.close();
     db.close();
   });
+
+  it("closes its open results when closed", async () => {
+    const db = new DuckDB();
+    const connection = new Connection(db);
+    const materialized = await connection.executeIterator("SELECT * FROM range(0, 5000)", {
+      ...executeOptions,
+      forceMaterialized: true,
+    });
+    const streaming = await connection.executeIterator("SELECT * FROM range(0, 5000)");
+    const read = await connection.executeIterator("SELECT 1", { forceMaterialized: true });
+    read.close();
+    expect(materialized.fetchRow()).toEqual([0n]);
+    connection.close();
+    expect(materialized.isClosed).toBe(true);
+    expect(streaming.isClosed).toBe(true);
+    expect(() => materialized.fetchRow()).toThrow("Result closed");
+    db.close();
+  });
+
+  it("reports less external memory as a materialized result is read", async () => {
+    const db = new DuckDB();
+    const connection = new Connection(db);
+    const result = await connection.executeIterator("SELECT repeat('x', 100) || i FROM range(0, 100000) t(i)", {
+      ...executeOptions,
+      forceMaterialized: true,
+    });
+    const externalBefore = process.memoryUsage().external;
+    expect(result.fetchAllRows()).toHaveLength(100000);
+    // about 10MB of strings have been freed
+    expect(externalBefore - process.memoryUsage().external).toBeGreaterThan(8 * 1024 * 1024);
+    connection.close();
+    db.close();
+  });
 });
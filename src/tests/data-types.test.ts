@@ -1,5 +1,5 @@
 import { DuckDB, Connection } from "@addon";
-import { RowResultFormat } from "@addon-types";
+import { IInterval, RowResultFormat } from "@addon-types";
 
 /**
  * There are types in the source code that there is no documentation for and I'm not sure if they are used as return types:
@@ -189,12 +189,31 @@ describe("Data type mapping", () => {
     expect(view[1]).toBe(66);
   });
 
-  // TODO: either create a JS/TS object representing an interval or possibly convert to number
+  it("supports BLOB values containing zero bytes", async () => {
+    const result = await connection.executeIterator<Buffer[]>(`SELECT '\\x00\\x01A\\x00'::BLOB;`, {
+      rowResultFormat: RowResultFormat.Array,
+    });
+    expect(result.fetchRow()[0]).toEqual(Buffer.from([0, 1, 65, 0]));
+  });
+
+  it("supports large BLOB values", async () => {
+    const query = "SELECT repeat('ab', 1000 + i::INTEGER)::BLOB FROM range(0, 3000) t(i)";
+    const result = await connection.executeIterator<Buffer[]>(query, { rowResultFormat: RowResultFormat.Array });
+    const rows = result.fetchAllRows();
+    const chunk = await (await connection.executeIterator(query)).fetchChunkAsync();
+    result.close();
+    expect(rows.length).toBe(3000);
+    // buffers remain valid after the result is closed and other queries ran
+    expect(rows[0][0]).toEqual(Buffer.from("ab".repeat(1000)));
+    expect(rows[2999][0]).toEqual(Buffer.from("ab".repeat(3999)));
+    expect(chunk?.columns[0].data[1]).toEqual(Buffer.from("ab".repeat(1001)));
+  });
+
   it("supports INTERVAL", async () => {
-    const result = await connection.executeIterator<string[]>(`SELECT INTERVAL '1' MONTH;`, {
+    const result = await connection.executeIterator<IInterval[]>(`SELECT INTERVAL '1' MONTH;`, {
       rowResultFormat: RowResultFormat.Array,
     });
-    expect(result.fetchRow()).toMatchObject(["1 month"]);
+    expect(result.fetchRow()).toEqual([{ months: 1, days: 0, micros: 0 }]);
   });
 
   it("supports UTINYINT", async () => {
@@ -0,0 +1,71 @@
+import { existsSync, mkdtempSync, rmdirSync, statSync, unlinkSync } from "fs";
+import { tmpdir } from "os";
+import { join } from "path";
+
+import { Connection, DuckDB } from "@addon";
+import { RowResultFormat } from "@addon-types";
+
+describe("Asynchronous database lifecycle", () => {
+  let directory: string;
+  let path: string;
+  beforeEach(() => {
+    directory = mkdtempSync(join(tmpdir(), "node-duckdb-lifecycle-"));
+    path = join(directory, "test.db");
+  });
+
+  afterEach(() => {
+    [path, `${path}.wal`].filter(existsSync).forEach(unlinkSync);
+    rmdirSync(directory);
+  });
+
+  const count = async (db: DuckDB) => {
+    const connection = new Connection(db);
+    const result = await connection.executeIterator("SELECT count(*) FROM t", { rowResultFormat: RowResultFormat.Array });
+    const rows = result.fetchAllRows();
+    connection.close();
+    return rows;
+  };
+
+  it("opens, checkpoints and closes a database", async () => {
+    const db = await DuckDB.open({ path, options: { queryThreadPoolSize: 2 } });
+    expect(db).toBeInstanceOf(DuckDB);
+    expect(db.isClosed).toBe(false);
+    expect(db.queryThreadPoolSize).toBe(2);
+    const connection = new Connection(db);
+    await connection.executeIterator("CREATE TABLE t AS SELECT * FROM range(0, 10000)");
+    connection.close();
+    await db.checkpoint();
+    expect(statSync(path).size).toBeGreaterThan(0);
+    await db.closeAsync();
+    expect(db.isClosed).toBe(true);
+    await expect(db.checkpoint()).rejects.toThrow("Database is closed");
+    // closing again is a no-op
+    await db.closeAsync();
+
+    const reopened = await DuckDB.open({ path });
+    expect(await count(reopened)).toEqual([[10000n]]);
+    await reopened.closeAsync();
+  });
+
+  it("opens a database that was closed without a checkpoint", async () => {
+    const db = new DuckDB({ path });
+    const connection = new Connection(db);
+    await connection.executeIterator("CREATE TABLE t AS SELECT * FROM range(0, 100)");
+    connection.close();
+    db.close();
+
+    const reopened = await DuckDB.open({ path });
+    expect(await count(reopened)).toEqual([[100n]]);
+    reopened.close();
+  });
+
+  it("rejects invalid configs", async () => {
+    await expect(DuckDB.open({ options: { queryThreadPoolSize: -1 } })).rejects.toThrow(
+      "Invalid queryThreadPoolSize: must not be negative",
+    );
+    await expect(DuckDB.open({ handle: "node-duckdb:unknown" })).rejects.toThrow(
+      "Invalid handle: the database is closed or was never exported",
+    );
+    await expect(DuckDB.open({ path: join(directory, "missing", "test.db") })).rejects.toThrow();
+  });
+});
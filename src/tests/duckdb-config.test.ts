@@ -93,6 +93,60 @@ describe("DuckDB configuration", () => {
     expect(() => new DuckDB(<any>{ options: { maximumMemory: "invalid" } })).toThrow(
       "Invalid maximumMemory: must be a number",
     );
+    expect(() => new DuckDB({ options: { maximumMemory: -1 } })).toThrow(
+      "Invalid maximumMemory: must be a number or a bigint between 0 and 2^64",
+    );
+    expect(() => new DuckDB({ options: { maximumMemory: -1n } })).toThrow(
+      "Invalid maximumMemory: must be a number or a bigint between 0 and 2^64",
+    );
+  });
+
+  it("allows to specify maximum memory above 2GB", () => {
+    const db1 = new DuckDB({ options: { maximumMemory: 8e9 } });
+    expect(db1.maximumMemory).toBe(8e9);
+    db1.close();
+    const db2 = new DuckDB({ options: { maximumMemory: 16n * 1024n ** 3n } });
+    expect(db2.maximumMemory).toBe(16 * 1024 ** 3);
+    db2.close();
+  });
+
+  it("allows to specify the number of threads", async () => {
+    const db = new DuckDB({ options: { threads: 3 } });
+    expect(db.threads).toBe(3);
+    const connection = new Connection(db);
+    const result = await connection.executeIterator("SELECT COUNT(*) AS count FROM range(0, 100000)");
+    expect(result.fetchAllRows()).toEqual([{ count: 100000n }]);
+    connection.close();
+    db.close();
+  });
+
+  it("does not allow to specify invalid number of threads", () => {
+    expect(() => new DuckDB(<any>{ options: { threads: "invalid" } })).toThrow("Invalid threads: must be a number");
+    expect(() => new DuckDB({ options: { threads: 0 } })).toThrow("Invalid threads: must be a positive number");
+  });
+
+  it("applies connection pragmas to new connections", () => {
+    const db = new DuckDB({ options: { threads: 1, connectionPragmas: { threads: 2 } } });
+    expect(db.threads).toBe(1);
+    const connection = new Connection(db);
+    expect(db.threads).toBe(2);
+    connection.close();
+    db.close();
+  });
+
+  it("does not allow to specify invalid connection pragmas", () => {
+    expect(() => new DuckDB(<any>{ options: { connectionPragmas: 1 } })).toThrow(
+      "Invalid connectionPragmas: must be an object",
+    );
+    expect(() => new DuckDB({ options: { connectionPragmas: { "threads=1; DROP TABLE t": 1 } } })).toThrow(
+      "Invalid connectionPragmas: threads=1; DROP TABLE t is not a valid name",
+    );
+    expect(() => new DuckDB(<any>{ options: { connectionPragmas: { threads: null } } })).toThrow(
+      "Invalid connectionPragmas: threads must be a string, number or boolean",
+    );
+    const db = new DuckDB({ options: { connectionPragmas: { no_such_setting: 1 } } });
+    expect(() => new Connection(db)).toThrow("no_such_setting");
+    db.close();
   });
 
   // Note: looks like a duckdb bug: sets useTemporaryDirectory to true (although at the same time removes temporaryDirectory value)
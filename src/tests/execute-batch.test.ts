@@ -0,0 +1,96 @@
+import { Connection, DuckDB } from "@addon";
+import { RowResultFormat } from "@addon-types";
+
+describe("executeBatch", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("runs an array of statements and returns the last result", async () => {
+    const { rowCounts, result } = await connection.executeBatch(
+      [
+        "CREATE TABLE people(id INTEGER, name VARCHAR)",
+        "INSERT INTO people VALUES (1, 'Mark'), (2, 'Hannes'), (3, 'Bob')",
+        "UPDATE people SET name = 'Mark R' WHERE id = 1",
+        "SELECT name FROM people ORDER BY id",
+      ],
+      { rowResultFormat: RowResultFormat.Array },
+    );
+    expect(rowCounts).toEqual([0, 3, 1, 3]);
+    expect(result.fetchAllRows()).toEqual([["Mark R"], ["Hannes"], ["Bob"]]);
+  });
+
+  it("runs a script", async () => {
+    const { rowCounts, result } = await connection.executeBatch(`
+      CREATE TABLE numbers(n INTEGER);
+      INSERT INTO numbers SELECT * FROM range(0, 100);
+      DELETE FROM numbers WHERE n < 10;
+      SELECT count(*) AS count FROM numbers;
+    `);
+    expect(rowCounts).toEqual([0, 100, 10, 1]);
+    expect(result.fetchRow()).toEqual({ count: 90n });
+  });
+
+  it("stops at the failing statement and keeps the earlier ones", async () => {
+    await expect(
+      connection.executeBatch([
+        "CREATE TABLE t(n INTEGER)",
+        "INSERT INTO t VALUES (1)",
+        "INSERT INTO missing VALUES (1)",
+      ]),
+    ).rejects.toMatchObject({ statementIndex: 2 });
+    const result = await connection.executeIterator("SELECT count(*) AS count FROM t");
+    expect(result.fetchRow()).toEqual({ count: 1n });
+  });
+
+  it("rolls back the transaction when a statement fails", async () => {
+    await connection.executeIterator("CREATE TABLE t(n INTEGER)");
+    await expect(
+      connection.executeBatch(["INSERT INTO t VALUES (1)", "INSERT INTO t VALUES ('x')"], { transaction: true }),
+    ).rejects.toMatchObject({ statementIndex: 1 });
+    const result = await connection.executeIterator("SELECT count(*) AS count FROM t");
+    expect(result.fetchRow()).toEqual({ count: 0n });
+  });
+
+  it("keeps queries issued meanwhile out of the transaction", async () => {
+    await connection.executeIterator("CREATE TABLE t(n INTEGER)");
+    const batch = connection.executeBatch(
+      [
+        "INSERT INTO t VALUES (1)",
+        "SELECT COUNT(*) FROM range(0, 30000000) t1, range(0, 10) t2",
+        "INSERT INTO t VALUES ('x')",
+      ],
+      { transaction: true },
+    );
+    const insert = connection.executeIterator("INSERT INTO t VALUES (2)");
+    await expect(batch).rejects.toMatchObject({ statementIndex: 2 });
+    await insert;
+    const result = await connection.executeIterator("SELECT n FROM t", { rowResultFormat: RowResultFormat.Array });
+    expect(result.fetchAllRows()).toEqual([[2]]);
+  });
+
+  it("commits the transaction", async () => {
+    const { rowCounts } = await connection.executeBatch(
+      ["CREATE TABLE t(n INTEGER)", "INSERT INTO t VALUES (1)", "INSERT INTO t VALUES (2)"],
+      { transaction: true },
+    );
+    expect(rowCounts).toEqual([0, 1, 1]);
+    const result = await connection.executeIterator("SELECT count(*) AS count FROM t");
+    expect(result.fetchRow()).toEqual({ count: 2n });
+  });
+
+  it("validates its arguments", async () => {
+    await expect(connection.executeBatch(<any>[1])).rejects.toThrow(
+      "First argument must be a string or an array of strings",
+    );
+    await expect(connection.executeBatch([])).rejects.toThrow("Invalid argument: the batch contains no statements");
+  });
+});
@@ -0,0 +1,138 @@
+import { mkdtempSync, readdirSync, readFileSync, rmdirSync, unlinkSync } from "fs";
+import { tmpdir } from "os";
+import { join } from "path";
+import { Writable } from "stream";
+
+import { Connection, ConnectionPool, DuckDB } from "@addon";
+import { RowResultFormat } from "@addon-types";
+
+class CollectingWritable extends Writable {
+  public chunks: Buffer[] = [];
+  public _write(chunk: Buffer, _encoding: string, callback: () => void) {
+    this.chunks.push(chunk);
+    callback();
+  }
+  public get text(): string {
+    return Buffer.concat(this.chunks).toString();
+  }
+}
+
+describe("exportTo", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  let directory: string;
+  beforeEach(async () => {
+    db = new DuckDB();
+    connection = new Connection(db);
+    directory = mkdtempSync(join(tmpdir(), "node-duckdb-export-"));
+    await connection.executeIterator("CREATE TABLE people(id INTEGER, name VARCHAR, score DOUBLE, active BOOLEAN)");
+    await connection.executeIterator(
+      `INSERT INTO people VALUES (1, 'Mark', 1.5, true), (2, 'Hannes, "the duck"', NULL, false), (3, NULL, -0.25, NULL)`,
+    );
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+    readdirSync(directory).forEach(file => unlinkSync(join(directory, file)));
+    rmdirSync(directory);
+  });
+
+  it("writes CSV to a file", async () => {
+    const path = join(directory, "people.csv");
+    const rowCount = await connection.exportTo("SELECT * FROM people ORDER BY id", { format: "csv", path });
+    expect(rowCount).toBe(3);
+    expect(readFileSync(path, "utf8")).toBe(
+      'id,name,score,active\n1,Mark,1.5,true\n2,"Hannes, ""the duck""",,false\n3,,-0.25,\n',
+    );
+  });
+
+  it("writes NDJSON to a stream", async () => {
+    const writable = new CollectingWritable();
+    const rowCount = await connection.exportTo("SELECT * FROM people ORDER BY id;", { format: "ndjson", writable });
+    expect(rowCount).toBe(3);
+    const rows = writable.text
+      .trim()
+      .split("\n")
+      .map(line => JSON.parse(line));
+    expect(rows).toEqual([
+      { id: 1, name: "Mark", score: 1.5, active: true },
+      { id: 2, name: 'Hannes, "the duck"', score: null, active: false },
+      { id: 3, name: null, score: -0.25, active: null },
+    ]);
+  });
+
+  it("writes large results in batches", async () => {
+    const writable = new CollectingWritable();
+    const query = "SELECT i, 'row ' || i::VARCHAR AS label FROM range(0, 200000) t(i)";
+    const rowCount = await connection.exportTo(query, { format: "csv", writable });
+    expect(rowCount).toBe(200000);
+    expect(writable.chunks.length).toBeGreaterThan(1);
+    const lines = writable.text.split("\n");
+    expect(lines[0]).toBe("i,label");
+    expect(lines[200000]).toBe("199999,row 199999");
+    expect(lines.length).toBe(200002);
+  });
+
+  it("writes FLOAT values at float precision", async () => {
+    const writable = new CollectingWritable();
+    await connection.exportTo("SELECT 0.1::FLOAT AS f, 16777217::FLOAT AS g, 0.1::DOUBLE AS d", {
+      format: "csv",
+      writable,
+    });
+    expect(writable.text).toBe("f,g,d\n0.1,16777216,0.1\n");
+  });
+
+  it("writes the header of an empty result", async () => {
+    const path = join(directory, "empty.csv");
+    expect(await connection.exportTo("SELECT * FROM people WHERE id > 10", { format: "csv", path })).toBe(0);
+    expect(readFileSync(path, "utf8")).toBe("id,name,score,active\n");
+  });
+
+  it("writes Parquet to a file", async () => {
+    const path = join(directory, "people.parquet");
+    const rowCount = await connection.exportTo("SELECT * FROM people;", { format: "parquet", path });
+    expect(rowCount).toBe(3);
+    const result = await connection.executeIterator(`SELECT id, name FROM parquet_scan('${path}') ORDER BY id`, {
+      rowResultFormat: RowResultFormat.Array,
+    });
+    expect(result.fetchAllRows()).toEqual([
+      [1, "Mark"],
+      [2, 'Hannes, "the duck"'],
+      [3, null],
+    ]);
+  });
+
+  it("rejects invalid options", async () => {
+    await expect(connection.exportTo("SELECT 1", <any>{ format: "xml", path: "out.xml" })).rejects.toMatchObject({
+      message: "Invalid format: must be csv, ndjson or parquet",
+    });
+    await expect(connection.exportTo("SELECT 1", { format: "csv" })).rejects.toMatchObject({
+      message: "Exactly one of path and writable must be given",
+    });
+    await expect(
+      connection.exportTo("SELECT 1", { format: "parquet", writable: new CollectingWritable() }),
+    ).rejects.toMatchObject({
+      message: "Parquet can only be exported to a path",
+    });
+  });
+
+  it("closes the result when writing fails", async () => {
+    const pool = new ConnectionPool(db, { size: 1 });
+    const failing = new Writable({
+      write: (_chunk, _encoding, callback) => callback(new Error("disk full")),
+    });
+    await expect(
+      pool.exportTo("SELECT * FROM range(0, 200000)", { format: "ndjson", writable: failing }),
+    ).rejects.toThrow("disk full");
+    expect(pool.idleCount).toBe(1);
+    pool.close();
+  });
+
+  it("rejects when the file can't be written", async () => {
+    const path = join(directory, "missing", "people.csv");
+    await expect(connection.exportTo("SELECT * FROM people", { format: "csv", path })).rejects.toThrow(
+      "Could not open",
+    );
+  });
+});
@@ -0,0 +1,71 @@
+import { Readable } from "stream";
+
+import { Connection, DuckDB } from "@addon";
+import { IColumnarChunk, RowResultFormat } from "@addon-types";
+
+function readStream<T>(rs: Readable): Promise<T[]> {
+  return new Promise((resolve, reject) => {
+    const elements: T[] = [];
+    rs.on("data", (el: any) => elements.push(el));
+    rs.on("error", reject);
+    rs.on("end", () => resolve(elements));
+  });
+}
+
+describe("Columnar fetch", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("returns numeric columns as typed arrays", async () => {
+    const result = await connection.executeIterator(
+      "SELECT CAST(1 AS INTEGER) AS i, CAST(2 AS BIGINT) AS b, CAST(1.5 AS DOUBLE) AS d, true AS t, 'a' AS s",
+    );
+    const chunk = <IColumnarChunk>result.fetchChunk();
+    expect(chunk.rowCount).toBe(1);
+    const [i, b, d, t, s] = chunk.columns;
+    expect(i.name).toBe("i");
+    expect(i.type).toBe("INTEGER");
+    expect(i.data).toEqual(new Int32Array([1]));
+    expect(b.data).toEqual(new BigInt64Array([2n]));
+    expect(d.data).toEqual(new Float64Array([1.5]));
+    expect(t.data).toEqual(new Uint8Array([1]));
+    expect(s.data).toEqual(["a"]);
+    expect(result.fetchChunk()).toBeNull();
+  });
+
+  it("sets validity bitmap", async () => {
+    const result = await connection.executeIterator(
+      "SELECT CASE WHEN i % 3 = 0 THEN NULL ELSE i END AS i FROM range(0, 10) t(i)",
+    );
+    const chunk = <IColumnarChunk>result.fetchChunk();
+    expect(chunk.rowCount).toBe(10);
+    expect(chunk.columns[0].validity).toEqual(new Uint8Array([0b10110110, 0b00000001]));
+  });
+
+  it("continues from the row fetchRow stopped at", async () => {
+    const result = await connection.executeIterator("SELECT * FROM range(0, 5) t(i)", {
+      rowResultFormat: RowResultFormat.Array,
+    });
+    expect(result.fetchRow()).toEqual([0n]);
+    const chunk = <IColumnarChunk>result.fetchChunk();
+    expect(chunk.rowCount).toBe(4);
+    expect(chunk.columns[0].data).toEqual(new BigInt64Array([1n, 2n, 3n, 4n]));
+  });
+
+  it("streams all chunks of a result", async () => {
+    const chunks = await readStream<IColumnarChunk>(
+      await connection.executeColumnar("SELECT * FROM range(0, 5000) t(i)"),
+    );
+    expect(chunks.length).toBeGreaterThan(1);
+    expect(chunks.reduce((rowCount, chunk) => rowCount + chunk.rowCount, 0)).toBe(5000);
+  });
+});
@@ -0,0 +1,67 @@
+import { Connection, DuckDB } from "@addon";
+import { RowResultFormat } from "@addon-types";
+
+const query = "SELECT * FROM range(0, 5000)";
+
+describe("fetchRows", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("returns batches that span chunks", async () => {
+    const result = await connection.executeIterator(query, { rowResultFormat: RowResultFormat.Array });
+    const first = result.fetchRows(3000);
+    expect(first?.length).toBe(3000);
+    expect(first?.[2999]).toEqual([2999n]);
+    const rest = result.fetchRows(3000);
+    expect(rest?.length).toBe(2000);
+    expect(rest?.[0]).toEqual([3000n]);
+    expect(result.fetchRows(3000)).toBeNull();
+  });
+
+  it("returns row objects", async () => {
+    const result = await connection.executeIterator("SELECT 1 AS a, 'x' AS b UNION ALL SELECT 2, 'y'", {
+      forceMaterialized: true,
+    });
+    expect(result.fetchRows(10)).toEqual([
+      { a: 1, b: "x" },
+      { a: 2, b: "y" },
+    ]);
+    expect(result.fetchRows(10)).toBeNull();
+  });
+
+  it("continues after rows read with fetchRow", async () => {
+    const result = await connection.executeIterator(query, { rowResultFormat: RowResultFormat.Array });
+    expect(result.fetchRow()).toEqual([0n]);
+    expect(result.fetchRows(2)).toEqual([[1n], [2n]]);
+    expect(result.fetchAllRows().length).toBe(4997);
+    expect(result.metrics.rowsEmitted).toBe(5000);
+  });
+
+  it("rejects an invalid row count", async () => {
+    const result = await connection.executeIterator(query);
+    expect(() => result.fetchRows(0)).toThrow("Invalid argument: maxRows must be a positive number");
+  });
+
+  it("keeps rows read ahead by the iterator for fetchRow", async () => {
+    const result = await connection.executeIterator(query, { rowResultFormat: RowResultFormat.Array });
+    // eslint-disable-next-line no-loops/no-loops
+    for (const row of result) {
+      expect(row).toEqual([0n]);
+      break;
+    }
+    expect(result.fetchRow()).toEqual([1n]);
+    expect(() => result.fetchChunk()).toThrow(
+      "Cannot fetch a chunk or batch before the rows already read by the iterator",
+    );
+    expect(result.fetchAllRows().length).toBe(4998);
+  });
+});
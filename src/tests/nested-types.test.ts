@@ -0,0 +1,58 @@
+import { Connection, DuckDB } from "@addon";
+import { IListColumnData, RowResultFormat } from "@addon-types";
+
+describe("Nested types", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  const fetchAll = async (query: string) =>
+    (await connection.executeIterator<any[]>(query, { rowResultFormat: RowResultFormat.Array })).fetchAllRows();
+
+  it("converts lists of numbers and strings", async () => {
+    expect(await fetchAll("SELECT LIST_VALUE(1, 2, NULL), LIST_VALUE('a', 'b')")).toEqual([[[1, 2, null], ["a", "b"]]]);
+  });
+
+  it("converts structs with their field names", async () => {
+    expect(await fetchAll("SELECT STRUCT_PACK(url := 'https://a.com', depth := 2, seen := NULL)")).toEqual([
+      [{ url: "https://a.com", depth: 2, seen: null }],
+    ]);
+  });
+
+  it("converts lists of structs across chunks", async () => {
+    const rows = await fetchAll(`SELECT i, LIST(STRUCT_PACK(target := 'https://a.com/' || j, rank := j::INTEGER))
+      FROM range(0, 1500) a(i), range(0, 3) b(j) GROUP BY i ORDER BY i`);
+    expect(rows).toHaveLength(1500);
+    rows.forEach(([i, links]) => {
+      expect(links).toHaveLength(3);
+      expect(links).toContainEqual({ target: "https://a.com/0", rank: 0 });
+      expect(i).toBeDefined();
+    });
+  });
+
+  it("returns null lists and empty lists", async () => {
+    expect(await fetchAll("SELECT NULL::INTEGER[] UNION ALL SELECT []::INTEGER[]")).toEqual(
+      expect.arrayContaining([[null], [[]]]),
+    );
+  });
+
+  it("returns list columns Arrow style in columnar form", async () => {
+    const result = await connection.executeIterator(
+      "SELECT CASE WHEN i = 1 THEN NULL ELSE LIST_VALUE(i::INTEGER, i::INTEGER * 10) END AS l FROM range(0, 3) t(i)",
+    );
+    const chunk = await result.fetchChunkAsync();
+    const column = <IListColumnData>chunk?.columns[0].data;
+    expect(column.length).toBe(3);
+    expect(column.offsets).toEqual(new Int32Array([0, 2, 2, 4]));
+    expect(column.values).toEqual(new Int32Array([0, 0, 2, 20]));
+    expect(chunk?.columns[0].validity).toEqual(new Uint8Array([0b101]));
+  });
+});
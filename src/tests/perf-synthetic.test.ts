@@ -22,10 +22,9 @@ describe("Perfomance test suite against synthetic data set", () => {
     await writeSyntheticParquetFile(filePath, 1000, true);
   });
 
-  beforeEach(async () => {
-    db = new DuckDB();
+  beforeEach(() => {
+    db = new DuckDB({ options: { threads: 4 } });
     connection = new Connection(db);
-    await connection.executeIterator("PRAGMA threads=4;");
   });
 
   afterEach(() => {
@@ -9,10 +9,9 @@ import { Connection, DuckDB } from "@addon";
 describe.skip("Perfomance test suite", () => {
   let db: DuckDB;
   let connection: Connection;
-  beforeEach(async () => {
-    db = new DuckDB();
+  beforeEach(() => {
+    db = new DuckDB({ options: { threads: 4 } });
     connection = new Connection(db);
-    await connection.executeIterator("PRAGMA threads=4;");
   });
 
   afterEach(() => {
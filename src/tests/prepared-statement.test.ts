@@ -0,0 +1,103 @@
+import { Connection, DuckDB } from "@addon";
+import { RowResultFormat } from "@addon-types";
+
+describe("Prepared statements", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(async () => {
+    db = new DuckDB();
+    connection = new Connection(db);
+    await connection.executeIterator(
+      "CREATE TABLE people(id INTEGER, big BIGINT, score DOUBLE, name VARCHAR, data BLOB, created TIMESTAMP);",
+    );
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("binds parameters of all supported types", async () => {
+    const insert = await connection.prepare("INSERT INTO people VALUES (?, ?, ?, ?, ?, ?);");
+    expect(insert.parameterCount).toBe(6);
+    await insert.executeIterator([1, 9007199254740993n, 0.5, "Mark", Buffer.from("abc"), new Date(Date.UTC(2021, 0, 1))]);
+    await insert.executeIterator([2, null, undefined, null, null, null]);
+    insert.close();
+
+    const result = await connection.executeIterator("SELECT * FROM people ORDER BY id;", {
+      rowResultFormat: RowResultFormat.Array,
+    });
+    expect(result.fetchAllRows()).toEqual([
+      [1, 9007199254740993n, 0.5, "Mark", Buffer.from("abc"), Date.UTC(2021, 0, 1)],
+      [2, null, null, null, null, null],
+    ]);
+  });
+
+  it("reuses the statement with different parameters", async () => {
+    await connection.executeIterator("INSERT INTO people (id, name) VALUES (1, 'Mark'), (2, 'Hannes'), (3, 'Bob');");
+    const select = await connection.prepare("SELECT name FROM people WHERE id = ?;");
+    const names: string[] = [];
+    // eslint-disable-next-line no-loops/no-loops
+    for (const id of [3, 1, 2]) {
+      const result = await select.executeIterator<{ name: string }>([id]);
+      names.push(result.fetchRow().name);
+    }
+    expect(names).toEqual(["Bob", "Mark", "Hannes"]);
+  });
+
+  it("does not interpret string parameters as SQL", async () => {
+    await connection.executeIterator("INSERT INTO people (id, name) VALUES (1, 'Mark');");
+    const select = await connection.prepare("SELECT COUNT(*) AS c FROM people WHERE name = ?;");
+    const result = await select.executeIterator<{ c: bigint }>(["Mark' OR '1'='1"]);
+    expect(result.fetchRow()).toEqual({ c: 0n });
+  });
+
+  it("supports streaming results", async () => {
+    const select = await connection.prepare("SELECT * FROM range(0, ?) t(i);");
+    const stream = await select.execute([3000], { rowResultFormat: RowResultFormat.Array });
+    let count = 0;
+    // eslint-disable-next-line no-loops/no-loops
+    for await (const _row of stream) {
+      count++;
+    }
+    expect(count).toBe(3000);
+  });
+
+  it("rejects invalid statements", async () => {
+    await expect(connection.prepare("SELEC 1;")).rejects.toThrow("syntax error");
+  });
+
+  it("rejects wrong parameter count and unsupported parameter types", async () => {
+    const select = await connection.prepare("SELECT * FROM people WHERE id = ?;");
+    await expect(select.executeIterator([])).rejects.toThrow("Expected 1 parameters, got 0");
+    // eslint-disable-next-line @typescript-eslint/no-explicit-any
+    await expect(select.executeIterator([<any>{}])).rejects.toThrow(
+      "Invalid parameter at index 0: unsupported type",
+    );
+  });
+
+  it("binds BigInts up to the HUGEINT range", async () => {
+    const select = await connection.prepare("SELECT ?::VARCHAR;");
+    const bind = async (value: bigint) =>
+      (await select.executeIterator([value], { rowResultFormat: RowResultFormat.Array })).fetchRow();
+    expect(await bind(2n ** 127n - 1n)).toEqual([(2n ** 127n - 1n).toString()]);
+    expect(await bind(-(2n ** 127n))).toEqual([(-(2n ** 127n)).toString()]);
+    const outOfRange = "Invalid parameter at index 0: BigInt exceeds HUGEINT range";
+    await expect(bind(2n ** 127n)).rejects.toThrow(outOfRange);
+    await expect(bind(-(2n ** 127n) - 1n)).rejects.toThrow(outOfRange);
+    await expect(bind(2n ** 128n)).rejects.toThrow(outOfRange);
+  });
+
+  it("rejects invalid Dates", async () => {
+    const select = await connection.prepare("SELECT ?;");
+    await expect(select.executeIterator([new Date(NaN)])).rejects.toThrow("Invalid parameter at index 0: invalid Date");
+  });
+
+  it("rejects execution after close", async () => {
+    const select = await connection.prepare("SELECT 1;");
+    expect(select.isClosed).toBe(false);
+    select.close();
+    expect(select.isClosed).toBe(true);
+    await expect(select.executeIterator()).rejects.toThrow("Prepared statement is closed");
+  });
+});
@@ -0,0 +1,101 @@
+import { Connection, DuckDB, QueryCancelledError } from "@addon";
+import { IAbortSignal } from "@addon-types";
+
+const longQuery = "SELECT COUNT(*) FROM range(0, 100000000000) t1";
+// runs for a while but finishes
+const slowQuery = "SELECT COUNT(*) AS n FROM range(0, 30000000) t1, range(0, 10) t2";
+
+// Node 12 has no global AbortController
+class TestAbortSignal implements IAbortSignal {
+  public aborted = false;
+  private listeners: (() => void)[] = [];
+  public addEventListener(_type: "abort", listener: () => void): void {
+    this.listeners.push(listener);
+  }
+  public removeEventListener(_type: "abort", listener: () => void): void {
+    this.listeners = this.listeners.filter(l => l !== listener);
+  }
+  public abort(): void {
+    this.aborted = true;
+    this.listeners.forEach(listener => listener());
+  }
+}
+
+describe("Query cancellation", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("cancels a query after timeoutMs", async () => {
+    const start = Date.now();
+    await expect(connection.executeIterator(longQuery, { forceMaterialized: true, timeoutMs: 100 })).rejects.toEqual(
+      new QueryCancelledError("timeout"),
+    );
+    expect(Date.now() - start).toBeLessThan(5000);
+    // the connection can be used afterwards
+    const result = await connection.executeIterator("SELECT 1 AS a", { timeoutMs: 1000 });
+    expect(result.fetchAllRows()).toEqual([{ a: 1 }]);
+  });
+
+  it("cancels a query when the signal is aborted", async () => {
+    const signal = new TestAbortSignal();
+    const promise = connection.executeIterator(longQuery, { forceMaterialized: true, signal });
+    setTimeout(() => signal.abort(), 100);
+    await expect(promise).rejects.toMatchObject({ reason: "abort", code: "ERR_DUCKDB_QUERY_CANCELLED" });
+  });
+
+  it("does not run a query whose signal is already aborted", async () => {
+    const signal = new TestAbortSignal();
+    signal.abort();
+    await expect(connection.executeIterator("SELECT 1", { signal })).rejects.toBeInstanceOf(QueryCancelledError);
+  });
+
+  it("cancels streaming results while they are read", async () => {
+    const result = await connection.executeIterator("SELECT * FROM range(0, 100000000000) t1", { timeoutMs: 100 });
+    await expect(
+      (async () => {
+        // eslint-disable-next-line no-loops/no-loops, @typescript-eslint/no-unused-vars
+        for await (const _row of result) {
+          // keep reading
+        }
+      })(),
+    ).rejects.toEqual(new QueryCancelledError("timeout"));
+    expect(result.isClosed).toBe(true);
+  });
+
+  it("keeps a running query when a queued one times out", async () => {
+    const slow = connection.executeIterator(slowQuery, { forceMaterialized: true });
+    const queued = connection.executeIterator("SELECT 1", { timeoutMs: 1 });
+    await expect(queued).rejects.toEqual(new QueryCancelledError("timeout"));
+    expect((await slow).fetchAllRows()).toEqual([{ n: 300000000n }]);
+  });
+
+  it("disarms the timeout once a result is materialized", async () => {
+    const result = await connection.executeIterator("SELECT 1 AS a", { forceMaterialized: true, timeoutMs: 10 });
+    await new Promise(resolve => setTimeout(resolve, 50));
+    expect(result.isClosed).toBe(false);
+    expect(result.fetchAllRows()).toEqual([{ a: 1 }]);
+  });
+
+  it("does not cancel the next query with the timeout of an executed batch", async () => {
+    await connection.executeBatch("SELECT 1", { timeoutMs: 50 });
+    const slow = connection.executeIterator(slowQuery, { forceMaterialized: true });
+    expect((await slow).fetchAllRows()).toEqual([{ n: 300000000n }]);
+  });
+
+  it("interrupts running and queued queries manually", async () => {
+    const running = connection.executeIterator(longQuery, { forceMaterialized: true });
+    const queued = connection.executeIterator(longQuery, { forceMaterialized: true });
+    setTimeout(() => connection.interrupt(), 100);
+    await expect(running).rejects.toEqual(new QueryCancelledError("interrupt"));
+    await expect(queued).rejects.toEqual(new QueryCancelledError("interrupt"));
+  });
+});
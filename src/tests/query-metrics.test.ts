@@ -0,0 +1,100 @@
+import { Connection, DuckDB } from "@addon";
+import { IQueryProfile, IQueryProfileNode, RowResultFormat } from "@addon-types";
+
+const query = "SELECT i, i::VARCHAR AS s FROM range(0, 5000) t(i)";
+
+function operatorNames(node: IQueryProfileNode): string[] {
+  return [node.name, ...node.children.flatMap(operatorNames)];
+}
+
+describe("Query metrics", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("counts the rows and bytes read with fetchRow", async () => {
+    const result = await connection.executeIterator(query, { rowResultFormat: RowResultFormat.Array });
+    expect(result.metrics.rowsEmitted).toBe(0);
+    result.fetchAllRows();
+    const metrics = result.metrics;
+    expect(metrics.rowsEmitted).toBe(5000);
+    expect(metrics.chunksFetched).toBe(5);
+    // 8 bytes per BIGINT plus the length of the strings
+    expect(metrics.bytesEmitted).toBe(5000 * 8 + 18890);
+    expect(metrics.queueWaitMs).toBeGreaterThanOrEqual(0);
+    expect(metrics.executeMs).toBeGreaterThanOrEqual(0);
+    expect(metrics.fetchMs).toBeGreaterThan(0);
+    expect(metrics.conversionMs).toBeGreaterThan(0);
+  });
+
+  it("counts only the bytes of the rows read so far", async () => {
+    const result = await connection.executeIterator(query, { rowResultFormat: RowResultFormat.Array });
+    result.fetchRows(10);
+    // rows 0 to 9 hold single digit strings
+    expect(result.metrics.bytesEmitted).toBe(10 * 8 + 10);
+    result.close();
+  });
+
+  it("counts the rows read asynchronously in columnar form", async () => {
+    const result = await connection.executeIterator(query);
+    let rowCount = 0;
+    // eslint-disable-next-line no-loops/no-loops
+    for await (const chunk of result.chunksAsync()) {
+      rowCount += chunk.rowCount;
+    }
+    expect(result.metrics.rowsEmitted).toBe(rowCount);
+    expect(result.metrics.chunksFetched).toBe(5);
+    expect(result.metrics.fetchMs).toBeGreaterThan(0);
+  });
+
+  it("counts the bytes of Arrow batches", async () => {
+    const result = await connection.executeIterator(query);
+    let byteCount = 0;
+    // eslint-disable-next-line no-loops/no-loops
+    for await (const batch of result.arrowBatches()) {
+      byteCount += batch.length;
+    }
+    expect(result.metrics.rowsEmitted).toBe(5000);
+    expect(result.metrics.bytesEmitted).toBe(byteCount);
+  });
+
+  it("returns no profile by default", async () => {
+    const result = await connection.executeIterator(query, { forceMaterialized: true });
+    expect(result.profile).toBeNull();
+  });
+
+  it("returns the profile of a materialized result", async () => {
+    const result = await connection.executeIterator("SELECT count(*) FROM range(0, 5000)", {
+      forceMaterialized: true,
+      profile: true,
+    });
+    const profile = <IQueryProfile>result.profile;
+    expect(typeof profile.result).toBe("number");
+    expect(operatorNames(profile.tree).length).toBeGreaterThan(1);
+  });
+
+  it("returns the profile of a streaming result once it is read", async () => {
+    const result = await connection.executeIterator("SELECT count(*) FROM range(0, 5000)", {
+      rowResultFormat: RowResultFormat.Array,
+      profile: true,
+    });
+    expect(result.profile).toBeNull();
+    expect(result.fetchAllRows()).toEqual([[5000n]]);
+    expect(result.profile?.tree.cardinality).toBe(1);
+  });
+
+  it("only profiles the queries asking for it", async () => {
+    const profiled = await connection.executeIterator("SELECT 1", { forceMaterialized: true, profile: true });
+    expect(profiled.profile).not.toBeNull();
+    const result = await connection.executeIterator("SELECT 1", { forceMaterialized: true });
+    expect(result.profile).toBeNull();
+  });
+});
@@ -0,0 +1,76 @@
+import { promises as fs } from "fs";
+
+import { Connection, DuckDB, QueryCancelledError } from "@addon";
+
+const longQuery = "SELECT COUNT(*) FROM range(0, 100000000000) t1";
+
+// runs a query that keeps its query thread busy for durationMs
+const occupyQueryThread = (db: DuckDB, durationMs: number): Promise<void> => {
+  const connection = new Connection(db);
+  return expect(connection.executeIterator(longQuery, { forceMaterialized: true, timeoutMs: durationMs }))
+    .rejects.toEqual(new QueryCancelledError("timeout"))
+    .finally(() => connection.close());
+};
+
+describe("Query thread pool", () => {
+  it("has 4 threads by default", () => {
+    const db = new DuckDB();
+    expect(db.queryThreadPoolSize).toBe(4);
+    db.close();
+  });
+
+  it("allows to specify the number of threads", () => {
+    const db = new DuckDB({ options: { queryThreadPoolSize: 8 } });
+    expect(db.queryThreadPoolSize).toBe(8);
+    db.close();
+  });
+
+  it("does not allow to specify invalid number of threads", () => {
+    expect(() => new DuckDB(<any>{ options: { queryThreadPoolSize: "invalid" } })).toThrow(
+      "Invalid queryThreadPoolSize: must be a number",
+    );
+    expect(() => new DuckDB({ options: { queryThreadPoolSize: -1 } })).toThrow(
+      "Invalid queryThreadPoolSize: must not be negative",
+    );
+  });
+
+  it("queues queries when all threads are busy", async () => {
+    const db = new DuckDB({ options: { queryThreadPoolSize: 1 } });
+    // the only thread runs this one until it times out
+    const busy = occupyQueryThread(db, 1000);
+    const connection = new Connection(db);
+    const iterator = await connection.executeIterator("SELECT 1 AS i", { forceMaterialized: true });
+    await busy;
+    expect(iterator.metrics.queueWaitMs).toBeGreaterThanOrEqual(900);
+    expect(iterator.fetchAllRows()).toEqual([{ i: 1 }]);
+    connection.close();
+    db.close();
+  });
+
+  it("runs queries on the libuv threadpool without threads", async () => {
+    const db = new DuckDB({ options: { queryThreadPoolSize: 0 } });
+    expect(db.queryThreadPoolSize).toBe(0);
+    const connections = [new Connection(db), new Connection(db)];
+    const results = await Promise.all(
+      connections.map(async (connection, i) => {
+        const iterator = await connection.executeIterator(`SELECT ${i} AS i`);
+        return iterator.fetchAllRows();
+      }),
+    );
+    expect(results).toEqual([[{ i: 0 }], [{ i: 1 }]]);
+    await occupyQueryThread(db, 100);
+    connections.forEach(connection => connection.close());
+    db.close();
+  });
+
+  it("does not hold up fs operations while queries run", async () => {
+    // more long queries than the libuv threadpool has threads
+    const db = new DuckDB({ options: { queryThreadPoolSize: 6 } });
+    const queries = Promise.all([0, 1, 2, 3, 4, 5].map(() => occupyQueryThread(db, 3000)));
+    const start = Date.now();
+    await fs.readFile(__filename);
+    expect(Date.now() - start).toBeLessThan(1000);
+    await queries;
+    db.close();
+  });
+});
@@ -0,0 +1,158 @@
+import { Appender, Connection, DuckDB } from "@addon";
+import { IExecuteOptions, RowResultFormat } from "@addon-types";
+
+const materialized: IExecuteOptions = { forceMaterialized: true, rowResultFormat: RowResultFormat.Array };
+
+describe("Result cache", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(async () => {
+    db = new DuckDB({ options: { resultCacheSize: 1024 * 1024 } });
+    connection = new Connection(db);
+    await connection.executeIterator("CREATE TABLE t(i INTEGER, s VARCHAR)");
+    await connection.executeIterator("INSERT INTO t SELECT i, 'row ' || i FROM range(0, 3000) r(i)");
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  const fetchAll = async (query: string, options: IExecuteOptions = materialized) =>
+    (await connection.executeIterator(query, options)).fetchAllRows();
+
+  it("is disabled by default", async () => {
+    const otherDb = new DuckDB();
+    expect(otherDb.resultCacheStats).toBeNull();
+    otherDb.close();
+  });
+
+  it("answers repeated queries from the cache", async () => {
+    const rows = await fetchAll("SELECT * FROM t ORDER BY i");
+    expect(rows).toHaveLength(3000);
+    expect(db.resultCacheStats).toMatchObject({ hits: 0, misses: 1, entries: 1 });
+    // formatting and a trailing semicolon don't matter
+    expect(await fetchAll("SELECT *\n  FROM t  ORDER BY i;")).toEqual(rows);
+    const stats = db.resultCacheStats;
+    expect(stats).toMatchObject({ hits: 1, misses: 1, entries: 1 });
+    expect(stats?.bytes).toBeGreaterThan(0);
+  });
+
+  it("serves each hit its own result", async () => {
+    await fetchAll("SELECT * FROM t ORDER BY i");
+    const first = await connection.executeIterator("SELECT * FROM t ORDER BY i", materialized);
+    const second = await connection.executeIterator("SELECT * FROM t ORDER BY i", materialized);
+    expect(first.fetchRow()).toEqual([0, "row 0"]);
+    expect(second.fetchAllRows()).toHaveLength(3000);
+    expect(first.fetchAllRows()).toHaveLength(2999);
+    expect(db.resultCacheStats?.hits).toBe(2);
+  });
+
+  it("tells string literals and parameters apart", async () => {
+    expect(await fetchAll("SELECT 'a  b'")).toEqual([["a  b"]]);
+    expect(await fetchAll("SELECT 'a b'")).toEqual([["a b"]]);
+    const statement = await connection.prepare("SELECT s FROM t WHERE i = ?");
+    const execute = async (parameter: number) =>
+      (await statement.executeIterator([parameter], materialized)).fetchAllRows();
+    expect(await execute(1)).toEqual([["row 1"]]);
+    expect(await execute(2)).toEqual([["row 2"]]);
+    expect(await execute(1)).toEqual([["row 1"]]);
+    expect(db.resultCacheStats).toMatchObject({ hits: 1, misses: 4 });
+    statement.close();
+  });
+
+  it("is invalidated by writes", async () => {
+    const query = "SELECT count(*) FROM t";
+    expect(await fetchAll(query)).toEqual([[3000n]]);
+    await connection.executeIterator("DELETE FROM t WHERE i < 1000");
+    expect(db.resultCacheStats).toMatchObject({ invalidations: 1, entries: 0 });
+    expect(await fetchAll(query)).toEqual([[2000n]]);
+    await connection.executeBatch("INSERT INTO t VALUES (1, 'a'); SELECT 1");
+    expect(await fetchAll(query)).toEqual([[2001n]]);
+    const appender = await Appender.open(connection, "t");
+    appender.appendRows([[2, "b"]]);
+    await appender.close();
+    expect(await fetchAll(query)).toEqual([[2002n]]);
+    expect(db.resultCacheStats).toMatchObject({ hits: 0, misses: 4, invalidations: 3 });
+  });
+
+  it("is bypassed within transactions", async () => {
+    const query = "SELECT count(*) FROM t";
+    await fetchAll(query);
+    await connection.executeIterator("BEGIN TRANSACTION");
+    await connection.executeIterator("INSERT INTO t VALUES (1, 'a')");
+    expect(await fetchAll(query)).toEqual([[3001n]]);
+    await connection.executeIterator("ROLLBACK");
+    expect(await fetchAll(query)).toEqual([[3000n]]);
+    await fetchAll(query);
+    expect(db.resultCacheStats).toMatchObject({ hits: 1, misses: 2 });
+  });
+
+  it("is bypassed by connections with temporary objects", async () => {
+    const query = "SELECT count(*) FROM t";
+    const other = new Connection(db);
+    // shadows t for the other connection only
+    await other.registerTable("t", [{ name: "i", type: "INTEGER" }], [[1]]);
+    expect(await fetchAll(query)).toEqual([[3000n]]);
+    expect((await other.executeIterator(query, materialized)).fetchAllRows()).toEqual([[1n]]);
+    expect(await fetchAll(query)).toEqual([[3000n]]);
+    expect(db.resultCacheStats).toMatchObject({ hits: 1, misses: 1 });
+    other.close();
+  });
+
+  it("skips queries calling volatile and JS functions", async () => {
+    await fetchAll("SELECT random()");
+    await fetchAll("SELECT now()");
+    await connection.registerFunction("plus_one", ["INTEGER"], "INTEGER", (values: unknown[]) =>
+      values.map(value => <number>value + 1),
+    );
+    expect(await fetchAll("SELECT plus_one(i) FROM t WHERE i = 1")).toEqual([[2]]);
+    expect(await fetchAll("SELECT PLUS_ONE(i) FROM t WHERE i = 1")).toEqual([[2]]);
+    expect(db.resultCacheStats).toMatchObject({ hits: 0, misses: 0, entries: 0 });
+    // the names only count as words, not inside string literals
+    await fetchAll("SELECT 'random' AS s");
+    expect(db.resultCacheStats?.entries).toBe(1);
+  });
+
+  it("copies BLOBs of cached results", async () => {
+    const query = "SELECT repeat('a', 300)::BLOB";
+    const [[first]] = <Buffer[][]>await fetchAll(query);
+    first.fill("b");
+    const [[hit]] = <Buffer[][]>await fetchAll(query);
+    expect(hit.toString()).toBe("a".repeat(300));
+    hit.fill("c");
+    const [[again]] = <Buffer[][]>await fetchAll(query);
+    expect(again.toString()).toBe("a".repeat(300));
+    expect(db.resultCacheStats).toMatchObject({ hits: 2, misses: 1 });
+  });
+
+  it("evicts the least recently used results", async () => {
+    const smallDb = new DuckDB({ options: { resultCacheSize: 20000 } });
+    const smallConnection = new Connection(smallDb);
+    const run = async (query: string) =>
+      (await smallConnection.executeIterator(query, materialized)).fetchAllRows();
+    // 8000 bytes each
+    await run("SELECT * FROM range(0, 1000)");
+    await run("SELECT * FROM range(1000, 2000)");
+    await run("SELECT * FROM range(0, 1000)");
+    await run("SELECT * FROM range(2000, 3000)");
+    expect(smallDb.resultCacheStats).toMatchObject({ evictions: 1, entries: 2, bytes: 16000 });
+    await run("SELECT * FROM range(0, 1000)");
+    expect(smallDb.resultCacheStats).toMatchObject({ hits: 2, misses: 3 });
+    // larger than the whole cache
+    await run("SELECT * FROM range(0, 5000)");
+    expect(smallDb.resultCacheStats?.entries).toBe(2);
+    smallConnection.close();
+    smallDb.close();
+  });
+
+  it("skips queries that opt out and streaming results", async () => {
+    const query = "SELECT * FROM t";
+    await fetchAll(query, { ...materialized, cache: false });
+    await fetchAll(query, { rowResultFormat: RowResultFormat.Array });
+    expect(db.resultCacheStats).toMatchObject({ misses: 1, entries: 0 });
+    await fetchAll(query);
+    db.clearResultCache();
+    expect(db.resultCacheStats?.entries).toBe(0);
+  });
+});
@@ -45,6 +45,39 @@ describe("Result format", () => {
     expect(result.fetchRow()).toEqual(arrayResult);
   });
 
+  it("creates plain row objects with the columns in order", async () => {
+    const result = await connection.executeIterator("SELECT i, i * 2 AS doubled, 'x' AS s FROM range(0, 3) t(i)");
+    const rows = result.fetchAllRows();
+    expect(rows).toEqual([
+      { i: 0n, doubled: 0n, s: "x" },
+      { i: 1n, doubled: 2n, s: "x" },
+      { i: 2n, doubled: 4n, s: "x" },
+    ]);
+    const row = <Record<string, unknown>>rows[0];
+    expect(Object.keys(row)).toEqual(["i", "doubled", "s"]);
+    expect(Object.getOwnPropertyDescriptor(row, "s")).toEqual({
+      value: "x",
+      writable: true,
+      enumerable: true,
+      configurable: true,
+    });
+    row.s = "y";
+    delete row.doubled;
+    expect(row).toEqual({ i: 0n, s: "y" });
+  });
+
+  it("creates the same row objects when fetched asynchronously", async () => {
+    const result = await connection.executeIterator("SELECT i, 'x' AS s FROM range(0, 2000) t(i)");
+    const rows = [];
+    // eslint-disable-next-line no-loops/no-loops
+    for await (const row of result) {
+      rows.push(row);
+    }
+    expect(rows.length).toBe(2000);
+    expect(rows[1999]).toEqual({ i: 1999n, s: "x" });
+    expect(Object.keys(<object>rows[1500])).toEqual(["i", "s"]);
+  });
+
   it("throws when the parameter is of wrong type", async () => {
     await expect(connection.executeIterator(query, <any>{ rowResultFormat: 10 })).rejects.toMatchObject({
       message: "Invalid rowResultFormat: must be of appropriate enum type",
@@ -0,0 +1,159 @@
+import { Connection, DuckDB } from "@addon";
+import { ColumnData, RowResultFormat } from "@addon-types";
+
+const executeOptions = { rowResultFormat: RowResultFormat.Array };
+
+describe("JS functions", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("calls a scalar function once per chunk with typed arrays", async () => {
+    const chunkSizes: number[] = [];
+    await connection.registerFunction("times_two", ["INTEGER"], "INTEGER", (values: ColumnData) => {
+      chunkSizes.push(values.length);
+      return (<Int32Array>values).map(value => value * 2);
+    });
+    const result = await connection.executeIterator(
+      "SELECT times_two(CAST(range AS INTEGER)) FROM range(0, 3000)",
+      executeOptions,
+    );
+    const rows = result.fetchAllRows();
+    expect(rows.length).toBe(3000);
+    expect(rows[2999]).toEqual([5998]);
+    expect(chunkSizes.reduce((sum, size) => sum + size, 0)).toBe(3000);
+    expect(chunkSizes.length).toBeLessThan(10);
+  });
+
+  it("passes and returns strings and nulls", async () => {
+    await connection.registerFunction("host_of", ["VARCHAR"], "VARCHAR", (urls: ColumnData) =>
+      (<unknown[]>urls).map(url => (url === null ? "none" : new URL(<string>url).host)),
+    );
+    const result = await connection.executeIterator(
+      "SELECT host_of(url) FROM (VALUES ('https://example.com/a'), (NULL), ('http://test.org')) pages(url)",
+      { ...executeOptions, forceMaterialized: true },
+    );
+    expect(result.fetchAllRows()).toEqual([["example.com"], [null], ["test.org"]]);
+  });
+
+  it("takes several arguments", async () => {
+    await connection.registerFunction("add", ["DOUBLE", "DOUBLE"], "DOUBLE", (a: ColumnData, b: ColumnData) =>
+      (<Float64Array>a).map((value, i) => value + (<Float64Array>b)[i]),
+    );
+    const result = await connection.executeIterator("SELECT add(1.5, 2)", executeOptions);
+    expect(result.fetchRow()).toEqual([3.5]);
+  });
+
+  it("rejects synchronous fetches while a prefetch of a query calling a function runs", async () => {
+    await connection.registerFunction("times_two", ["INTEGER"], "INTEGER", (values: ColumnData) =>
+      (<Int32Array>values).map(value => value * 2),
+    );
+    const result = await connection.executeIterator("SELECT times_two(CAST(range AS INTEGER)) FROM range(0, 5000)", {
+      ...executeOptions,
+      prefetchChunkCount: 1,
+    });
+    let rowCount = (await result.fetchChunkAsync())?.rowCount ?? 0;
+    // the prefetch started by the async fetch waits for this thread to call the function
+    expect(() => result.fetchRow()).toThrow("Cannot fetch synchronously from a query calling a JS function");
+    let chunk = await result.fetchChunkAsync();
+    // eslint-disable-next-line no-loops/no-loops
+    while (chunk) {
+      rowCount += chunk.rowCount;
+      chunk = await result.fetchChunkAsync();
+    }
+    expect(rowCount).toBe(5000);
+  });
+
+  it("rejects synchronous fetches of queries calling a function on several threads", async () => {
+    const threadedDb = new DuckDB({ options: { threads: 2 } });
+    const threadedConnection = new Connection(threadedDb);
+    await threadedConnection.registerFunction("times_two", ["INTEGER"], "INTEGER", (values: ColumnData) =>
+      (<Int32Array>values).map(value => value * 2),
+    );
+    const query = "SELECT TIMES_TWO(CAST(range AS INTEGER)) FROM range(0, 5000)";
+    const streamed = await threadedConnection.executeIterator(query, executeOptions);
+    expect(() => streamed.fetchRow()).toThrow("Cannot fetch synchronously from a query calling a JS function");
+    streamed.close();
+    const materialized = await threadedConnection.executeIterator(query, {
+      ...executeOptions,
+      forceMaterialized: true,
+    });
+    expect(materialized.fetchAllRows()).toHaveLength(5000);
+    threadedConnection.close();
+    threadedDb.close();
+  });
+
+  it("fails the query when the function throws", async () => {
+    await connection.registerFunction("fail", ["INTEGER"], "INTEGER", () => {
+      throw new Error("no way");
+    });
+    await expect(connection.executeIterator("SELECT fail(1)", { forceMaterialized: true })).rejects.toThrow(
+      "fail: no way",
+    );
+  });
+
+  it("fails the query when the function returns numbers that don't fit the type", async () => {
+    await connection.registerFunction("too_big", ["INTEGER"], "TINYINT", (values: ColumnData) =>
+      Array.from(<Int32Array>values, value => value * 100),
+    );
+    const query = "SELECT too_big(CAST(range AS INTEGER)) FROM range(0, 3)";
+    await expect(connection.executeIterator(query, { forceMaterialized: true })).rejects.toThrow("too_big: Invalid value for the result at row 2: 200 doesn't fit TINYINT");
+    await connection.registerFunction("fraction", ["DOUBLE"], "BIGINT", (values: ColumnData) => values);
+    await expect(connection.executeIterator("SELECT fraction(0.5)", { forceMaterialized: true })).rejects.toThrow(
+      "fraction: Invalid value for the result at row 0: 0.5 doesn't fit BIGINT",
+    );
+  });
+
+  it("rejects unknown types", async () => {
+    await expect(connection.registerFunction("f", ["NOT_A_TYPE"], "INTEGER", () => [])).rejects.toThrow(
+      "Invalid type: NOT_A_TYPE",
+    );
+  });
+
+  it("registers a table from an async iterable", async () => {
+    async function* pages() {
+      // eslint-disable-next-line no-loops/no-loops
+      for (let i = 0; i < 2500; i += 1) {
+        yield [i, `https://example.com/${i}`];
+      }
+    }
+    const rowCount = await connection.registerTable(
+      "pages",
+      [
+        { name: "id", type: "INTEGER" },
+        { name: "url", type: "VARCHAR" },
+      ],
+      pages(),
+    );
+    expect(rowCount).toBe(2500);
+    const result = await connection.executeIterator(
+      "SELECT count(*), max(url) FROM pages WHERE id >= 2000",
+      executeOptions,
+    );
+    expect(result.fetchRow()).toEqual([500n, "https://example.com/2499"]);
+  });
+
+  it("drops the table when the iterable throws", async () => {
+    async function* pages() {
+      // eslint-disable-next-line no-loops/no-loops
+      for (let i = 0; i < 2500; i += 1) {
+        yield [i];
+      }
+      throw new Error("crawl failed");
+    }
+    await expect(connection.registerTable("pages", [{ name: "id", type: "INTEGER" }], pages())).rejects.toThrow(
+      "crawl failed",
+    );
+    await expect(connection.executeIterator("SELECT count(*) FROM pages")).rejects.toThrow("pages");
+    // the name can be registered again
+    expect(await connection.registerTable("pages", [{ name: "id", type: "INTEGER" }], [[1]])).toBe(1);
+  });
+});
@@ -0,0 +1,70 @@
+import { Connection, DuckDB } from "@addon";
+import { IDictionaryColumnData, RowResultFormat } from "@addon-types";
+
+const query = `SELECT CASE WHEN i % 5 = 4 THEN NULL WHEN i % 3 = 0 THEN 'text/html' WHEN i % 3 = 1 THEN 'image/png'
+  ELSE 'text/css' END AS type, i FROM range(0, 3000) t(i)`;
+
+describe("String interning", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("returns the same rows as without interning", async () => {
+    const expected = await (await connection.executeIterator(query)).fetchAllRows();
+    const interned = await (await connection.executeIterator(query, { internStrings: true })).fetchAllRows();
+    expect(interned).toEqual(expected);
+  });
+
+  it("interns values across chunks", async () => {
+    const result = await connection.executeIterator<any[]>(
+      "SELECT 'https://a.com/' || (i % 2) FROM range(0, 4000) t(i)",
+      { internStrings: true, rowResultFormat: RowResultFormat.Array },
+    );
+    const values = new Set(result.fetchAllRows().map(([url]) => url));
+    expect([...values].sort()).toEqual(["https://a.com/0", "https://a.com/1"]);
+  });
+
+  it("returns VARCHAR columns as a dictionary and codes in columnar form", async () => {
+    const result = await connection.executeIterator(query, { internStrings: true });
+    const chunk = await result.fetchChunkAsync();
+    const column = chunk?.columns[0];
+    const data = <IDictionaryColumnData>column?.data;
+    expect(data.length).toBe(1024);
+    expect(data.codes).toHaveLength(1024);
+    expect([...data.dictionary].sort()).toEqual(["image/png", "text/css", "text/html"]);
+    const values = [...data.codes].map((code, i) =>
+      (column?.validity[i >> 3] ?? 0) & (1 << (i & 7)) ? data.dictionary[code] : null,
+    );
+    expect(values.slice(0, 6)).toEqual(["text/html", "image/png", "text/css", "text/html", null, "text/css"]);
+    expect(chunk?.columns[1].data).toBeInstanceOf(BigInt64Array);
+  });
+
+  it("keeps high cardinality columns correct", async () => {
+    const rows = await (
+      await connection.executeIterator<any[]>("SELECT 'page-' || i FROM range(0, 70000) t(i)", {
+        internStrings: true,
+        rowResultFormat: RowResultFormat.Array,
+      })
+    ).fetchAllRows();
+    expect(rows).toHaveLength(70000);
+    expect(rows[69999]).toEqual(["page-69999"]);
+  });
+
+  it("keeps long distinct values correct past the interned byte limit", async () => {
+    const result = await connection.executeIterator<any[]>(
+      "SELECT i::VARCHAR || repeat('x', 1000) FROM range(0, 20000) t(i)",
+      { internStrings: true, rowResultFormat: RowResultFormat.Array },
+    );
+    const rows = result.fetchAllRows();
+    expect(rows).toHaveLength(20000);
+    expect(rows[19999][0]).toBe(`19999${"x".repeat(1000)}`);
+  });
+});
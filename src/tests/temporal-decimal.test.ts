@@ -0,0 +1,101 @@
+import { Connection, DuckDB } from "@addon";
+import { DecimalFormat, IExecuteOptions, RowResultFormat, TemporalFormat } from "@addon-types";
+
+const temporalQuery = `SELECT DATE '2021-05-05' AS d, TIMESTAMP '2021-05-05 10:20:30.456' AS ts,
+  DATE '1969-12-31' AS before_epoch, INTERVAL '1 year 2 days 3 seconds' AS iv, CAST(NULL AS DATE) AS missing`;
+const decimalQuery = `SELECT '123.45'::DECIMAL(5,2) AS small, '-0.05'::DECIMAL(9,2) AS negative,
+  '1234567890.123456'::DECIMAL(18,6) AS large, '12345678901234567890.12'::DECIMAL(38,2) AS huge`;
+
+describe("Temporal and decimal conversion", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  const fetchRow = async (query: string, options: IExecuteOptions) =>
+    (await connection.executeIterator<any[]>(query, { rowResultFormat: RowResultFormat.Array, ...options })).fetchRow();
+
+  const may5 = Date.UTC(2021, 4, 5);
+  const may5Timestamp = Date.UTC(2021, 4, 5, 10, 20, 30, 456);
+  const interval = { months: 12, days: 2, micros: 3000000 };
+
+  it("keeps DATEs as strings and TIMESTAMPs as epoch milliseconds by default", async () => {
+    expect(await fetchRow(temporalQuery, {})).toEqual(["2021-05-05", may5Timestamp, "1969-12-31", interval, null]);
+  });
+
+  it("returns JS Dates", async () => {
+    expect(await fetchRow(temporalQuery, { temporalFormat: TemporalFormat.Date })).toEqual([
+      new Date(may5),
+      new Date(may5Timestamp),
+      new Date(Date.UTC(1969, 11, 31)),
+      interval,
+      null,
+    ]);
+  });
+
+  it("returns epoch milliseconds", async () => {
+    expect(await fetchRow(temporalQuery, { temporalFormat: TemporalFormat.Epoch })).toEqual([
+      may5,
+      may5Timestamp,
+      -86400000,
+      interval,
+      null,
+    ]);
+  });
+
+  it("returns temporal columns as typed arrays of epoch values", async () => {
+    const query = "SELECT DATE '2021-05-05' + i::INTEGER AS d, TIME '01:00:00' AS t FROM range(0, 3) r(i)";
+    const chunk = await (await connection.executeIterator(query)).fetchChunkAsync();
+    expect(chunk?.columns[0].data).toEqual(new Float64Array([may5, may5 + 86400000, may5 + 2 * 86400000]));
+    expect(chunk?.columns[1].data).toEqual(new Float64Array(3).fill(3600 * 1000 * 1000));
+  });
+
+  it("rounds pre-epoch timestamps down to the millisecond", async () => {
+    const query = "SELECT TIMESTAMP '1969-12-31 23:59:59.9995' AS ts";
+    const expected = Date.UTC(1969, 11, 31, 23, 59, 59, 999);
+    expect(await fetchRow(query, { temporalFormat: TemporalFormat.Epoch })).toEqual([expected]);
+    const chunk = await (await connection.executeIterator(query)).fetchChunkAsync();
+    expect(chunk?.columns[0].data).toEqual(new Float64Array([expected]));
+  });
+
+  it("converts decimals to numbers by default", async () => {
+    const row = await fetchRow(decimalQuery, {});
+    expect(row.slice(0, 3)).toEqual([123.45, -0.05, 1234567890.123456]);
+    expect(row[3] / 12345678901234567890.12).toBeCloseTo(1, 15);
+  });
+
+  it("converts decimals to unscaled BigInts", async () => {
+    expect(await fetchRow(decimalQuery, { decimalFormat: DecimalFormat.BigInt })).toEqual([
+      12345n,
+      -5n,
+      1234567890123456n,
+      1234567890123456789012n,
+    ]);
+  });
+
+  it("converts decimals to exact strings", async () => {
+    expect(await fetchRow(decimalQuery, { decimalFormat: DecimalFormat.String })).toEqual([
+      "123.45",
+      "-0.05",
+      "1234567890.123456",
+      "12345678901234567890.12",
+    ]);
+  });
+
+  it("returns decimal columns as typed arrays", async () => {
+    const query = "SELECT (i * 0.25)::DECIMAL(10,2) AS d FROM range(0, 3) r(i)";
+    const numbers = await (await connection.executeIterator(query)).fetchChunkAsync();
+    expect(numbers?.columns[0].data).toEqual(new Float64Array([0, 0.25, 0.5]));
+    const bigInts = await (
+      await connection.executeIterator(query, { decimalFormat: DecimalFormat.BigInt })
+    ).fetchChunkAsync();
+    expect(bigInts?.columns[0].data).toEqual(new BigInt64Array([0n, 25n, 50n]));
+  });
+});
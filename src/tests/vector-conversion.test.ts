@@ -0,0 +1,54 @@
+import { Connection, DuckDB } from "@addon";
+import { RowResultFormat } from "@addon-types";
+
+describe("Vector conversion", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(() => {
+    db = new DuckDB();
+    connection = new Connection(db);
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("converts constant vectors", async () => {
+    const result = await connection.executeIterator("SELECT 1 AS a, 'x' AS b, NULL AS c FROM range(0, 3)", {
+      rowResultFormat: RowResultFormat.Array,
+    });
+    expect(result.fetchAllRows()).toEqual([
+      [1, "x", null],
+      [1, "x", null],
+      [1, "x", null],
+    ]);
+  });
+
+  it("converts filtered vectors with nulls", async () => {
+    await connection.executeIterator("CREATE TABLE t (i INTEGER, s VARCHAR, b BOOLEAN)");
+    await connection.executeIterator(
+      "INSERT INTO t SELECT i, CASE WHEN i % 2 = 0 THEN NULL ELSE 'long string value ' || i END, i % 3 = 0 FROM range(0, 3000) r(i)",
+    );
+    const result = await connection.executeIterator<Record<string, unknown>>(
+      "SELECT i, s, b FROM t WHERE i % 1000 IN (1, 2)",
+    );
+    expect(result.fetchAllRows()).toEqual([
+      { i: 1, s: "long string value 1", b: false },
+      { i: 2, s: null, b: false },
+      { i: 1001, s: "long string value 1001", b: false },
+      { i: 1002, s: null, b: true },
+      { i: 2001, s: "long string value 2001", b: true },
+      { i: 2002, s: null, b: false },
+    ]);
+  });
+
+  it("converts values across several chunks", async () => {
+    const result = await connection.executeIterator<bigint[]>("SELECT * FROM range(0, 5000)", {
+      rowResultFormat: RowResultFormat.Array,
+    });
+    const rows = result.fetchAllRows();
+    expect(rows.length).toBe(5000);
+    expect(rows[4999]).toEqual([4999n]);
+  });
+});
@@ -0,0 +1,124 @@
+import { join } from "path";
+import { Worker } from "worker_threads";
+
+import { Connection, DuckDB } from "@addon";
+import { RowResultFormat } from "@addon-types";
+
+const addonPath = join(__dirname, "../../build/Release/node-duckdb-addon.node");
+
+// runs a query through the bindings of the addon loaded in a worker thread
+const workerSource = `
+const { parentPort, workerData } = require("worker_threads");
+const { DuckDB, Connection } = require(workerData.addonPath);
+(async () => {
+  const db = new DuckDB({ handle: workerData.handle });
+  const connection = new Connection(db);
+  const result = await connection.execute(workerData.query, { rowResultFormat: 1 });
+  const rows = [];
+  for (let row = result.fetchRow(); row !== null; row = result.fetchRow()) {
+    rows.push(row.map(value => (typeof value === "bigint" ? Number(value) : value)));
+  }
+  connection.close();
+  db.close();
+  parentPort.postMessage(rows);
+})().catch(error => parentPort.postMessage({ error: error.message }));
+`;
+
+function queryInWorker(handle: string, query: string): Promise<unknown> {
+  return new Promise((resolve, reject) => {
+    const worker = new Worker(workerSource, { eval: true, workerData: { addonPath, handle, query } });
+    worker.once("message", resolve);
+    worker.once("error", reject);
+  });
+}
+
+describe("Database handles", () => {
+  let db: DuckDB;
+  let connection: Connection;
+  beforeEach(async () => {
+    db = new DuckDB();
+    connection = new Connection(db);
+    await connection.executeIterator("CREATE TABLE people(id INTEGER, name VARCHAR)");
+    await connection.executeIterator("INSERT INTO people VALUES (1, 'Mark'), (2, 'Hannes')");
+  });
+
+  afterEach(() => {
+    connection.close();
+    db.close();
+  });
+
+  it("returns the same handle when exported again", () => {
+    expect(db.exportHandle()).toBe(db.exportHandle());
+  });
+
+  it("shares an in-memory database on the same thread", async () => {
+    const attached = new DuckDB({ handle: db.exportHandle() });
+    const attachedConnection = new Connection(attached);
+    const result = await attachedConnection.executeIterator("SELECT name FROM people ORDER BY id", {
+      rowResultFormat: RowResultFormat.Array,
+    });
+    expect(result.fetchAllRows()).toEqual([["Mark"], ["Hannes"]]);
+    attachedConnection.close();
+    attached.close();
+    expect(db.isClosed).toBe(false);
+  });
+
+  it("shares an in-memory database with worker threads", async () => {
+    const handle = db.exportHandle();
+    const results = await Promise.all([
+      queryInWorker(handle, "SELECT id, name FROM people ORDER BY id"),
+      queryInWorker(handle, "SELECT count(*) FROM people"),
+    ]);
+    expect(results).toEqual([
+      [
+        [1, "Mark"],
+        [2, "Hannes"],
+      ],
+      [[2]],
+    ]);
+  });
+
+  it("sees the writes of worker threads", async () => {
+    await queryInWorker(db.exportHandle(), "INSERT INTO people VALUES (3, 'Bob')");
+    const result = await connection.executeIterator("SELECT count(*) FROM people", {
+      rowResultFormat: RowResultFormat.Array,
+    });
+    expect(result.fetchRow()).toEqual([3n]);
+  });
+
+  it("keeps the database open while attached objects use it", async () => {
+    const handle = db.exportHandle();
+    const attached = new DuckDB({ handle });
+    connection.close();
+    db.close();
+    const attachedConnection = new Connection(attached);
+    const result = await attachedConnection.executeIterator("SELECT count(*) FROM people", {
+      rowResultFormat: RowResultFormat.Array,
+    });
+    expect(result.fetchRow()).toEqual([2n]);
+    attachedConnection.close();
+    attached.close();
+    expect(() => new DuckDB({ handle })).toThrow("Invalid handle: the database is closed or was never exported");
+  });
+
+  it("keeps the thread count of the exported database", () => {
+    const threaded = new DuckDB({ options: { threads: 3 } });
+    const attached = new DuckDB({ handle: threaded.exportHandle(), options: { threads: 1 } });
+    expect(threaded.threads).toBe(3);
+    expect(attached.threads).toBe(3);
+    attached.close();
+    threaded.close();
+  });
+
+  it("rejects unknown handles", () => {
+    expect(() => new DuckDB({ handle: "unknown" })).toThrow(
+      "Invalid handle: the database is closed or was never exported",
+    );
+  });
+
+  it("can't be combined with a path", () => {
+    expect(() => new DuckDB({ handle: db.exportHandle(), path: "db.duckdb" })).toThrow(
+      "Invalid argument: path can't be combined with handle",
+    );
+  });
+});